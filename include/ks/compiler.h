@@ -928,6 +928,9 @@ KS_API ks_tok ks_tok_combo(ks_tok a, ks_tok b);
 /* Convert a token to the string contents */
 KS_API ks_str ks_tok_str(ks_str src, ks_tok tok);
 
+/* Convert a name token to an interned string (see 'ks_str_intern()') */
+KS_API ks_str ks_tok_name(ks_str src, ks_tok tok);
+
 /* Generate a syntax error
  */
 KS_API ks_Exception ks_syntax_error(ks_str fname, ks_str src, ks_tok tok, const char* fmt, ...);
@@ -1021,7 +1024,19 @@ KS_API ks_code ks_compile(ks_str fname, ks_str src, ks_ast prog, ks_code from);
 
 /** Internal methods **/
 
-/* Execute on the current thread's last frame (see 'vm.c' for semantics) */
-KS_API kso _ks_exec(ks_code bc, ks_type _in);
+/* Execute on the current thread's last frame (see 'vm.c' for semantics)
+ *
+ * 'th' must be the current thread (i.e. 'ksos_thread_get()'), which callers already have
+ */
+KS_API kso _ks_exec(ksos_thread th, ks_code bc, ks_type _in);
+
+/* Equivalent to 'kso_call_ext()', but on a given thread 'th' (which must be the current thread) */
+KS_API kso _kso_call_ext(ksos_thread th, kso func, int nargs, kso* args, ks_dict locals, ksos_frame closure);
+
+/* Copy the top frame of 'th' into the traceback of the exception being thrown, if it hasn't been already
+ *
+ * Call this before the frame is popped because of the exception, or before its 'pc' is moved to a handler
+ */
+KS_API void _ks_unwind(ksos_thread th);
 
 #endif /* KS_COMPILER_H__ */
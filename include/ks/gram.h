@@ -75,22 +75,20 @@ typedef struct ksgram_Lexer_s {
      */
     kso src;
 
-    /* Number of characters read, but not yet claimed */
+    /* Number of bytes read, but not yet claimed */
     int n_queue;
     /* Maximum size the queue has been allocated for */
     int _max_n_queue;
 
-    /* List of characters being matched currently */
+    /* Bytes (UTF-8) being matched currently */
     char* queue;
 
     /* The line, column (in characters from start of line), and position (in bytes and characters from start of stream) */
     int line, col, pos_b, pos_c;
 
 
-    /* Internal use, for simulating the Regex */
-    ks_regex_sim0 _sim;
-
-    int _max_sim_len;
+    /* Internal use, all of the rules combined into a single regex (or NULL if it needs to be created) */
+    ks_regex _all;
 
 
 }* ksgram_Lexer;
@@ -19,6 +19,8 @@
 
 /** Initializer functions (internal use only) **/
 
+void _ksi_hash();
+
 void _ksi_object();
 
 void _ksi_none();
@@ -34,6 +36,8 @@ void _ksi_rational();
 
 void _ksi_str();
 void _ksi_bytes();
+void _ksi_bytearray();
+void _ksi_memoryview();
 void _ksi_regex();
 
 void _ksi_range();
@@ -164,6 +168,7 @@ _KS_DO_SPEC(_KSACT)
     _ksva__src,
     _ksva__sig,
     _ksva__doc,
+    _ksva__slots,
 
 
     _ksv_expr,
@@ -93,6 +93,18 @@
 #endif
 
 
+/* Thread-local storage specifier, if the compiler supports one (otherwise, it is left undefined,
+ *   and thread-specific data must be looked up through the threading library)
+ */
+#if defined(_MSC_VER)
+  #define KS_TLS __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+  #define KS_TLS __thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+  #define KS_TLS _Thread_local
+#endif
+
+
 /* KS_API_DATA is for data symbols, not functions */
 #ifdef KS_BUILD
   #define KS_API_DATA KS_API_EXPORT extern 
@@ -305,6 +317,8 @@ KS_API_DATA ks_type
       kst_complex,
     kst_str,
     kst_bytes,
+    kst_bytearray,
+    kst_memoryview,
     kst_regex,
     kst_range,
     kst_slice,
@@ -319,6 +333,7 @@ KS_API_DATA ks_type
     kst_enumerate,
 
     kst_str_iter,
+    kst_regex_iter,
     kst_bytes_iter,
     kst_range_iter,
     kst_list_iter,
@@ -438,6 +453,10 @@ struct ks_eikv {
  */
 #define KSO_NEW(_ctp, _tp) ((_ctp)_kso_new(_tp))
 
+/* Like 'KSO_NEW', but allocates '_extra' more bytes directly after the object (i.e. at '(char*)ob + _tp->ob_sz')
+ */
+#define KSO_NEWX(_ctp, _tp, _extra) ((_ctp)_kso_newx(_tp, _extra))
+
 /* Deletes an object allocated with 'KSO_NEW'
  */
 #define KSO_DEL(_ob) (_kso_del((kso)(_ob)))
@@ -469,6 +488,9 @@ struct ks_eikv {
 
 /* Throws an exception type, generated with a C-style format string (see 'ks_fmt()') 
  * After doing this, you should return NULL or otherwise indicate something was thrown
+ *
+ * The message is only rendered if it is used (see 'ks_Exception_new_cv()'), so this is cheap
+ *   for errors that are caught and ignored
  */
 #define KS_THROW(_tp, ...) do { \
     kso_throw_c(_tp, __FILE__, __func__, __LINE__, __VA_ARGS__); \
@@ -636,7 +658,14 @@ KS_API ks_ssize_t ks_nextsize(ks_ssize_t cur_sz, ks_ssize_t req);
  */
 KS_API ks_ssize_t ks_nextprime(ks_ssize_t x);
 
+/* Returns the smallest power of two >= x
+ */
+KS_API ks_size_t ks_nextpow2(ks_size_t x);
+
 /* hash a sequence of bytes
+ *
+ * The hash is seeded randomly per-process (set the 'KS_HASHSEED' environment variable to
+ *   an integer to make it reproducible), so it should never be persisted
  */
 KS_API ks_hash_t ks_hash_bytes(ks_ssize_t len_b, const unsigned char* data);
 
@@ -663,6 +692,9 @@ KS_API bool ks_cfloat_from_str(const char* str, int sz, ks_cfloat* out);
  *
  * If 'sci', then the output is in scientific format, otherwise it is always in normal format with no
  *   exponent.
+ *
+ * If 'prec < 0' (and 'base == 10'), then the shortest digits that convert back to exactly 'val' are used, instead of a
+ *   fixed number of digits after the decimal point
  * 
  * This function returns the total number of bytes required. If 'result > sz', then the output has been truncated,
  *   and may not be correct. Therefore, you should allocate a buffer of at least 'sz', and then call this function
@@ -698,6 +730,9 @@ KS_API bool kso_isinst(kso a, ks_type b);
 
 /* Throws an exception up the call stack.
  * This function always returns 'NULL' for convenience
+ *
+ * The traceback ('exc->frames') is filled in as the exception unwinds through each frame, and
+ *   completed when it is caught with 'kso_catch()'. 'kso_catch_ignore()' skips that work
  */
 KS_API void* kso_throw(ks_Exception exc);
 KS_API void* kso_throw_c(ks_type tp, const char* cfile, const char* cfunc, int cline, const char* fmt, ...);
@@ -839,6 +874,18 @@ KS_API kso ks_type_get(ks_type self, ks_str attr);
 /* Sets an attribute of the type
  */
 KS_API bool ks_type_set(ks_type self, ks_str attr, kso val);
+
+/* Declare fixed attributes ('__slots') of instances of the type, from an iterable of 'str' names
+ *
+ * These are stored inline in instances, rather than in the attribute dictionary. If the type derives
+ *   directly from 'object', then instances do not have an attribute dictionary at all, and only these
+ *   attributes may be set
+ *
+ * A name may not also be an attribute of the type itself, since that would hide the slot
+ * 
+ * NOTE: This must be called before any instances of the type are created
+ */
+KS_API bool ks_type_setslots(ks_type self, kso names);
 KS_API bool ks_type_set_c(ks_type self, const char* attr, kso val);
 
 
@@ -908,10 +955,54 @@ KS_API ks_str ks_str_new(ks_ssize_t len_b, const char* data);
  */
 KS_API ks_str ks_str_newn(ks_ssize_t len_b, char* data);
 
+/* Return the interned string with the same contents as 'self' (or the given UTF-8 data), adding it to the
+ *   intern table if it was not already there
+ *
+ * Interned strings live for the rest of the program, and there is only one for any given contents, so they
+ *   can be compared by identity. This should be used for identifiers (names of variables, attributes, etc)
+ *   and constant keys, not for arbitrary data
+ */
+KS_API ks_str ks_str_intern(ks_str self);
+KS_API ks_str ks_str_intern_c(ks_ssize_t len_b, const char* data);
+
+/* Create a string from the 'len_b' bytes of 'self' starting at byte 'off_b' (which should be on character boundaries)
+ *
+ * Long suffixes of 'self' reference its data instead of copying it (they share the NUL-terminator), unless that
+ *   would keep a much larger buffer alive
+ */
+KS_API ks_str ks_str_sub(ks_str self, ks_ssize_t off_b, ks_ssize_t len_b);
+
+/* Concatenate two strings
+ */
+KS_API ks_str ks_str_cat(ks_str L, ks_str R);
+
 /* Calculate the length, in characters, of a UTF-8 string
  */
 KS_API ks_ssize_t ks_str_lenc(ks_ssize_t len_b, const char* data);
 
+/* Return the byte offset of character 'idx_c' in 'self' (clamped to '[0, self->len_b]')
+ *
+ * This is O(1) for ASCII strings, and amortized O(KS_STR_OFF_EVERY) for others
+ */
+KS_API ks_ssize_t ks_str_off(ks_str self, ks_ssize_t idx_c);
+
+/* Calculate whether 'data' is valid UTF-8 (i.e. has no truncated, overlong, or surrogate sequences, and
+ *   no codepoints above U+10FFFF)
+ */
+KS_API bool ks_str_isutf8(ks_ssize_t len_b, const char* data);
+
+/* Calculate (and cache) the hash and length in characters of a string object
+ * NOTE: Use 'KS_STR_HASH()' and 'KS_STR_LENC()', which only call these if they haven't been calculated
+ */
+KS_API ks_hash_t _ks_str_hash(ks_str self);
+KS_API ks_size_t _ks_str_lenc(ks_str self);
+
+/* Append 'other' to 'self', modifying it in place
+ * NOTE: This should only be used when nothing else can observe 'self' (i.e. it is uniquely referenced), since
+ *         strings are otherwise immutable
+ */
+KS_API void _ks_str_append(ks_str self, ks_str other);
+
 /* Compare 'L' and 'R', returning either a comparator, or a boolean telling equality
  */
 KS_API int ks_str_cmp(ks_str L, ks_str R);
@@ -938,6 +1029,10 @@ KS_API ks_list ks_str_split(ks_str self, ks_str by);
 KS_API ks_list ks_str_split_c(const char* self, const char* by);
 KS_API ks_list ks_str_split_any(ks_str self, int nby, ks_str* by);
 
+/* Replace every (non-overlapping) occurrence of 'sub' in 'self' with 'by'
+ */
+KS_API ks_str ks_str_replace(ks_str self, ks_str sub, ks_str by);
+
 /* Convert a string to all upper-case, using 'ucd'
  */
 KS_API ks_str ks_str_upper(ks_str self);
@@ -985,15 +1080,81 @@ KS_API ks_bytes ks_bytes_newn(ks_ssize_t len_b, char* data);
  */
 KS_API ks_bytes ks_bytes_newo(ks_type tp, kso obj);
 
+/* Create a 'bytes' from the 'len_b' bytes of 'self' starting at 'off_b'
+ *
+ * Long enough results reference the data of 'self' instead of copying it, unless that would keep a much
+ *   larger buffer alive
+ */
+KS_API ks_bytes ks_bytes_sub(ks_bytes self, ks_ssize_t off_b, ks_ssize_t len_b);
+
+/* Concatenate two bytes objects
+ */
+KS_API ks_bytes ks_bytes_cat(ks_bytes L, ks_bytes R);
+
+/* Append 'other' to 'self', modifying it in place
+ * NOTE: This should only be used when nothing else can observe 'self' (see '_ks_str_append()')
+ */
+KS_API void _ks_bytes_append(ks_bytes self, ks_bytes other);
+
+
+/* Create a new 'bytearray' (with a copy of 'data', which may be NULL to zero-initialize it)
+ */
+KS_API ks_bytearray ks_bytearray_new(ks_type tp, ks_ssize_t len_b, const void* data);
+
+/* Resize a 'bytearray' (new bytes are zero-initialized)
+ * Throws an error if there are views of it
+ */
+KS_API bool ks_bytearray_resize(ks_bytearray self, ks_ssize_t len_b);
+
+/* Append 'len_b' bytes to the end of a 'bytearray'
+ */
+KS_API bool ks_bytearray_push(ks_bytearray self, ks_ssize_t len_b, const void* data);
+
+/* Replace 'self[pos:pos+len_b]' with 'sz_b' bytes of 'data' (which may be a different size)
+ */
+KS_API bool ks_bytearray_splice(ks_bytearray self, ks_ssize_t pos, ks_ssize_t len_b, ks_ssize_t sz_b, const void* data);
+
+
+/* Create a new 'memoryview' of 'len_b' bytes at 'data', which are owned by 'obj' (a reference is held to it)
+ *
+ * If 'obj' is a 'bytearray', it cannot be resized until the view is freed
+ */
+KS_API ks_memoryview ks_memoryview_new(kso obj, void* data, ks_ssize_t len_b, bool readonly);
+
+/* Get the contiguous buffer of a bytes-like object ('bytes', 'bytearray', 'memoryview', or 'str' (as UTF-8)), without
+ *   copying it. If 'writable', then only writable buffers are accepted
+ */
+KS_API bool kso_get_buf(kso ob, bool writable, unsigned char** data, ks_ssize_t* len_b);
+
+/* Return whether 'ob' is bytes-like (i.e. 'kso_get_buf()' can be used on it)
+ */
+KS_API bool kso_is_buf(kso ob);
+
+/* Calculate (and cache) the hash of a bytes object
+ * NOTE: Use 'KS_BYTES_HASH()', which only calls this if it hasn't been calculated
+ */
+KS_API ks_hash_t _ks_bytes_hash(ks_bytes self);
+
 
 /* Create a new regular-expression from a descriptor string
+ *
+ * Compiled regexes are kept in a bounded cache (least recently used are evicted), so this may return an existing one
  */
 KS_API ks_regex ks_regex_new(ks_str expr);
 
+/* Get statistics of the cache of compiled regexes
+ */
+KS_API void ks_regex_cache_info(ks_cint* hits, ks_cint* misses, ks_cint* size);
+
 /* Create a new regular-expression to match a string literal
  */
 KS_API ks_regex ks_regex_newlit(ks_str expr);
 
+/* Create a new regular-expression matching any of 'regs', where matches are tagged with the index of the regex that
+ *   matched (the first one, if several match the same string)
+ */
+KS_API ks_regex ks_regex_newset(int n, ks_regex* regs);
+
 
 /* Initialize a 'sim0'
  */
@@ -1026,6 +1187,31 @@ KS_API bool ks_regex_exact(ks_regex self, ks_str str);
  */
 KS_API bool ks_regex_matches(ks_regex self, ks_str str);
 
+/* Find the leftmost (and then longest) match that starts at or after byte 'from' in 'str', storing its start and stop
+ *   (in bytes) and returning whether one was found
+ */
+KS_API bool ks_regex_search(ks_regex self, ks_str str, ks_ssize_t from, ks_ssize_t* start, ks_ssize_t* stop);
+
+/* Create an iterator over the matches (which don't overlap) of the regex within 'src', which may be a 'str' or an
+ *   'io.BaseIO' (which is read in chunks, so only the part of the stream which may still match is kept in memory)
+ */
+KS_API ks_regex_iter ks_regex_finditer(ks_regex self, kso src);
+
+/* Write 'src' to 'out' (an 'io.BaseIO'), with every match replaced by 'repl', which is either a 'str' or a function
+ *   taking the matched string and returning a 'str'
+ */
+KS_API bool ks_regex_sub(ks_regex self, kso src, kso repl, kso out);
+
+/* Begin finding the longest match at the start of some input
+ */
+KS_API void ks_regex_lm_init(ks_regex self, ks_regex_lm* lm);
+
+/* Give the next 'len_b' bytes of input, returning whether more input may give a longer match
+ *
+ * NOTE: The regex should not be used for anything else while a match is being found
+ */
+KS_API bool ks_regex_lm_feed(ks_regex self, ks_regex_lm* lm, ks_ssize_t len_b, const char* data);
+
 
 
 
@@ -1099,6 +1285,28 @@ KS_API void ks_list_popu(ks_list self);
  */
 KS_API bool ks_list_del(ks_list self, ks_cint idx);
 
+/* Get the element at a given index (which must be in range), returning a new reference
+ * If the list is unboxed, this creates a new object
+ */
+KS_API kso ks_list_get(ks_list self, ks_cint idx);
+
+/* Set the element at a given index (which must be in range), which does not absorb a reference to 'ob'
+ */
+KS_API bool ks_list_set(ks_list self, ks_cint idx, kso ob);
+
+/* Create a new list from the elements in 'range(first, last, delta)' of 'self', keeping its storage strategy
+ */
+KS_API ks_list ks_list_slice(ks_list self, ks_cint first, ks_cint last, ks_cint delta);
+
+/* Convert a list to object storage, so that 'self->elems' is valid
+ * After this, the list stays boxed until it is emptied
+ */
+KS_API void ks_list_box(ks_list self);
+
+/* Allow a list to use unboxed storage, and convert it if it is homogeneous
+ */
+KS_API void ks_list_unbox(ks_list self);
+
 /* Create a new 'attrtuple' subtype
  */
 KS_API ks_type ks_attrtuple_newtype(ks_str name, int nmem, kso* mem);
@@ -1288,10 +1496,19 @@ KS_API bool ks_logger_clog(ks_logger self, int level, const char* file, const ch
 
 
 /* Create an exception (for returning exceptions from C code)
+ *
+ * The message is not formatted right away. Instead, 'fmt' and a snapshot of the arguments are kept
+ *   (objects are referenced, C strings are copied), and it is rendered the first time it is
+ *   needed (see 'ks_Exception_what()'). So, 'fmt' must outlive the exception (in practice, it
+ *   should be a string literal), and '%R'/'%S'/'%O' arguments show their value at that time
  */
 KS_API ks_Exception ks_Exception_new_c(ks_type tp, const char* cfile, const char* cfunc, int cline, const char* fmt, ...);
 KS_API ks_Exception ks_Exception_new_cv(ks_type tp, const char* cfile, const char* cfunc, int cline, const char* fmt, va_list ap);
 
+/* Return the message of an exception (a new reference), rendering it if it hasn't been already
+ */
+KS_API ks_str ks_Exception_what(ks_Exception self);
+
 /* Create a new module
  */
 KS_API ks_module ks_module_new(const char* name, const char* source, const char* doc, struct ks_ikv* ikv);
@@ -1326,9 +1543,17 @@ KS_API bool kso_parse(int nargs, kso* args, const char* fmt, ...);
 
 /* Attempt to get the '__attr__' dict from an object, returning NULL if it couldn't be determined
  * NOTE: this does NOT throw an error if it wasn't found
+ * NOTE: Attribute dictionaries are created when first needed, so this returns NULL for objects which
+ *         have not had any attributes set yet
  */
 KS_API ks_dict kso_try_getattr_dict(kso obj);
 
+/* Get the '__attr__' dict from an object (a borrowed reference), creating it if it hasn't been yet,
+ *   returning NULL if the type does not have attribute dictionaries
+ * NOTE: this does NOT throw an error if it wasn't found
+ */
+KS_API ks_dict kso_getattr_dict(kso obj);
+
 /* Get, set, or delete an attribute from an object
  */
 KS_API kso kso_getattr(kso ob, ks_str attr);
@@ -1361,9 +1586,15 @@ KS_API void kso_outrepr();
 
 /* Specific sort types
  */
+KS_API bool ks_sort_tim(ks_size_t n, kso* elems, kso* keys, kso cmpfunc);
 KS_API bool ks_sort_merge(ks_size_t n, kso* elems, kso* keys, kso cmpfunc);
 KS_API bool ks_sort_insertion(ks_size_t n, kso* elems, kso* keys, kso cmpfunc);
 
+/* Sorts unboxed values in place (stable, and 'vals' must not contain NaNs for 'ks_sort_cf()')
+ */
+KS_API bool ks_sort_ci(ks_size_t n, ks_cint* vals);
+KS_API bool ks_sort_cf(ks_size_t n, ks_cfloat* vals);
+
 
 /* Sorts 'elems' in place according to 'keys' (may be '==elems'), according to 'cmpfunc'
  *
@@ -1468,6 +1699,7 @@ KS_API bool ks_str_citer_seek(struct ks_str_citer* cit, ks_ssize_t idx);
 
 /* Allocation/deallocation */
 KS_API kso _kso_new(ks_type tp);
+KS_API kso _kso_newx(ks_type tp, ks_size_t extra);
 KS_API void _kso_del(kso ob);
 KS_API kso _ks_newref(kso ob);
 KS_API void _kso_free(kso obj, const char* file, const char* func, int line);
@@ -68,6 +68,17 @@ KS_API bool ksm_isclose(ks_cfloat x, ks_cfloat y, ks_cfloat rel_err, ks_cfloat a
 KS_API ks_cfloat ksm_gamma(ks_cfloat x);
 KS_API ks_cfloat ksm_zeta(ks_cfloat x);
 
+/* Generated tables used by 'ksm_gamma()' and 'ksm_zeta()' (see 'gz.c'), which are also used by the 'nx' kernels
+ *
+ * For 'x > 0', 'Gamma(x+1) = sqrt(2*pi) * t**(x+0.5) * exp(-t) * sum(a[i] / (x+i))', where 't = x+g+0.5' (and the 0th term is just 'a[0]')
+ * For 'x >= 0', 'Zeta(x) = sum(d[i] * (i+1)**-x) / (1 - 2**(1-x))'
+ */
+#define KSM_GAMMA_N 15
+#define KSM_ZETA_N 24
+KS_API_DATA const ks_cfloat ksm_gamma_g;
+KS_API_DATA const ks_cfloat ksm_gamma_a[KSM_GAMMA_N];
+KS_API_DATA const ks_cfloat ksm_zeta_d[KSM_ZETA_N];
+
 /*** 'ks_ccomplex' functions (these do not throw errors) ***/
 
 KS_API ks_ccomplex ksm_csqrt(ks_ccomplex x);
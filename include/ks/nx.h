@@ -904,6 +904,15 @@ KS_API bool nx_cbrt(nx_t X, nx_t R);
 /* R = pow(X, Y) */
 KS_API bool nx_pow(nx_t X, nx_t Y, nx_t R);
 
+/* R = gamma(X) */
+KS_API bool nx_gamma(nx_t X, nx_t R);
+
+/* R = zeta(X) */
+KS_API bool nx_zeta(nx_t X, nx_t R);
+
+/* R = erf(X) */
+KS_API bool nx_erf(nx_t X, nx_t R);
+
 /* R = hypot(X, Y) */
 KS_API bool nx_hypot(nx_t X, nx_t Y, nx_t R);
 
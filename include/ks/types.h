@@ -226,8 +226,46 @@ typedef struct ks_complex_s {
 
 /** Collection/Iterable Types **/
 
+/* Number of characters between checkpoints in the offset index of non-ASCII strings (see 'ks_str_off()'),
+ *   or 0 to disable the index
+ */
+#ifndef KS_STR_OFF_EVERY
+#define KS_STR_OFF_EVERY 64
+#endif
+
+/* Flags for 'str' objects */
+enum {
+    /* 'v_hash' has been calculated */
+    KS_STR_F_HASH          = 0x01,
+
+    /* 'len_c' has been calculated */
+    KS_STR_F_LENC          = 0x02,
+
+    /* The string is known to be all ASCII (so 'len_c == len_b') */
+    KS_STR_F_ASCII         = 0x04,
+
+    /* The string is in the intern table (see 'ks_str_intern()'), so it is the only interned string
+     *   with its contents, and two interned strings are equal iff they are identical
+     */
+    KS_STR_F_INTERN        = 0x08,
+
+    /* 'data' is stored in the same allocation as the object, directly after it */
+    KS_STR_F_INLINE        = 0x10,
+
+    /* 'data' is owned, and has room for 'ks_nextpow2(len_b + 1)' bytes (see '_ks_str_append()') */
+    KS_STR_F_GROW          = 0x20,
+
+};
+
+/* Minimum length, in bytes, of a substring which may reference its parent's data instead of copying it
+ *   (see 'ks_str_sub()' and 'ks_bytes_sub()')
+ */
+#define KS_STR_VIEW_MIN 64
+
 /* 'str' - (immutable) string of unicode characters
  *
+ * The hash and length in characters are calculated when first requested (so that large strings which are
+ *   only passed around are never scanned), so use 'KS_STR_HASH()' and 'KS_STR_LENC()' to read them
  * 
  */
 struct ks_str_s {
@@ -236,12 +274,15 @@ struct ks_str_s {
     /* Length, in bytes, of the string (for ASCII strings, this is also the number of characters) */
     ks_size_t len_b;
 
-    /* Length, in characters, of the string */
+    /* Length, in characters, of the string (valid if 'KS_STR_F_LENC' is set) */
     ks_size_t len_c;
 
-    /* Hash of the string contents (ks_hash_bytes(x->chr, x->len_b)) */
+    /* Hash of the string contents (ks_hash_bytes(x->chr, x->len_b)) (valid if 'KS_STR_F_HASH' is set) */
     ks_hash_t v_hash;
 
+    /* Flags ('KS_STR_F_*') */
+    unsigned int flags;
+
     #if KS_STR_OFF_EVERY
 
     /*
@@ -249,13 +290,21 @@ struct ks_str_s {
      *   to O(1), to avoid (for example) string iteration to be O(N^2)
      * 
      * This is achieved by creating a per-string lookup table to quickly seek to a check point
-     *   (which is at most `KS_STR_OFF_EVERY/2` characters away from any given point), then
+     *   (which is less than `KS_STR_OFF_EVERY` characters before any given point), then
      *   manually skipping over characters until the current index is the sought after one
+     *
+     * '_offs[i]' is the byte offset of character 'i * KS_STR_OFF_EVERY'. It is NULL until the first
+     *   random access, and is never created for ASCII strings
      */
     ks_size_t* _offs;
 
     #endif /* KS_STR_OFF_EVERY */
 
+    /* If non-NULL, 'data' points into the data of '_base' (which this holds a reference to) rather than
+     *   being owned by this string
+     */
+    ks_str _base;
+
     /* String data (UTF8)
      *
      * These are the bytes of the string, in UTF8 encoding
@@ -306,8 +355,14 @@ struct ks_str_citer {
 };
 
 
+/* Get the hash of a string, calculating it if it has not been yet */
+#define KS_STR_HASH(_str) (((_str)->flags & KS_STR_F_HASH) ? (_str)->v_hash : _ks_str_hash(_str))
+
+/* Get the length, in characters, of a string, calculating it if it has not been yet */
+#define KS_STR_LENC(_str) (((_str)->flags & KS_STR_F_LENC) ? (_str)->len_c : _ks_str_lenc(_str))
+
 /* Tell whether a string contains ASCII-only data (i.e. bytes==characters) */
-#define KS_STR_IS_ASCII(_str) ((_str)->len_b == (_str)->len_c)
+#define KS_STR_IS_ASCII(_str) (((_str)->flags & KS_STR_F_ASCII) || (_str)->len_b == KS_STR_LENC(_str))
 
 /* String iterator type */
 typedef struct ks_str_iter_s {
@@ -331,14 +386,67 @@ typedef struct ks_bytes_s {
     /* Length of the data */
     ks_size_t len_b;
 
-    /* Hash of the bytes contents (ks_hash_bytes(x->byt, x->len_b)) */
+    /* Hash of the bytes contents (ks_hash_bytes(x->byt, x->len_b)), if 'has_hash' is set (see 'KS_BYTES_HASH()') */
     ks_hash_t v_hash;
+    bool has_hash;
+
+    /* If non-NULL, 'data' points into the data of '_base' (which this holds a reference to) rather than
+     *   being owned by this object
+     */
+    struct ks_bytes_s* _base;
+
+    /* Whether 'data' is owned, and has room for 'ks_nextpow2(len_b)' bytes (see '_ks_bytes_append()') */
+    bool _grow;
 
     /* Array of byte data */
     unsigned char* data;
 
 }* ks_bytes;
 
+/* Get the hash of a bytes object, calculating it if it has not been yet */
+#define KS_BYTES_HASH(_bytes) ((_bytes)->has_hash ? (_bytes)->v_hash : _ks_bytes_hash(_bytes))
+
+/* 'bytearray' - (mutable) sequence of bytes
+ *
+ * Appending is amortized O(1). While a 'memoryview' of it exists ('n_views > 0'), its size cannot change
+ *   (since that may reallocate the data the view points to)
+ *
+ */
+typedef struct ks_bytearray_s {
+    KSO_BASE
+
+    /* Length of the data, and the number of bytes allocated */
+    ks_size_t len_b, max_len_b;
+
+    /* Number of 'memoryview' objects currently referencing 'data' */
+    ks_cint n_views;
+
+    /* Array of byte data */
+    unsigned char* data;
+
+}* ks_bytearray;
+
+/* 'memoryview' - view of a contiguous buffer owned by another object, which does not copy the data
+ *
+ * Any object can expose its memory by creating one with 'ks_memoryview_new()' (for example, from a
+ *   '__memoryview' method, which the 'memoryview' constructor calls)
+ *
+ */
+typedef struct ks_memoryview_s {
+    KSO_BASE
+
+    /* Object which owns the data (a reference is held to it) */
+    kso obj;
+
+    /* Start and length of the viewed data */
+    unsigned char* data;
+    ks_size_t len_b;
+
+    /* Whether the data may not be written through this view */
+    bool readonly;
+
+}* ks_memoryview;
+
 
 
 /* Regex NFA types */
@@ -425,6 +533,26 @@ typedef struct ks_regex_s {
     /* Initial and final states of the regular expression */
     int s0, sf;
 
+    /* For a regex combining several (see 'ks_regex_newset()'), the index of the regex that ends at each state (or -1),
+     *   otherwise NULL
+     */
+    int* tags;
+
+    /* Whether matches can only start at the beginning of the input (i.e. the expression starts with '^') */
+    bool anchored;
+
+    /* Literal that every match starts with, and a literal that every match contains (either may be empty) */
+    int n_pre, n_req;
+    unsigned char* pre;
+    unsigned char* req;
+
+    /* Byte classes, such that every state treats all bytes within a class the same */
+    int n_bcls;
+    unsigned char bcls[256];
+
+    /* Lazily built DFAs for anchored and unanchored matching (see 'types/regex.c') */
+    struct ks_regex_dfa* _dfa[2];
+
 }* ks_regex;
 
 /* regex.match - represents a match found while searching for a regex
@@ -449,6 +577,40 @@ typedef struct ks_regex_match_s {
 
 }* ks_regex_match;
 
+/* 'regex.iter' - iterator over the matches of a regex within a string or a stream
+ *
+ */
+typedef struct ks_regex_iter_s {
+    KSO_BASE
+
+    /* Pattern being matched */
+    ks_regex pat;
+
+    /* Source being searched, which is either a 'str', or an 'io.BaseIO' that is read in chunks */
+    kso src;
+
+    /* Bytes being searched, which, for streams, is a buffer holding the part of the stream that may still contain a match */
+    ks_ssize_t len_b, max_len_b;
+    unsigned char* data;
+
+    /* Position of 'data' within the source */
+    ks_ssize_t base_b;
+
+    /* Position (within 'data') to search from next */
+    ks_ssize_t pos;
+
+    /* For 'str' sources, a byte position and the character position it corresponds to */
+    ks_ssize_t cur_b, cur_c;
+
+    /* If non-NULL, the bytes in between matches are written to 'out' (and 'emit' is the first byte that hasn't been) */
+    kso out;
+    ks_ssize_t emit;
+
+    /* Whether the end of the source has been read, and whether there are no more matches */
+    bool eof, done;
+
+}* ks_regex_iter;
+
 
 /* NFA simulator (level 0)
  *
@@ -474,6 +636,23 @@ typedef struct {
 
 } ks_regex_sim0;
 
+/* Longest match (of at least one byte) from the start of some input, which may be given in pieces
+ *
+ */
+typedef struct {
+
+    /* Current state of the anchored DFA, or -1 if no longer match is possible */
+    int d;
+
+    /* Number of bytes given so far */
+    ks_ssize_t len_b;
+
+    /* Length of the longest match so far (or 0 if there was none), and its tag (for regexes from 'ks_regex_newset()') */
+    ks_ssize_t stop;
+    int tag;
+
+} ks_regex_lm;
+
 
 /* 'range' - (immutable) integral range
  *
@@ -527,8 +706,30 @@ typedef struct ks_slice_s {
 
 }* ks_slice;
 
+/* Storage strategies for a 'list'
+ *
+ */
+enum {
+    /* Always stores references in 'elems' (default for lists created via the C-API) */
+    KS_LIST_S_OBJ      = 0,
+
+    /* Stores references in 'elems', but may switch to an unboxed strategy when empty */
+    KS_LIST_S_ANY      = 1,
+
+    /* Stores exact 'int' objects (which fit in a 'ks_cint') unboxed, in '_raw_i' */
+    KS_LIST_S_INT      = 2,
+
+    /* Stores exact 'float' objects unboxed, in '_raw_f' */
+    KS_LIST_S_FLOAT    = 3,
+
+};
+
 /* 'list' - collection of objects
  *
+ * Lists created by user code (literals, 'list()', results of slicing, etc) keep homogeneous numeric elements
+ *   unboxed, and box them lazily on access. Inserting any other kind of element switches the list back to
+ *   object storage. While a list is unboxed, 'elems' is NULL, so C code that reads 'elems' of a list it did not
+ *   create should call 'ks_list_box()' first (or use 'ks_list_get()')
  */
 typedef struct ks_list_s {
     KSO_BASE
@@ -536,12 +737,25 @@ typedef struct ks_list_s {
     /* Length, in elements, of the list */
     ks_size_t len;
 
-    /* Array of elements */
+    /* Array of elements (NULL if the list is unboxed) */
     kso* elems;
 
-    /* Maximum size allocated (via 'ks_nextsize()') */
+    /* Maximum size allocated (via 'ks_nextsize()'), which is the capacity of whichever array is in use */
     ks_size_t _max_len;
 
+    /* Storage strategy, one of 'KS_LIST_S_*' */
+    int _strat;
+
+    /* Unboxed elements, discriminated based on '_strat' */
+    union {
+
+        /* when '_strat == KS_LIST_S_INT' */
+        ks_cint* _raw_i;
+        /* when '_strat == KS_LIST_S_FLOAT' */
+        ks_cfloat* _raw_f;
+
+    };
+
 }* ks_list;
 
 /* 'list.__iter' iterator type */
@@ -644,10 +858,17 @@ typedef struct ks_set_iter_s {
 
 
 
+/* Number of entries a 'dict' can hold in its inline array, before a hash table is built */
+#define KS_DICT_SMALL 8
+
 /* 'dict' - mapping of keys to values, where keys are unique
  *
  * Ordered by insertion order
  * 
+ * Small dictionaries (up to 'KS_DICT_SMALL' entries) have no buckets ('len_buckets == 0'), and are
+ *   searched linearly. Their entries are stored in '_small_ents', so creating one requires no
+ *   allocations besides the object itself
+ * 
  */
 typedef struct ks_dict_s {
     KSO_BASE
@@ -688,6 +909,9 @@ typedef struct ks_dict_s {
 
     /* Maximum size allocated (via 'ks_nextsize()') */
     ks_size_t _max_len_ents, _max_len_buckets_b;
+
+    /* Inline entries, which 'ents' points to until the dictionary outgrows them */
+    struct ks_dict_ent _small_ents[KS_DICT_SMALL];
     
 }* ks_dict;
 
@@ -763,9 +987,14 @@ typedef struct ks_logger_s {
 
 }* ks_logger;
 
+/* Maximum number of format arguments an exception can hold on to (beyond this, its message is
+ *   rendered when it is created)
+ */
+#define KS_EXC_MAXFARGS 8
+
 /* 'Exception' - object typically thrown up the call stack
  *
- * 
+ *
  */
 typedef struct ks_Exception_s {
     KSO_BASE
@@ -775,17 +1004,69 @@ typedef struct ks_Exception_s {
      */
     struct ks_Exception_s* inner;
 
-    /* The frames when the exception was thrown */
+    /* The frames when the exception was thrown
+     * While it is in flight, this holds the frames it has unwound through (innermost first), and
+     *   'n_pend' is the number of frames (from the bottom of the thread's stack) still to be copied
+     * Once it is caught, this is complete and in order (outermost first), and 'n_pend' is -1
+     */
     ks_list frames;
+    int n_pend;
 
     /* Arguments to the exception's constructor */
     ks_list args;
 
-    /* String describing the error */
+    /* String describing the error, or NULL if it hasn't been rendered yet
+     * Use 'ks_Exception_what()' to get it
+     */
     ks_str what;
 
+    /* C-style format string which 'what' is rendered from, and a snapshot of the arguments given
+     *   with it (see 'ks_Exception_new_cv()')
+     */
+    const char* fmt;
+    int n_fargs;
+    union {
+        ks_cint i;
+        ks_uint u;
+        ks_cfloat f;
+        kso o;
+        struct {
+            int len;
+            char* data;
+        } s;
+    } fargs[KS_EXC_MAXFARGS];
+
 }* ks_Exception;
 
+/* Flags for builtin types, which are set in the 'tflags' of every type that is a subtype of them
+ *
+ * Use 'KS_TYPE_HAS()' to test them, which is equivalent to 'kso_issub()' with the builtin type
+ */
+enum {
+    KS_TF_NUMBER     = 1 << 0,
+    KS_TF_INT        = 1 << 1,
+    KS_TF_BOOL       = 1 << 2,
+    KS_TF_FLOAT      = 1 << 3,
+    KS_TF_COMPLEX    = 1 << 4,
+    KS_TF_STR        = 1 << 5,
+    KS_TF_BYTES      = 1 << 6,
+    KS_TF_LIST       = 1 << 7,
+    KS_TF_TUPLE      = 1 << 8,
+    KS_TF_DICT       = 1 << 9,
+    KS_TF_SET        = 1 << 10,
+    KS_TF_FUNC       = 1 << 11,
+    KS_TF_PARTIAL    = 1 << 12,
+    KS_TF_TYPE       = 1 << 13,
+    KS_TF_NONE       = 1 << 14,
+    KS_TF_UNDEFINED  = 1 << 15,
+    KS_TF_SLICE      = 1 << 16,
+    KS_TF_RANGE      = 1 << 17,
+    KS_TF_EXCEPTION  = 1 << 18,
+};
+
+/* Test whether a type is a subtype of the builtin type described by '_fl' (one of 'KS_TF_*') */
+#define KS_TYPE_HAS(_tp, _fl) (((_tp)->tflags & (_fl)) != 0)
+
 struct ks_type_s {
     KSO_BASE
 
@@ -802,9 +1083,32 @@ struct ks_type_s {
     ks_cint n_subs;
     ks_type* subs;
 
+    /* Flattened list of the base types, starting with 'object' and ending with this type, so that
+     *   'kso_issub(A, B)' iff 'A->bases[B->n_bases - 1] == B'
+     */
+    ks_cint n_bases;
+    ks_type* bases;
+
+    /* Builtin types this type is a subtype of ('KS_TF_*' flags) */
+    ks_uint tflags;
+
     /* Integer sizes and attribute dictionary offsets of instances */
     ks_cint ob_sz, ob_attr;
 
+    /* Fixed attributes ('__slots') of instances, which are stored inline rather than in the attribute
+     *   dictionary (including those inherited from base types)
+     */
+    ks_cint n_slots;
+    struct ks_type_slot {
+
+        /* Name of the attribute */
+        ks_str name;
+
+        /* Offset (in bytes) of the value within instances, which is NULL if it has not been set */
+        ks_cint off;
+
+    }* slots;
+
     /* Number of objects created and deleted */
     ks_cint num_obs_new, num_obs_del;
 
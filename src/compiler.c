@@ -442,7 +442,7 @@ static bool compile(struct compiler* co, ks_str fname, ks_str src, ks_code code,
         while (ip < name->len_b && name->data[ip] != '.') {
             ip++;
         }
-        ks_str toname = ks_str_new(ip, name->data);
+        ks_str toname = ks_str_intern_c(ip, name->data);
 
         EMITO(KSB_STORE, toname);
         KS_DECREF(toname);
@@ -524,6 +524,7 @@ static bool compile(struct compiler* co, ks_str fname, ks_str src, ks_code code,
                     if (!COMPILE((ks_ast)SUB(i)->args->elems[0])) return false;
                     EMIT(KSB_TUPLE_PUSHI);
                     LEN -= 1;
+                    j = i+1;
                 } else {
                     if (!COMPILE(SUB(i))) return false;
 
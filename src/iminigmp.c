@@ -614,14 +614,17 @@ mpn_submul_1 (mp_ptr rp, mp_srcptr up, mp_size_t n, mp_limb_t vl)
   return cl;
 }
 
-mp_limb_t
-mpn_mul (mp_ptr rp, mp_srcptr up, mp_size_t un, mp_srcptr vp, mp_size_t vn)
-{
-  assert (un >= vn);
-  assert (vn >= 1);
-  assert (!GMP_MPN_OVERLAP_P(rp, un + vn, up, un));
-  assert (!GMP_MPN_OVERLAP_P(rp, un + vn, vp, vn));
+/* Operand sizes (in limbs) at which the subquadratic algorithms take
+   over from the schoolbook ones. These were tuned by timing 'int'
+   multiplication, division and conversion to and from 'str'. */
+#define MUL_KARATSUBA_THRESHOLD 16
+#define DIV_DC_THRESHOLD 32
+#define GET_STR_DC_THRESHOLD 24
+#define SET_STR_DC_THRESHOLD 24
 
+static mp_limb_t
+mpn_mul_basecase (mp_ptr rp, mp_srcptr up, mp_size_t un, mp_srcptr vp, mp_size_t vn)
+{
   /* We first multiply by the low order limb. This result can be
      stored, not added, to rp. We also avoid a loop for zeroing this
      way. */
@@ -639,6 +642,108 @@ mpn_mul (mp_ptr rp, mp_srcptr up, mp_size_t un, mp_srcptr vp, mp_size_t vn)
   return rp[un];
 }
 
+/* Karatsuba multiplication of two n-limb numbers (squaring when ap ==
+   bp). With a = a1 B^l + a0 and b = b1 B^l + b0,
+
+     a b = a1 b1 B^2l + (a0 b0 + a1 b1 - (a1 - a0)(b1 - b0)) B^l + a0 b0
+
+   so only three half-size products are needed. */
+static void
+mpn_mul_karatsuba (mp_ptr rp, mp_srcptr ap, mp_srcptr bp, mp_size_t n)
+{
+  mp_size_t l, h;
+  mp_ptr tp, dp, mp;
+  int neg;
+
+  l = n >> 1;
+  h = n - l;
+
+  /* Low and high products go straight into place */
+  mpn_mul (rp, ap, l, bp, l);
+  mpn_mul (rp + 2 * l, ap + l, h, bp + l, h);
+
+  /* tp holds |a1 - a0|, |b1 - b0|, their product, and the middle term */
+  tp = gmp_xalloc_limbs (6 * h + 1);
+  dp = tp + 2 * h;
+  mp = tp + 4 * h;
+
+  neg = 0;
+  if ((h > l && ap[l + l] != 0) || mpn_cmp (ap + l, ap, l) >= 0)
+    mpn_sub (tp, ap + l, h, ap, l);
+  else
+    {
+      mpn_sub_n (tp, ap, ap + l, l);
+      if (h > l)
+	tp[l] = 0;
+      neg = 1;
+    }
+
+  if (ap == bp)
+    {
+      mpn_mul (dp, tp, h, tp, h);
+      neg = 0;
+    }
+  else
+    {
+      if ((h > l && bp[l + l] != 0) || mpn_cmp (bp + l, bp, l) >= 0)
+	mpn_sub (tp + h, bp + l, h, bp, l);
+      else
+	{
+	  mpn_sub_n (tp + h, bp, bp + l, l);
+	  if (h > l)
+	    tp[h + l] = 0;
+	  neg ^= 1;
+	}
+      mpn_mul (dp, tp, h, tp + h, h);
+    }
+
+  /* Middle term: a0 b0 + a1 b1 -/+ |a1 - a0| |b1 - b0|, which is
+     non-negative and fits in 2h + 1 limbs */
+  mp[2 * h] = mpn_add (mp, rp + 2 * l, 2 * h, rp, 2 * l);
+  if (neg)
+    mp[2 * h] += mpn_add_n (mp, mp, dp, 2 * h);
+  else
+    mp[2 * h] -= mpn_sub_n (mp, mp, dp, 2 * h);
+
+  gmp_assert_nocarry (mpn_add (rp + l, rp + l, n + h, mp, 2 * h + 1));
+  gmp_free (tp);
+}
+
+mp_limb_t
+mpn_mul (mp_ptr rp, mp_srcptr up, mp_size_t un, mp_srcptr vp, mp_size_t vn)
+{
+  assert (un >= vn);
+  assert (vn >= 1);
+  assert (!GMP_MPN_OVERLAP_P(rp, un + vn, up, un));
+  assert (!GMP_MPN_OVERLAP_P(rp, un + vn, vp, vn));
+
+  if (vn < MUL_KARATSUBA_THRESHOLD)
+    return mpn_mul_basecase (rp, up, un, vp, vn);
+  else if (un == vn)
+    mpn_mul_karatsuba (rp, up, vp, un);
+  else
+    {
+      /* Unbalanced, so multiply by vn-limb pieces of up and add them up */
+      mp_ptr tp;
+      mp_size_t i;
+
+      tp = gmp_xalloc_limbs (2 * vn);
+      mpn_mul_karatsuba (rp, up, vp, vn);
+      for (i = vn; i + vn <= un; i += vn)
+	{
+	  mpn_mul_karatsuba (tp, up + i, vp, vn);
+	  gmp_assert_nocarry (mpn_add (rp + i, tp, 2 * vn, rp + i, vn));
+	}
+      if (i < un)
+	{
+	  mpn_mul (tp, vp, vn, up + i, un - i);
+	  gmp_assert_nocarry (mpn_add (rp + i, tp, un - i + vn, rp + i, vn));
+	}
+      gmp_free (tp);
+    }
+  return rp[un + vn - 1];
+}
+
 void
 mpn_mul_n (mp_ptr rp, mp_srcptr ap, mp_srcptr bp, mp_size_t n)
 {
@@ -1100,6 +1205,125 @@ mpn_div_qr_pi1 (mp_ptr qp,
   np[dn - 1] = n1;
 }
 
+/* Divide <np, nn> by <dp, dn> (normalized, dn > 2), storing nn - dn
+   quotient limbs in qp and the remainder in the low dn limbs of np, and
+   returning the high quotient limb (0 or 1). */
+static mp_limb_t
+mpn_div_qr_sb (mp_ptr qp, mp_ptr np, mp_size_t nn,
+	       mp_srcptr dp, mp_size_t dn, mp_limb_t dinv)
+{
+  mp_limb_t qh;
+
+  qh = mpn_cmp (np + nn - dn, dp, dn) >= 0;
+  if (qh)
+    gmp_assert_nocarry (mpn_sub_n (np + nn - dn, np + nn - dn, dp, dn));
+
+  mpn_div_qr_pi1 (qp, np, nn - 1, np[nn - 1], dp, dn, dinv);
+  return qh;
+}
+
+/* Divide-and-conquer division of the 2n-limb <np> by the n-limb <dp>
+   (Burnikel and Ziegler), with the same conventions as mpn_div_qr_sb.
+   Each half of the quotient is found by recursively dividing by the high
+   half of the divisor, and then corrected with a multiplication by the
+   low half. tp must have room for n limbs. */
+static mp_limb_t
+mpn_div_qr_dc_n (mp_ptr qp, mp_ptr np, mp_srcptr dp, mp_size_t n,
+		 mp_limb_t dinv, mp_ptr tp)
+{
+  mp_size_t lo, hi;
+  mp_limb_t cy, qh, ql;
+
+  lo = n >> 1;
+  hi = n - lo;
+
+  if (hi < DIV_DC_THRESHOLD)
+    qh = mpn_div_qr_sb (qp + lo, np + 2 * lo, 2 * hi, dp + lo, hi, dinv);
+  else
+    qh = mpn_div_qr_dc_n (qp + lo, np + 2 * lo, dp + lo, hi, dinv, tp);
+
+  mpn_mul (tp, qp + lo, hi, dp, lo);
+
+  cy = mpn_sub_n (np + lo, np + lo, tp, n);
+  if (qh != 0)
+    cy += mpn_sub_n (np + n, np + n, dp, lo);
+
+  while (cy != 0)
+    {
+      qh -= mpn_sub_1 (qp + lo, qp + lo, hi, 1);
+      cy -= mpn_add_n (np + lo, np + lo, dp, n);
+    }
+
+  if (lo < DIV_DC_THRESHOLD)
+    ql = mpn_div_qr_sb (qp, np + hi, 2 * lo, dp + hi, lo, dinv);
+  else
+    ql = mpn_div_qr_dc_n (qp, np + hi, dp + hi, lo, dinv, tp);
+
+  mpn_mul (tp, dp, hi, qp, lo);
+
+  cy = mpn_sub_n (np, np, tp, n);
+  if (ql != 0)
+    cy += mpn_sub_n (np + lo, np + lo, dp, hi);
+
+  while (cy != 0)
+    {
+      mpn_sub_1 (qp, qp, lo, 1);
+      cy -= mpn_add_n (np, np, dp, n);
+    }
+
+  return qh;
+}
+
+/* Divide <np, nn> by the normalized <dp, dn>, where the high dn limbs of
+   np are less than dp, storing nn - dn quotient limbs in qp and the
+   remainder in the low dn limbs of np. The quotient is found dn limbs at
+   a time, starting with a (possibly shorter) block at the top. */
+static void
+mpn_div_qr_dc (mp_ptr qp, mp_ptr np, mp_size_t nn,
+	       mp_srcptr dp, mp_size_t dn, mp_limb_t dinv)
+{
+  mp_size_t qn, k;
+  mp_limb_t cy, qh;
+  mp_ptr tp;
+
+  tp = gmp_xalloc_limbs (dn);
+
+  qn = nn - dn;
+  k = qn % dn;
+  qn -= k;
+  if (k > 0 && k < DIV_DC_THRESHOLD)
+    mpn_div_qr_pi1 (qp + qn, np + qn, dn + k - 1, np[qn + dn + k - 1], dp, dn, dinv);
+  else if (k > 0)
+    {
+      /* Divide by the high k limbs of the divisor, then correct */
+      qh = mpn_div_qr_dc_n (qp + qn, np + qn + dn - k, dp + dn - k, k, dinv, tp);
+
+      if (k > dn - k)
+	mpn_mul (tp, qp + qn, k, dp, dn - k);
+      else
+	mpn_mul (tp, dp, dn - k, qp + qn, k);
+
+      cy = mpn_sub_n (np + qn, np + qn, tp, dn);
+      if (qh != 0)
+	cy += mpn_sub_n (np + qn + k, np + qn + k, dp, dn - k);
+
+      while (cy != 0)
+	{
+	  qh -= mpn_sub_1 (qp + qn, qp + qn, k, 1);
+	  cy -= mpn_add_n (np + qn, np + qn, dp, dn);
+	}
+      assert (qh == 0);
+    }
+
+  while (qn > 0)
+    {
+      qn -= dn;
+      gmp_assert_nocarry (mpn_div_qr_dc_n (qp + qn, np + qn, dp, dn, dinv, tp));
+    }
+
+  gmp_free (tp);
+}
+
 static void
 mpn_div_qr_preinv (mp_ptr qp, mp_ptr np, mp_size_t nn,
 		   mp_srcptr dp, mp_size_t dn,
@@ -1127,7 +1351,25 @@ mpn_div_qr_preinv (mp_ptr qp, mp_ptr np, mp_size_t nn,
       else
 	nh = 0;
 
-      mpn_div_qr_pi1 (qp, np, nn, nh, dp, dn, inv->di);
+      if (dn >= DIV_DC_THRESHOLD && nn - dn >= DIV_DC_THRESHOLD)
+	{
+	  /* The high limb makes the dividend nn + 1 limbs */
+	  mp_ptr tp, tq;
+
+	  tp = gmp_xalloc_limbs (nn + 1);
+	  mpn_copyi (tp, np, nn);
+	  tp[nn] = nh;
+	  tq = qp ? qp : gmp_xalloc_limbs (nn - dn + 1);
+
+	  mpn_div_qr_dc (tq, tp, nn + 1, dp, dn, inv->di);
+
+	  mpn_copyi (np, tp, dn);
+	  gmp_free (tp);
+	  if (!qp)
+	    gmp_free (tq);
+	}
+      else
+	mpn_div_qr_pi1 (qp, np, nn, nh, dp, dn, inv->di);
 
       if (shift > 0)
 	gmp_assert_nocarry (mpn_rshift (np, np, dn, shift));
@@ -4187,21 +4429,96 @@ mpz_sizeinbase (const mpz_t u, int base)
 	 10. */
     }
 
-  tp = gmp_xalloc_limbs (un);
-  mpn_copyi (tp, up, un);
-  mpn_div_qr_1_invert (&bi, base);
+  /* Like GMP, the result may be 1 too big for other bases (counting the
+     digits exactly takes a division per digit, which is quadratic). The
+     tiny relative fudge makes sure rounding never gives too small of an
+     estimate */
+  return (size_t) ((double) bits / log2 (base) * (1.0 + 1e-12)) + 1;
+}
 
-  ndigits = 0;
-  do
+/* Write exactly sn digits (with leading zeros) of u < base^sn to sp,
+   destroying u. pows[j] is bb^(2^j), which has exp 2^j digits, and is
+   used to split u into halves that are converted recursively. */
+static void
+mpz_get_str_dc (unsigned char *sp, size_t sn, mpz_t u, int base,
+		const struct mpn_base_info *info, mpz_t *pows, int j)
+{
+  mp_size_t un;
+
+  un = GMP_ABS (u->_mp_size);
+  if (un < GET_STR_DC_THRESHOLD)
+    {
+      size_t n = 0;
+      if (un > 0)
+	n = mpn_get_str_other (sp, base, info, u->_mp_d, un);
+      assert (n <= sn);
+      memmove (sp + sn - n, sp, n);
+      memset (sp, 0, sn - n);
+    }
+  else
     {
-      ndigits++;
-      mpn_div_qr_1_preinv (tp, tp, un, &bi);
-      un -= (tp[un-1] == 0);
+      size_t d;
+      mpz_t q;
+
+      while (j > 0 && ((size_t) info->exp << j) * 2 > sn)
+	j--;
+      d = (size_t) info->exp << j;
+
+      mpz_init (q);
+      mpz_tdiv_qr (q, u, u, pows[j]);
+      mpz_get_str_dc (sp, sn - d, q, base, info, pows, j);
+      mpz_get_str_dc (sp + sn - d, d, u, base, info, pows, j);
+      mpz_clear (q);
     }
-  while (un > 0);
+}
 
-  gmp_free (tp);
-  return ndigits;
+/* Parse the sn digits at sp into r, the opposite of mpz_get_str_dc
+   (pows[j] must have less than sn digits) */
+static void
+mpz_set_str_dc (mpz_t r, const unsigned char *sp, size_t sn, int base,
+		const struct mpn_base_info *info, mpz_t *pows, int j)
+{
+  if (sn < SET_STR_DC_THRESHOLD * info->exp)
+    {
+      mp_size_t rn;
+      mp_ptr rp;
+
+      rp = MPZ_REALLOC (r, (sn + info->exp - 1) / info->exp);
+      rn = mpn_set_str_other (rp, sp, sn, base, info);
+      r->_mp_size = mpn_normalized_size (rp, rn);
+    }
+  else
+    {
+      size_t d;
+      mpz_t lo;
+
+      while (j > 0 && ((size_t) info->exp << j) >= sn)
+	j--;
+      d = (size_t) info->exp << j;
+
+      mpz_init (lo);
+      mpz_set_str_dc (r, sp, sn - d, base, info, pows, j);
+      mpz_set_str_dc (lo, sp + sn - d, d, base, info, pows, j);
+      mpz_mul (r, r, pows[j]);
+      mpz_add (r, r, lo);
+      mpz_clear (lo);
+    }
+}
+
+/* Compute pows[j] = bb^(2^j) for as long as bb^(2^j) has less than sn/k
+   digits, returning the number of powers */
+static int
+mpz_base_pows (mpz_t *pows, size_t sn, size_t k, const struct mpn_base_info *info)
+{
+  int n;
+
+  mpz_init_set_ui (pows[0], info->bb);
+  for (n = 1; ((size_t) info->exp << n) * k < sn; n++)
+    {
+      mpz_init (pows[n]);
+      mpz_mul (pows[n], pows[n - 1], pows[n - 1]);
+    }
+  return n;
 }
 
 char *
@@ -4258,11 +4575,35 @@ mpz_get_str (char *sp, int base, const mpz_t u)
       mp_ptr tp;
 
       mpn_get_base_info (&info, base);
-      tp = gmp_xalloc_limbs (un);
-      mpn_copyi (tp, u->_mp_d, un);
+      if (un >= GET_STR_DC_THRESHOLD)
+	{
+	  mpz_t t, pows[GMP_LIMB_BITS];
+	  size_t z;
+	  int j, np;
+
+	  /* Convert the estimated number of digits, then take off leading zeros */
+	  sn -= 1;
+	  mpz_init (t);
+	  mpz_abs (t, u);
+	  np = mpz_base_pows (pows, sn, 2, &info);
+	  mpz_get_str_dc ((unsigned char *) sp + i, sn, t, base, &info, pows, np - 1);
+	  for (j = 0; j < np; j++)
+	    mpz_clear (pows[j]);
+	  mpz_clear (t);
+
+	  for (z = 0; z + 1 < sn && sp[i + z] == 0; z++)
+	    ;
+	  memmove (sp + i, sp + i + z, sn - z);
+	  sn = i + sn - z;
+	}
+      else
+	{
+	  tp = gmp_xalloc_limbs (un);
+	  mpn_copyi (tp, u->_mp_d, un);
 
-      sn = i + mpn_get_str_other ((unsigned char *) sp + i, base, &info, tp, un);
-      gmp_free (tp);
+	  sn = i + mpn_get_str_other ((unsigned char *) sp + i, base, &info, tp, un);
+	  gmp_free (tp);
+	}
     }
 
   for (; i < sn; i++)
@@ -4363,11 +4704,25 @@ mpz_set_str (mpz_t r, const char *sp, int base)
       struct mpn_base_info info;
       mpn_get_base_info (&info, base);
       alloc = (dn + info.exp - 1) / info.exp;
-      rp = MPZ_REALLOC (r, alloc);
-      rn = mpn_set_str_other (rp, dp, dn, base, &info);
-      /* Normalization, needed for all-zero input. */
-      assert (rn > 0);
-      rn -= rp[rn-1] == 0;
+      if (dn >= SET_STR_DC_THRESHOLD * info.exp)
+	{
+	  mpz_t pows[GMP_LIMB_BITS];
+	  int j, np;
+
+	  np = mpz_base_pows (pows, dn, 1, &info);
+	  mpz_set_str_dc (r, dp, dn, base, &info, pows, np - 1);
+	  for (j = 0; j < np; j++)
+	    mpz_clear (pows[j]);
+	  rn = r->_mp_size;
+	}
+      else
+	{
+	  rp = MPZ_REALLOC (r, alloc);
+	  rn = mpn_set_str_other (rp, dp, dn, base, &info);
+	  /* Normalization, needed for all-zero input. */
+	  assert (rn > 0);
+	  rn -= rp[rn-1] == 0;
+	}
     }
   assert (rn <= alloc);
   gmp_free (dp);
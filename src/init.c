@@ -19,6 +19,7 @@ ks_str
     _ksva__src,
     _ksva__sig,
     _ksva__doc,
+    _ksva__slots,
 
 #define _KSACT(_attr) _ksva##_attr,
 _KS_DO_SPEC(_KSACT)
@@ -61,15 +62,23 @@ static ks_module
 KS_API bool ks_init() {
     if (has_init) return true;
 
+    /* Seed hashing before any strings are created */
+    _ksi_hash();
+
     kst_func->ob_sz = sizeof(struct ks_func_s);
     kst_func->ob_attr = offsetof(struct ks_func_s, attr);
     kst_str->ob_sz = sizeof(struct ks_str_s);
     kst_tuple->ob_sz = sizeof(struct ks_tuple_s);
 
+    /* These are used (i.e. for hashing attribute names) before they have been initialized */
+    kst_str->tflags = KS_TF_STR;
+    kst_tuple->tflags = KS_TF_TUPLE;
+    kst_func->tflags = KS_TF_FUNC;
+
     /* Initialize types */
 
     /* String constants */
-    #define _CONST(_v, _s) _v = ks_str_new(sizeof(_s) - 1, _s);
+    #define _CONST(_v, _s) _v = ks_str_intern_c(sizeof(_s) - 1, _s);
 
 #define _KSACT(_attr) _CONST(_ksva##_attr, #_attr);
 _KS_DO_SPEC(_KSACT)
@@ -93,6 +102,7 @@ _KS_DO_SPEC(_KSACT)
     _CONST(_ksva__src, "__src");
     _CONST(_ksva__sig, "__sig");
     _CONST(_ksva__doc, "__doc");
+    _CONST(_ksva__slots, "__slots");
 
     _ksi_object();
     _ksi_type();
@@ -110,6 +120,8 @@ _KS_DO_SPEC(_KSACT)
 
     _ksi_str();
     _ksi_bytes();
+    _ksi_bytearray();
+    _ksi_memoryview();
     _ksi_regex();
 
     _ksi_slice();
@@ -187,6 +199,8 @@ _KS_DO_SPEC(_KSACT)
 
         {"str",                    (kso)kst_str},
         {"bytes",                  (kso)kst_bytes},
+        {"bytearray",              (kso)kst_bytearray},
+        {"memoryview",             (kso)kst_memoryview},
         {"regex",                  (kso)kst_regex},
 
         {"slice",                  (kso)kst_slice},
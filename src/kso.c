@@ -8,8 +8,10 @@
 
 bool kso_issub(ks_type a, ks_type b) {
     if (a == b) return true;
-    if (a == kst_object) return false;
-    return kso_issub(a->i__base, b);
+
+    /* 'b' is at the same position in the flattened bases of all of its subtypes */
+    ks_cint i = b->n_bases - 1;
+    return i >= 0 && i < a->n_bases && a->bases[i] == b;
 }
 bool kso_isinst(kso a, ks_type b) {
     return kso_issub(a->type, b);
@@ -38,24 +40,24 @@ void kso_outrepr() {
 
 
 bool kso_truthy(kso ob, bool* out) {
-    if (kso_issub(ob->type, kst_int) && ob->type->i__bool == kst_int->i__bool) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_INT) && ob->type->i__bool == kst_int->i__bool) {
         ks_int obi = (ks_int)ob;
         #ifdef KS_INT_GMP
         *out = mpz_cmp_si(obi->val, 0) != 0;
         return true;
         #endif
-    } else if (kso_issub(ob->type, kst_none) || kso_issub(ob->type, kst_undefined)) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_NONE) || KS_TYPE_HAS(ob->type, KS_TF_UNDEFINED)) {
         *out = false;
         return true;
-    } else if (kso_issub(ob->type, kst_float) && ob->type->i__bool == kst_float->i__bool) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_FLOAT) && ob->type->i__bool == kst_float->i__bool) {
         ks_float obf = (ks_float)ob;
         *out = obf->val != 0;
         return true;
-    } else if (kso_issub(ob->type, kst_complex) && ob->type->i__bool == kst_complex->i__bool) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_COMPLEX) && ob->type->i__bool == kst_complex->i__bool) {
         ks_complex obf = (ks_complex)ob;
         *out = !KS_CC_EQRI(obf->val, 0, 0);
         return true;
-    } else if (kso_issub(ob->type, kst_str) && ob->type->i__bool == kst_str->i__bool) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_STR) && ob->type->i__bool == kst_str->i__bool) {
         *out = ((ks_str)ob)->len_b > 0;
         return true;
     } else if (ob->type->i__bool) {
@@ -74,10 +76,10 @@ bool kso_truthy(kso ob, bool* out) {
 }
 
 bool kso_cmp(kso L, kso R, int* out) {
-    if (kso_isinst(L, kst_str) && kso_isinst(R, kst_str)) {
+    if (KS_TYPE_HAS(L->type, KS_TF_STR) && KS_TYPE_HAS(R->type, KS_TF_STR)) {
         *out = ks_str_cmp((ks_str)L, (ks_str)R);
         return true;
-    } else if (kso_isinst(L, kst_int) && kso_isinst(R, kst_int) && L->type->i__cmp == kst_int->i__cmp) {
+    } else if (KS_TYPE_HAS(L->type, KS_TF_INT) && KS_TYPE_HAS(R->type, KS_TF_INT) && L->type->i__cmp == kst_int->i__cmp) {
         *out = mpz_cmp(((ks_int)L)->val, ((ks_int)R)->val);
         return true;
     } else if (L->type->i__cmp == kst_object->i__cmp) {
@@ -131,10 +133,10 @@ bool kso_cmp(kso L, kso R, int* out) {
 
 
 bool kso_eq(kso L, kso R, bool* out) {
-    if (kso_isinst(L, kst_str) && kso_isinst(R, kst_str)) {
+    if (KS_TYPE_HAS(L->type, KS_TF_STR) && KS_TYPE_HAS(R->type, KS_TF_STR)) {
         *out = L == R || ks_str_eq((ks_str)L, (ks_str)R);
         return true;
-    } else if (kso_isinst(L, kst_int) && kso_isinst(R, kst_int) && L->type->i__eq == kst_int->i__eq) {
+    } else if (KS_TYPE_HAS(L->type, KS_TF_INT) && KS_TYPE_HAS(R->type, KS_TF_INT) && L->type->i__eq == kst_int->i__eq) {
         if (L == R) {
             *out = true;
         } else {
@@ -178,16 +180,19 @@ bool kso_eq(kso L, kso R, bool* out) {
 }
 
 bool kso_hash(kso ob, ks_hash_t* val) {
-    if (kso_isinst(ob, kst_int) && ob->type->i__hash == kst_int->i__hash) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_INT) && ob->type->i__hash == kst_int->i__hash) {
         ks_int v = (ks_int)ob;
 
         /* Calculate hash */
         *val = mpz_fdiv_ui(v->val, KS_HASH_P);
         return true;
-    } else if (kso_isinst(ob, kst_str) && ob->type->i__hash == kst_str->i__hash) {
-        *val = ((ks_str)ob)->v_hash;
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_STR) && ob->type->i__hash == kst_str->i__hash) {
+        *val = KS_STR_HASH((ks_str)ob);
+        return true;
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_BYTES) && ob->type->i__hash == kst_bytes->i__hash) {
+        *val = KS_BYTES_HASH((ks_bytes)ob);
         return true;
-    } else if (kso_isinst(ob, kst_tuple) && ob->type->i__hash == kst_tuple->i__hash) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_TUPLE) && ob->type->i__hash == kst_tuple->i__hash) {
         *val = 0;
         ks_tuple v = (ks_tuple)ob;
         ks_cint i;
@@ -203,7 +208,7 @@ bool kso_hash(kso ob, ks_hash_t* val) {
     } else if (ob->type->i__hash) {
         ks_int r = (ks_int)kso_call(ob->type->i__hash, 1, &ob);
         if (!r) return false;
-        else if (!kso_issub(r->type, kst_int)) {
+        else if (!KS_TYPE_HAS(r->type, KS_TF_INT)) {
             KS_THROW(kst_TypeError, "'%T.__hash' returned non-int object of type '%T'", r);
             KS_DECREF(r);
             return false;
@@ -224,7 +229,7 @@ bool kso_len(kso ob, ks_ssize_t* val) {
 }
 
 bool kso_get_ci(kso ob, ks_cint* val) {
-    if (kso_issub(ob->type, kst_int)) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_INT)) {
         ks_int obi = (ks_int)ob;
         #ifdef KS_INT_GMP
         if (mpz_fits_slong_p(obi->val)) {
@@ -261,7 +266,7 @@ bool kso_get_ci(kso ob, ks_cint* val) {
     return false;
 }
 bool kso_get_ui(kso ob, ks_uint* val) {
-    if (kso_issub(ob->type, kst_int)) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_INT)) {
         ks_int obi = (ks_int)ob;
         #ifdef KS_INT_GMP
         if (mpz_fits_ulong_p(obi->val)) {
@@ -280,13 +285,13 @@ bool kso_get_ui(kso ob, ks_uint* val) {
     return false;
 }
 bool kso_get_cf(kso ob, ks_cfloat* val) {
-    if (kso_issub(ob->type, kst_int)) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_INT)) {
         ks_int obi = (ks_int)ob;
         #ifdef KS_INT_GMP
         *val = mpz_get_d(obi->val);
         return true;
         #endif
-    } else if (kso_issub(ob->type, kst_float)) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_FLOAT)) {
         *val = ((ks_float)ob)->val;
         return true;
     } else if (ob->type->i__float) {
@@ -302,16 +307,16 @@ bool kso_get_cf(kso ob, ks_cfloat* val) {
     return false;
 }
 bool kso_get_cc(kso ob, ks_ccomplex* val) {
-    if (kso_issub(ob->type, kst_int)) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_INT)) {
         ks_int obi = (ks_int)ob;
         #ifdef KS_INT_GMP
         *val = KS_CC_MAKE(mpz_get_d(obi->val), 0);
         return true;
         #endif
-    } else if (kso_issub(ob->type, kst_float)) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_FLOAT)) {
         *val = KS_CC_MAKE(((ks_float)ob)->val, 0);
         return true;
-    } else if (kso_issub(ob->type, kst_complex)) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_COMPLEX)) {
         *val = ((ks_complex)ob)->val;
         return true;
     } else if (ob->type->i__complex) {
@@ -336,7 +341,7 @@ bool kso_get_cc(kso ob, ks_ccomplex* val) {
 
 
 ks_str kso_str(kso ob) {
-    if (kso_issub(ob->type, kst_str)) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_STR)) {
         KS_INCREF(ob);
         return (ks_str)ob;
     } else {
@@ -344,14 +349,14 @@ ks_str kso_str(kso ob) {
     }
 }
 ks_bytes kso_bytes(kso ob) {
-    if (kso_issub(ob->type, kst_bytes)) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_BYTES)) {
         KS_INCREF(ob);
         return (ks_bytes)ob;
     } else if (ob->type->i__bytes) {
         ks_bytes r = (ks_bytes)kso_call(ob->type->i__bytes, 1, &ob);
         if (!r) return NULL;
 
-        if (!kso_issub(r->type, kst_bytes)) {
+        if (!KS_TYPE_HAS(r->type, KS_TF_BYTES)) {
             KS_THROW(kst_TypeError, "'%T.__bytes()' returned non-'bytes' object of type '%T'", ob, r);
             KS_DECREF(r);
             return NULL;
@@ -367,20 +372,20 @@ ks_str kso_repr(kso ob) {
     return ks_fmt("%R", ob);
 }
 ks_number kso_number(kso ob) {
-    if (kso_issub(ob->type, kst_number)) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_NUMBER)) {
         KS_INCREF(ob);
         return (ks_number)ob;
     }
     return (ks_number)kso_call((kso)kst_number, 1, &ob);
 }
 ks_int kso_int(kso ob) {
-    if (kso_issub(ob->type, kst_int)) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_INT)) {
         KS_INCREF(ob);
         return (ks_int)ob;
     } else if (ob->type->i__int) {
         ks_int res = (ks_int)kso_call(ob->type->i__int, 1, &ob);
         if (!res) return NULL;
-        if (!kso_issub(res->type, kst_int)) {
+        if (!KS_TYPE_HAS(res->type, KS_TF_INT)) {
             KS_THROW(kst_TypeError, "'%T.__int()' returned non-'bytes' object of type '%T'", ob, res);
             KS_DECREF(res);
             return NULL;
@@ -389,7 +394,7 @@ ks_int kso_int(kso ob) {
     } else if (ob->type->i__integral) {
         ks_int res = (ks_int)kso_call(ob->type->i__integral, 1, &ob);
         if (!res) return NULL;
-        if (!kso_issub(res->type, kst_int)) {
+        if (!KS_TYPE_HAS(res->type, KS_TF_INT)) {
             KS_THROW(kst_TypeError, "'%T.__integral()' returned non-'bytes' object of type '%T'", ob, res);
             KS_DECREF(res);
             return NULL;
@@ -403,26 +408,26 @@ ks_int kso_int(kso ob) {
 
 
 bool kso_is_num(kso obj) {
-    return kso_issub(obj->type, kst_number);
+    return KS_TYPE_HAS(obj->type, KS_TF_NUMBER);
 }
 
 bool kso_is_int(kso obj) {
-    return kso_issub(obj->type, kst_int) || obj->type->i__integral;
+    return KS_TYPE_HAS(obj->type, KS_TF_INT) || obj->type->i__integral;
 }
 
 bool kso_is_float(kso obj) {
-    return kso_issub(obj->type, kst_float) || obj->type->i__float;
+    return KS_TYPE_HAS(obj->type, KS_TF_FLOAT) || obj->type->i__float;
 }
 
 bool kso_is_complex(kso obj) {
-    return kso_issub(obj->type, kst_complex) || obj->type->i__complex;
+    return KS_TYPE_HAS(obj->type, KS_TF_COMPLEX) || obj->type->i__complex;
 }
 bool kso_is_iterable(kso obj) {
     return obj->type->i__iter || obj->type->i__next;
 }
 
 bool kso_is_callable(kso obj) {
-    return kso_issub(obj->type, kst_type) || kso_issub(obj->type, kst_func) || kso_issub(obj->type, kst_partial) || obj->type->i__call;
+    return KS_TYPE_HAS(obj->type, KS_TF_TYPE) || KS_TYPE_HAS(obj->type, KS_TF_FUNC) || KS_TYPE_HAS(obj->type, KS_TF_PARTIAL) || obj->type->i__call;
 }
 
 
@@ -432,15 +437,31 @@ ks_dict kso_try_getattr_dict(kso obj) {
     } else return NULL;
 }
 
-kso kso_getattr(kso ob, ks_str attr) {
-    ksos_thread th = ksos_thread_get();
+ks_dict kso_getattr_dict(kso obj) {
+    if (obj->type->ob_attr > 0) {
+        ks_dict* attr = (ks_dict*)((ks_uint)obj + obj->type->ob_attr);
+        if (!*attr) *attr = ks_dict_new(NULL);
+        return *attr;
+    } else return NULL;
+}
 
-    if (kso_issub(ob->type, kst_type) && ob->type->i__getattr == kst_type->i__getattr) {
+/* Find the fixed attribute (from '__slots') named 'attr' in a type, or return NULL if there was none */
+static struct ks_type_slot* s_findslot(ks_type tp, ks_str attr) {
+    ks_cint i;
+    for (i = 0; i < tp->n_slots; ++i) {
+        ks_str name = tp->slots[i].name;
+        if (name == attr || (KS_STR_HASH(name) == KS_STR_HASH(attr) && ks_str_eq(name, attr))) return &tp->slots[i];
+    }
+    return NULL;
+}
+
+kso kso_getattr(kso ob, ks_str attr) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_TYPE) && ob->type->i__getattr == kst_type->i__getattr) {
 
         kso res = ks_type_get((ks_type)ob, attr);
         if (res) {
             return res;
-        } else if (kso_issub(th->exc->type, kst_AttrError)) {
+        } else if (kso_issub(ksos_thread_get()->exc->type, kst_AttrError)) {
             kso_catch_ignore();
         } else {
             return NULL;
@@ -451,23 +472,37 @@ kso kso_getattr(kso ob, ks_str attr) {
         kso res = kso_call(ob->type->i__getattr, 2, (kso[]){ ob, (kso)attr });
         if (res) {
             return res;
-        } else if (kso_issub(th->exc->type, kst_AttrError)) {
+        } else if (kso_issub(ksos_thread_get()->exc->type, kst_AttrError)) {
             kso_catch_ignore();
         } else {
             return NULL;
         }
     }
 
-    ks_dict attrdict = kso_try_getattr_dict(ob);
-    if (attrdict) {
+    if (ob->type->n_slots > 0) {
+        /* Check fixed attributes, which are stored in the object */
+        struct ks_type_slot* slot = s_findslot(ob->type, attr);
+        if (slot) {
+            kso res = *(kso*)((ks_uint)ob + slot->off);
+            if (res) return KS_NEWREF(res);
+
+            KS_THROW_ATTR(ob, attr);
+            return NULL;
+        }
+    }
+
+    if (ob->type->ob_attr > 0) {
         if (ks_str_eq_c(attr, "__attr", 6)) {
-            return KS_NEWREF(attrdict);
+            return KS_NEWREF(kso_getattr_dict(ob));
         }
 
-        /* Search for it */
-        kso res = ks_dict_get_ih(attrdict, (kso)attr, attr->v_hash);
-        if (res) {
-            return res;
+        /* Search for it (the dictionary is only created once an attribute is set) */
+        ks_dict attrdict = kso_try_getattr_dict(ob);
+        if (attrdict) {
+            kso res = ks_dict_get_ih(attrdict, (kso)attr, KS_STR_HASH(attr));
+            if (res) {
+                return res;
+            }
         }
     }
 
@@ -486,33 +521,43 @@ kso kso_getattr(kso ob, ks_str attr) {
     return NULL;
 }
 kso kso_getattr_c(kso ob, const char* attr) {
-    ks_str k = ks_str_new(-1, attr);
+    ks_str k = ks_str_intern_c(-1, attr);
     kso r = kso_getattr(ob, k);
     KS_DECREF(k);
     return r;
 }
 
 bool kso_setattr(kso ob, ks_str attr, kso val) {
-    ksos_thread th = ksos_thread_get();
-
     if (ob->type->i__setattr != kst_object->i__setattr) {
         /* Attempt to resolve it */
         kso res = kso_call(ob->type->i__setattr, 3, (kso[]){ ob, (kso)attr, val});
         if (res) {
             KS_DECREF(res);
             return true;
-        } else if (kso_issub(th->exc->type, kst_AttrError)) {
+        } else if (kso_issub(ksos_thread_get()->exc->type, kst_AttrError)) {
             kso_catch_ignore();
         } else {
             return false;
         }
     }
 
-    ks_dict attrdict = kso_try_getattr_dict(ob);
+    if (ob->type->n_slots > 0) {
+        /* Check fixed attributes, which are stored in the object */
+        struct ks_type_slot* slot = s_findslot(ob->type, attr);
+        if (slot) {
+            kso* pv = (kso*)((ks_uint)ob + slot->off);
+            KS_INCREF(val);
+            KS_NDECREF(*pv);
+            *pv = val;
+            return true;
+        }
+    }
+
+    ks_dict attrdict = kso_getattr_dict(ob);
     if (attrdict) {
 
         /* Search for it */
-        if (ks_dict_set_h(attrdict, (kso)attr, attr->v_hash, val)) {
+        if (ks_dict_set_h(attrdict, (kso)attr, KS_STR_HASH(attr), val)) {
             return true;
         } else {
             kso_catch_ignore();
@@ -539,60 +584,33 @@ kso kso_getelems(int n_keys, kso* keys) {
     assert(n_keys > 0);
     kso ob = keys[0];
 
-    if (kso_issub(ob->type, kst_str) && ob->type->i__getelem == kst_str->i__getelem) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_STR) && ob->type->i__getelem == kst_str->i__getelem) {
         if (n_keys != 2) {
             KS_THROW(kst_ArgError, "Expected 2 arguments to element indexing operation");
             return NULL;
         }
         ks_str lob = (ks_str)ob;
 
-        if (kso_issub(keys[1]->type, kst_slice)) {
+        if (KS_TYPE_HAS(keys[1]->type, KS_TF_SLICE)) {
             ks_cint first, last, delta;
-            if (!ks_slice_get_citer((ks_slice)keys[1], lob->len_c, &first, &last, &delta)) return NULL;
+            if (!ks_slice_get_citer((ks_slice)keys[1], KS_STR_LENC(lob), &first, &last, &delta)) return NULL;
 
             /* Check for specific cases */
             if (first == last) return (kso)ks_str_new(0, NULL);
-            ks_cint len = (last - first) / delta;
-
-            if (delta == 1 && KS_STR_IS_ASCII(lob)) {
-                /* Direct substring */
-                return (kso)ks_str_new(len, lob->data + first);
-            }
 
             if (delta == 1) {
                 /* Find range of bytes */
-                int pb = 0, pc = 0;
-
-                while (pc < first) {
-                    pc++;
-                    pb++;
-                    while (KS_UCP_IS_CONT(lob->data[pb])) pb++;
-                }
-
-                int spb = pb;
-
-                while (pc < last) {
-                    pc++;
-                    pb++;
-                    while (KS_UCP_IS_CONT(lob->data[pb])) pb++;
-                }
-
-                return (kso)ks_str_new(pb - spb, lob->data + spb);
+                ks_ssize_t spb = ks_str_off(lob, first);
+                return (kso)ks_str_sub(lob, spb, ks_str_off(lob, last) - spb);
 
             } else {
                 /* Now, build up a string */
                 ksio_StringIO sio = ksio_StringIO_new();
-                struct ks_str_citer cit = ks_str_citer_make(lob);
-
-                /* Build the string */
-                ks_str_citer_seek(&cit, first);
                 ks_cint ct = first;
 
                 do {
-                    int lbyi = cit.cbyi;
-                    ks_str_citer_next(&cit);
-                    ksio_addbuf(sio, cit.cbyi - lbyi, lob->data + lbyi);
-                    ks_str_citer_seek(&cit, cit.cchi + delta - 1);
+                    ks_ssize_t pb = ks_str_off(lob, ct);
+                    ksio_addbuf(sio, ks_str_off(lob, ct + 1) - pb, lob->data + pb);
                     ct += delta;
                 } while (ct != last);
 
@@ -604,35 +622,35 @@ kso kso_getelems(int n_keys, kso* keys) {
             if (!kso_get_ci(keys[1], &idx)) {
                 return NULL;
             }
-            if (idx < 0) idx += lob->len_c;
-            if (idx < 0 || idx >= lob->len_c) {
+            if (idx < 0) idx += KS_STR_LENC(lob);
+            if (idx < 0 || idx >= KS_STR_LENC(lob)) {
                 KS_THROW_INDEX(ob, keys[1]);
                 return NULL;
             }
-            if (KS_STR_IS_ASCII(lob)) {
-                return (kso)ks_str_new(1, lob->data + idx);
-            } else {
-                /* Seek to position */
-                int c = 0, b = 0, lb = 0;
-                while (c < idx) {
-                    /* Parse single character */
-                    lb = b;
-                    do {
-                        b++;
-                    } while (b < lob->len_b && (((unsigned char*)lob->data)[b] & 0x80) != 0);
-                    c++;
-                }
-
-                return (kso)ks_str_new(b - lb, lob->data + lb);
-            }
+            /* Seek to position */
+            ks_ssize_t pb = ks_str_off(lob, idx);
+            return (kso)ks_str_sub(lob, pb, ks_str_off(lob, idx + 1) - pb);
         }
-    } else if (kso_issub(ob->type, kst_bytes) && ob->type->i__getelem == kst_bytes->i__getelem) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_BYTES) && ob->type->i__getelem == kst_bytes->i__getelem) {
         if (n_keys != 2) {
             KS_THROW(kst_ArgError, "Expected 2 arguments to element indexing operation");
             return NULL;
         }
         ks_bytes lob = (ks_bytes)ob;
 
+        if (KS_TYPE_HAS(keys[1]->type, KS_TF_SLICE)) {
+            ks_cint first, last, delta;
+            if (!ks_slice_get_citer((ks_slice)keys[1], lob->len_b, &first, &last, &delta)) return NULL;
+
+            if (first == last) return (kso)ks_bytes_new(0, NULL);
+            if (delta == 1) return (kso)ks_bytes_sub(lob, first, last - first);
+
+            ks_cint i, n = (last - first) / delta;
+            char* data = ks_malloc(n);
+            for (i = 0; i < n; ++i) data[i] = lob->data[first + i * delta];
+            return (kso)ks_bytes_newn(n, data);
+        }
+
         ks_cint idx;
         if (!kso_get_ci(keys[1], &idx)) {
             return NULL;
@@ -642,27 +660,22 @@ kso kso_getelems(int n_keys, kso* keys) {
             KS_THROW_INDEX(ob, keys[1]);
             return NULL;
         }
-        return (kso)ks_bytes_new(1, lob->data + idx);
+        return (kso)ks_bytes_new(1, (char*)lob->data + idx);
 
-    } else if (kso_issub(ob->type, kst_list) && ob->type->i__getelem == kst_list->i__getelem) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_LIST) && ob->type->i__getelem == kst_list->i__getelem) {
         if (n_keys != 2) {
             KS_THROW(kst_ArgError, "Expected 2 arguments to element indexing operation");
             return NULL;
         }
         ks_list lob = (ks_list)ob;
 
-        if (kso_issub(keys[1]->type, kst_slice)) {
+        if (KS_TYPE_HAS(keys[1]->type, KS_TF_SLICE)) {
             ks_cint first, last, delta;
             if (!ks_slice_get_citer((ks_slice)keys[1], lob->len, &first, &last, &delta)) {
                 return NULL;
             }
-            ks_list res = ks_list_new(0, NULL);
-            ks_cint i;
-            for (i = first; i != last; i += delta) {
-                ks_list_push(res, lob->elems[i]);
-            }
 
-            return (kso)res;
+            return (kso)ks_list_slice(lob, first, last, delta);
         } else {
             ks_cint idx;
             if (!kso_get_ci(keys[1], &idx)) {
@@ -674,16 +687,16 @@ kso kso_getelems(int n_keys, kso* keys) {
                 return NULL;
             }
 
-            return KS_NEWREF(lob->elems[idx]);
+            return ks_list_get(lob, idx);
         }
-    } else if (kso_issub(ob->type, kst_tuple) && ob->type->i__getelem == kst_tuple->i__getelem) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_TUPLE) && ob->type->i__getelem == kst_tuple->i__getelem) {
         if (n_keys != 2) {
             KS_THROW(kst_ArgError, "Expected 2 arguments to element indexing operation");
             return NULL;
         }
         ks_tuple lob = (ks_tuple)ob;
 
-        if (kso_issub(keys[1]->type, kst_slice)) {
+        if (KS_TYPE_HAS(keys[1]->type, KS_TF_SLICE)) {
             ks_cint first, last, delta;
             if (!ks_slice_get_citer((ks_slice)keys[1], lob->len, &first, &last, &delta)) {
                 return NULL;
@@ -709,7 +722,7 @@ kso kso_getelems(int n_keys, kso* keys) {
 
             return KS_NEWREF(lob->elems[idx]);
         }
-    } else if (kso_issub(ob->type, kst_dict) && ob->type->i__getelem == kst_dict->i__getelem) {
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_DICT) && ob->type->i__getelem == kst_dict->i__getelem) {
         if (n_keys != 2) {
             KS_THROW(kst_ArgError, "Expected 2 arguments to element indexing operation");
             return NULL;
@@ -726,7 +739,7 @@ kso kso_getelems(int n_keys, kso* keys) {
 bool kso_setelems(int n_keys, kso* keys) {
     assert(n_keys > 1);
     kso ob = keys[0];
-    if (kso_issub(ob->type, kst_list) && ob->type->i__setelem == kst_list->i__setelem) {
+    if (KS_TYPE_HAS(ob->type, KS_TF_LIST) && ob->type->i__setelem == kst_list->i__setelem) {
         if (n_keys != 3) {
             KS_THROW(kst_ArgError, "Expected 3 arguments to element indexing operation");
             return NULL;
@@ -742,13 +755,9 @@ bool kso_setelems(int n_keys, kso* keys) {
             KS_THROW_INDEX(ob, keys[1]);
             return NULL;
         }
-        
-        KS_INCREF(keys[2]);
-        KS_DECREF(lob->elems[idx]);
-        lob->elems[idx] = keys[2];
 
-        return true;
-    } else if (kso_issub(ob->type, kst_dict) && ob->type->i__setelem == kst_dict->i__setelem) {
+        return ks_list_set(lob, idx, keys[2]);
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_DICT) && ob->type->i__setelem == kst_dict->i__setelem) {
         if (n_keys != 3) {
             KS_THROW(kst_ArgError, "Expected 3 arguments to element indexing operation");
             return NULL;
@@ -772,7 +781,10 @@ bool kso_delelems(int n_keys, kso* keys) {
 
 
 kso kso_call_ext(kso func, int nargs, kso* args, ks_dict locals, ksos_frame closure) {
-    ksos_thread th = ksos_thread_get();
+    return _kso_call_ext(ksos_thread_get(), func, nargs, args, locals, closure);
+}
+
+kso _kso_call_ext(ksos_thread th, kso func, int nargs, kso* args, ks_dict locals, ksos_frame closure) {
     assert(th != NULL);
     int i, j, k;
 
@@ -792,13 +804,13 @@ kso kso_call_ext(kso func, int nargs, kso* args, ks_dict locals, ksos_frame clos
             return NULL;
         } else {
             ksos_frame parframe = (ksos_frame)th->frames->elems[th->frames->len - 1];
-            return kso_call(parframe->func, nargs, args);
+            return _kso_call_ext(th, parframe->func, nargs, args, NULL, NULL);
         }
     }
     
 
     kso res = NULL;
-    if (kso_issub(func->type, kst_func) && func->type->i__call == kst_func->i__call) {
+    if (KS_TYPE_HAS(func->type, KS_TF_FUNC) && func->type->i__call == kst_func->i__call) {
         /* If given a standard function which is not a subtype that overrides the calling feature */
         ksos_frame frame = ksos_frame_new(func);
         ks_list_push(th->frames, (kso)frame);
@@ -831,21 +843,21 @@ kso kso_call_ext(kso func, int nargs, kso* args, ks_dict locals, ksos_frame clos
                     int n_va = nargs - (n_before + n_after);
 
                     for (i = 0; i < n_before; ++i) {
-                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, f->bfunc.pars[i].name->v_hash, args[i]);
+                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, KS_STR_HASH(f->bfunc.pars[i].name), args[i]);
                         assert(b);
                     }
                     ks_list vas = ks_list_new(n_va, args + i);
-                    ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, f->bfunc.pars[i].name->v_hash, (kso)vas);
+                    ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, KS_STR_HASH(f->bfunc.pars[i].name), (kso)vas);
                     i += n_va;
                     KS_DECREF(vas);
 
                     int j;
                     for (j = n_before+1; i < nargs; ++i, ++j) {
-                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[j].name, f->bfunc.pars[j].name->v_hash, args[i]);
+                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[j].name, KS_STR_HASH(f->bfunc.pars[j].name), args[i]);
                         assert(b);
                     }
 
-                    res = _ks_exec((ks_code)f->bfunc.bc, NULL);
+                    res = _ks_exec(th, (ks_code)f->bfunc.bc, NULL);
                 }
             } else {
                 /* Standard calling */
@@ -855,15 +867,16 @@ kso kso_call_ext(kso func, int nargs, kso* args, ks_dict locals, ksos_frame clos
                     KS_THROW(kst_ArgError, "Expected between %i and %i arguments, but got %i", f->bfunc.n_req, f->bfunc.n_pars, nargs);
                 } else {
                     for (i = 0; i < f->bfunc.n_pars; ++i) {
-                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, f->bfunc.pars[i].name->v_hash, i < nargs ? args[i] : f->bfunc.pars[i].defa);
+                        bool b = ks_dict_set_h(frame->locals, (kso)f->bfunc.pars[i].name, KS_STR_HASH(f->bfunc.pars[i].name), i < nargs ? args[i] : f->bfunc.pars[i].defa);
                         assert(b);
                     }
 
-                    res = _ks_exec((ks_code)f->bfunc.bc, NULL);
+                    res = _ks_exec(th, (ks_code)f->bfunc.bc, NULL);
                 }
             }
         }
 
+        if (!res) _ks_unwind(th);
         ks_list_popu(th->frames);
         KS_DECREF(frame);
 
@@ -882,12 +895,13 @@ kso kso_call_ext(kso func, int nargs, kso* args, ks_dict locals, ksos_frame clos
             frame->locals = ks_dict_new(NULL);
         }
         ks_type _in = NULL;
-        if (nargs >= 1 && kso_issub(args[0]->type, kst_type)) _in = (ks_type)args[0];
-        res = _ks_exec((ks_code)func, _in);
+        if (nargs >= 1 && KS_TYPE_HAS(args[0]->type, KS_TF_TYPE)) _in = (ks_type)args[0];
+        res = _ks_exec(th, (ks_code)func, _in);
 
+        if (!res) _ks_unwind(th);
         ks_list_popu(th->frames);
         KS_DECREF(frame);
-    } else if (kso_issub(func->type, kst_partial) && func->type->i__call == kst_partial->i__call) {
+    } else if (KS_TYPE_HAS(func->type, KS_TF_PARTIAL) && func->type->i__call == kst_partial->i__call) {
         /* Fill in arguments to partial function */
         ks_partial f = (ks_partial)func;
 
@@ -907,11 +921,11 @@ kso kso_call_ext(kso func, int nargs, kso* args, ks_dict locals, ksos_frame clos
         assert(i == new_nargs && j == f->n_args && k == nargs);
 
         /* Call the thing being wrapped */
-        res = kso_call(f->of, new_nargs, new_args);
+        res = _kso_call_ext(th, f->of, new_nargs, new_args, NULL, NULL);
 
         ks_free(new_args);
 
-    } else if (kso_issub(func->type, kst_type) && func->type->i__call == kst_type->i__call) {
+    } else if (KS_TYPE_HAS(func->type, KS_TF_TYPE) && func->type->i__call == kst_type->i__call) {
         /* We have a type that has not overriden '__call', so treat it like a constructor */
         /* Don't push a stack frame on for this */
         ks_type tp = (ks_type)func;
@@ -975,10 +989,11 @@ kso kso_call_ext(kso func, int nargs, kso* args, ks_dict locals, ksos_frame clos
         new_args[0] = (kso)func;
         for (i = 0; i < nargs; ++i) new_args[i + 1] = args[i];
 
-        res = kso_call(func->type->i__call, new_nargs, new_args);
+        res = _kso_call_ext(th, func->type->i__call, new_nargs, new_args, NULL, NULL);
 
         ks_free(new_args);
 
+        if (!res) _ks_unwind(th);
         ks_list_popu(th->frames);
         KS_DECREF(frame);
     } else {
@@ -1063,7 +1078,7 @@ kso kso_next(kso ob) {
         int ct = 0;
         do {
             ct++;
-        } while (ct < 4 && (((unsigned char*)it->of->data)[it->pos + ct] & 0x80) != 0);
+        } while (it->pos + ct < it->of->len_b && KS_UCP_IS_CONT(it->of->data[it->pos + ct]));
         assert(ct > 0);
         ks_str res = ks_str_new(ct, it->of->data + it->pos);
         it->pos += ct;
@@ -1075,7 +1090,7 @@ kso kso_next(kso ob) {
             return NULL;
         }
 
-        return KS_NEWREF(it->of->elems[it->pos++]);
+        return ks_list_get(it->of, it->pos++);
     } else if (kso_issub(ob->type, kst_tuple_iter) && ob->type->i__next == kst_tuple_iter->i__next) {
         ks_tuple_iter it = (ks_tuple_iter)ob;
         if (it->pos >= it->of->len) {
@@ -1102,7 +1117,7 @@ kso kso_next(kso ob) {
             KS_OUTOFITER();
             return NULL;
         }
-        while (!it->of->ents[it->pos].key) it->pos++;
+        while (it->pos < it->of->len_ents && !it->of->ents[it->pos].key) it->pos++;
         if (it->pos >= it->of->len_ents) {
             KS_OUTOFITER();
             return NULL;
@@ -1170,8 +1185,29 @@ kso kso_next(kso ob) {
     }
 }
 
+/* Complete the traceback of 'exc' with the frames it hasn't unwound through yet (which are still on 'th') */
+static void I_finish_tb(ksos_thread th, ks_Exception exc) {
+    if (exc->n_pend < 0) return;
+    assert(exc->n_pend <= th->frames->len);
+
+    ks_list frames = exc->frames;
+    ks_ssize_t i, j;
+    for (i = exc->n_pend - 1; i >= 0; --i) {
+        ks_list_pushu(frames, (kso)ksos_frame_copy((ksos_frame)th->frames->elems[i]));
+    }
+
+    /* Frames were added innermost first */
+    for (i = 0, j = frames->len - 1; i < j; ++i, --j) {
+        kso t = frames->elems[i];
+        frames->elems[i] = frames->elems[j];
+        frames->elems[j] = t;
+    }
+
+    exc->n_pend = -1;
+}
+
 void* kso_throw(ks_Exception exc) {
-    if (!kso_issub(exc->type, kst_Exception)) {
+    if (!KS_TYPE_HAS(exc->type, KS_TF_EXCEPTION)) {
         KS_THROW(kst_Exception, "Tried to throw '%T' object. Only subtypes of 'Exception' may be thrown", exc);
         return NULL;
     }
@@ -1179,24 +1215,30 @@ void* kso_throw(ks_Exception exc) {
     ksos_thread th = ksos_thread_get();
     assert(th != NULL);
 
-    /* Set the inner exception to the current exception thrown (which may be NULL) */
+    /* The current exception (which may be NULL) becomes the inner exception, so its traceback
+     *   must be completed before the stack changes
+     */
+    if (th->exc) I_finish_tb(th, th->exc);
     exc->inner = th->exc;
 
     /* Set the thread's exception */
     th->exc = exc;
 
+    /* Frames are copied as they are unwound (see '_ks_unwind()'), or when it is caught */
     ks_list_clear(exc->frames);
-    ks_size_t i;
-    for (i = 0; i < th->frames->len; ++i) {
-        ksos_frame nf = ksos_frame_copy((ksos_frame)th->frames->elems[i]);
-        ks_list_pushu(exc->frames, (kso)nf);
-    }
-
-
+    exc->n_pend = th->frames->len;
 
     return NULL;
 }
 
+void _ks_unwind(ksos_thread th) {
+    ks_Exception exc = th->exc;
+    if (exc && exc->n_pend > 0 && exc->n_pend == th->frames->len) {
+        exc->n_pend--;
+        ks_list_pushu(exc->frames, (kso)ksos_frame_copy((ksos_frame)th->frames->elems[exc->n_pend]));
+    }
+}
+
 void* kso_throw_c(ks_type tp, const char* cfile, const char* cfunc, int cline, const char* fmt, ...) {
     va_list ap;
     va_start(ap, fmt);
@@ -1209,14 +1251,22 @@ ks_Exception kso_catch() {
     ksos_thread th = ksos_thread_get();
 
     ks_Exception res = th->exc;
-    if (th->exc) th->exc = NULL;
+    if (res) {
+        th->exc = NULL;
+        I_finish_tb(th, res);
+    }
 
     return res;
 }
 
 bool kso_catch_ignore() {
-    ks_Exception exc = kso_catch();
+    ksos_thread th = ksos_thread_get();
+
+    ks_Exception exc = th->exc;
     if (exc) {
+        th->exc = NULL;
+        /* Only bother with the traceback if something else can still see it */
+        if (exc->refs > 1) I_finish_tb(th, exc);
         KS_DECREF(exc);
         return true;
     }
@@ -1227,7 +1277,9 @@ bool kso_catch_ignore() {
 bool kso_catch_ignore_print() {
     ks_Exception exc = kso_catch();
     if (exc) {
-        ksio_add((ksio_BaseIO)ksos_stderr, KS_COL_RED KS_COL_BOLD "%T" KS_COL_RESET ": %S\n", exc, exc->what);
+        ks_str what = ks_Exception_what(exc);
+        ksio_add((ksio_BaseIO)ksos_stderr, KS_COL_RED KS_COL_BOLD "%T" KS_COL_RESET ": %S\n", exc, what);
+        KS_DECREF(what);
         ks_list frames = exc->frames;
         assert(frames != NULL);
 
@@ -1269,8 +1321,12 @@ void kso_exit_if_err() {
 /** Internal methods **/
 
 kso _kso_new(ks_type tp) {
+    return _kso_newx(tp, 0);
+}
+
+kso _kso_newx(ks_type tp, ks_size_t extra) {
     assert(tp->ob_sz > 0);
-    kso res = ks_zmalloc(1, tp->ob_sz);
+    kso res = ks_zmalloc(1, tp->ob_sz + extra);
     memset(res, 0, tp->ob_sz);
 
     KS_INCREF(tp);
@@ -1279,11 +1335,9 @@ kso _kso_new(ks_type tp) {
 
     tp->num_obs_new++;
 
-    if (tp->ob_attr > 0) {
-        /* Initialize attribute dictionary */
-        ks_dict* attr = (ks_dict*)(((ks_uint)res + tp->ob_attr));
-        *attr = ks_dict_new(NULL);
-    }
+    /* NOTE: The attribute dictionary (if the type has one) is left NULL, and is created when it is first
+     *         needed (see 'kso_getattr_dict()'), since most objects never have any attributes set
+     */
 
     return res;
 }
@@ -1295,10 +1349,16 @@ void _kso_del(kso ob) {
     }
 
     if (ob->type->ob_attr > 0) {
-        /* Initialize attribute dictionary */
+        /* Free attribute dictionary, if it was created */
         ks_dict* attr = (ks_dict*)(((ks_uint)ob + ob->type->ob_attr));
     
-        KS_DECREF(*attr);
+        KS_NDECREF(*attr);
+    }
+
+    /* Free fixed attributes */
+    ks_cint i;
+    for (i = 0; i < ob->type->n_slots; ++i) {
+        KS_NDECREF(*(kso*)((ks_uint)ob + ob->type->slots[i].off));
     }
 
     ob->type->num_obs_del++;
@@ -74,6 +74,10 @@ ks_str ks_tok_str(ks_str src, ks_tok tok) {
     return ks_str_new(tok.epos - tok.spos, src->data + tok.spos);
 }
 
+ks_str ks_tok_name(ks_str src, ks_tok tok) {
+    return ks_str_intern_c(tok.epos - tok.spos, src->data + tok.spos);
+}
+
 void ks_tok_add(ksio_BaseIO self, ks_str fname, ks_str src, ks_tok tok, bool inc_at) {
 
     /* Subidivide line */
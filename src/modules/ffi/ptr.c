@@ -69,6 +69,26 @@ static KS_TFUNC(T, setelem) {
     return KSO_NONE;
 }
 
+static KS_TFUNC(T, memoryview) {
+    ksffi_ptr self;
+    ks_cint num = 1;
+    KS_ARGS("self:* ?num:cint", &self, ksffit_ptr, &num);
+
+    /* 'void*' is viewed as bytes */
+    int sz = 1;
+    if (self->type->i__template->elems[0] != KSO_NONE) {
+        sz = ksffi_sizeofp(self->type);
+        if (sz < 0) return NULL;
+    }
+    if (num < 0) {
+        KS_THROW(kst_SizeError, "Negative size %l", num);
+        return NULL;
+    }
+
+    /* NOTE: The memory is not owned, so the caller must keep it alive */
+    return (kso)ks_memoryview_new((kso)self, self->val, sz * num, false);
+}
+
 static KS_TFUNC(T, add) {
     kso L, R;
     KS_ARGS("L R", &L, &R);
@@ -126,6 +146,7 @@ void _ksi_ffi_ptr() {
         {"__add",                  ksf_wrap(T_add_, T_NAME ".__add(L, R)", "")},
         {"__getelem",              ksf_wrap(T_getelem_, T_NAME ".__getelem(self, idx)", "")},
         {"__setelem",              ksf_wrap(T_setelem_, T_NAME ".__setelem(self, idx, val)", "")},
+        {"__memoryview",           ksf_wrap(T_memoryview_, T_NAME ".__memoryview(self, num=1)", "")},
 
         {"__sizeof",               (kso)ks_int_newu(sizeof(void*))},
         {"of",                     KS_NEWREF(kst_none)},
@@ -90,6 +90,7 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
     /* List of arguments that were not consumed by flags and args, and thus must be positional arguments */
     ks_list pos = ks_list_new(0, NULL);
 
+    ks_list_box(args);
     if (args->len < 1) {
         KS_THROW(kst_Error, "List of arguments being parsed should have at least one element (the name of the program)");
         KS_DECREF(pos);
@@ -188,7 +189,7 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
                             s = (ks_str)ns;
                         }
                         bool has;
-                        if (!ks_dict_has_h(res, (kso)a.name, a.name->v_hash, &has)) {
+                        if (!ks_dict_has_h(res, (kso)a.name, KS_STR_HASH(a.name), &has)) {
                             assert(false);
                         }
                         if (has && (a.trans == KSO_NONE || kso_issub(a.trans->type, kst_type))) {
@@ -200,7 +201,7 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
                             return NULL;
                         }
 
-                        ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)s);
+                        ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)s);
                         KS_DECREF(s);
                     }
                 }
@@ -232,7 +233,7 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
     for (j = 0; j < self->n_flag; ++j) {
         struct ksga_flag a = self->flag[j];
         ks_int v = ks_int_new(flag_ct[j]);
-        ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)v);
+        ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)v);
         KS_DECREF(v);
     }
 
@@ -243,13 +244,13 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
         struct ksga_opt a = self->opt[j];
 
         bool has;
-        if (!ks_dict_has_h(res, (kso)a.name, a.name->v_hash, &has)) {
+        if (!ks_dict_has_h(res, (kso)a.name, KS_STR_HASH(a.name), &has)) {
             assert(false);
         }
 
         if (!has) {
             if (a.defa) {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, a.defa);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), a.defa);
             } else {
                 KS_THROW(kst_Error, "Required option %R (%R) was not given", a.name, a.opts);
                 KS_DECREF(res);
@@ -313,9 +314,9 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
             }
 
             if (a.num == 1) {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, tmp->elems[0]);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), tmp->elems[0]);
             } else {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)tmp);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)tmp);
             }
 
             KS_DECREF(tmp);
@@ -362,9 +363,9 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
             }
 
             if (a.num == 1) {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, tmp->elems[0]);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), tmp->elems[0]);
             } else {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)tmp);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)tmp);
             }
             KS_DECREF(tmp);
         }
@@ -392,7 +393,7 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
                 }
             }
 
-            ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)tmp);
+            ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)tmp);
             KS_DECREF(tmp);
         }
 
@@ -420,9 +421,9 @@ ks_dict ksga_parse(ksga_Parser self, ks_list args) {
             }
 
             if (a.num == 1) {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, tmp->elems[0]);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), tmp->elems[0]);
             } else {
-                ks_dict_set_h(res, (kso)a.name, a.name->v_hash, (kso)tmp);
+                ks_dict_set_h(res, (kso)a.name, KS_STR_HASH(a.name), (kso)tmp);
             }
             KS_DECREF(tmp);
         }
@@ -469,7 +470,7 @@ ks_str ksga_help(ksga_Parser self) {
         col = ind0;
 
         ksio_add(aio, "%S", a.name);
-        col += a.name->len_c;
+        col += KS_STR_LENC(a.name);
 
         if (ind1 > col) ksio_add(aio, "%.*c", ind1 - col, ' ');
 
@@ -489,7 +490,7 @@ ks_str ksga_help(ksga_Parser self) {
             ks_str o = (ks_str)a.opts->elems[k];
             assert(kso_issub(o->type, kst_str));
             ksio_add(aio, "%S", o);
-            col += o->len_c;
+            col += KS_STR_LENC(o);
         }
         if (ind1 > col) ksio_add(aio, "%.*c", ind1 - col, ' ');
 
@@ -507,11 +508,11 @@ ks_str ksga_help(ksga_Parser self) {
             ks_str o = (ks_str)a.opts->elems[k];
             assert(kso_issub(o->type, kst_str));
             ksio_add(aio, "%S", o);
-            col += o->len_c;
+            col += KS_STR_LENC(o);
         }
         if (kso_issub(a.trans->type, kst_type)) {
             ksio_add(aio, "[=%S]", ((ks_type)a.trans)->i__name);
-            col += 3 + ((ks_type)a.trans)->i__name->len_c;
+            col += 3 + KS_STR_LENC(((ks_type)a.trans)->i__name);
         } else {
             ksio_add(aio, "[=str]");
             col += 6;
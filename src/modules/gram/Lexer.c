@@ -28,10 +28,8 @@ ksgram_Lexer ksgram_Lexer_new(kso src) {
 
     self->line = self->pos_b = self->pos_c = self->col = 0;
 
-    self->_sim.n_states = 0;
-    self->_sim.states = NULL;
-    self->_sim.cur = self->_sim.next = NULL;
-    self->_max_sim_len = 0;
+    self->_max_n_queue = 0;
+    self->_all = NULL;
 
     return self;
 }
@@ -40,103 +38,75 @@ bool ksgram_Lexer_addrule(ksgram_Lexer self, ks_regex regex, kso action) {
     ks_tuple rule = ks_tuple_new(2, (kso[]){ (kso)regex, (kso)action });
     ks_list_push(self->rules, (kso)rule);
     KS_DECREF(rule);
+
+    /* Combine the rules again the next time a token is read */
+    if (self->_all) {
+        KS_DECREF(self->_all);
+        self->_all = NULL;
+    }
+    return true;
 }
 
 
 
+/* Number of characters read at a time from in-memory sources (other sources are read one character at a time, so
+ *   interactive input isn't waited on)
+ */
+#define I_CHUNK 4096
+
+/* Read more input into the queue, returning the number of bytes read (0 at the end of input), or -1 on an error */
+static int I_read(ksgram_Lexer self) {
+    ks_ssize_t sz_c = kso_issub(self->src->type, ksiot_StringIO) || kso_issub(self->src->type, ksiot_BytesIO) ? I_CHUNK : 1;
+    if (self->n_queue + 4 * sz_c > self->_max_n_queue) {
+        self->_max_n_queue = ks_nextsize(self->_max_n_queue, self->n_queue + 4 * sz_c);
+        self->queue = ks_realloc(self->queue, self->_max_n_queue);
+    }
+
+    ks_ssize_t num_c = 0;
+    ks_ssize_t rsz = ksio_reads((ksio_BaseIO)self->src, sz_c, self->queue + self->n_queue, &num_c);
+    if (rsz < 0) return -1;
+
+    self->n_queue += rsz;
+    return rsz;
+}
+
 /* Generate one token and return the object
  * If the lexer is out of input, it will return NULL and set '*is_out',
  *   but will NOT throw an OutOfIterError
+ *
+ * All of the rules are combined into one regex, so each token takes a single pass over its bytes, regardless of how
+ *   many rules there are. The longest match wins, and the rule given first wins ties
  */
 static kso I_token(ksgram_Lexer self, bool* is_out) {
-    while (true) {
-        /* Maximum match so far (rule index, byte length) */
-        int maxi = -1, maxl = 0;
-        *is_out = false;
-
-        int i, j;
+    int i;
+    if (!self->_all) {
+        ks_regex* regs = ks_zmalloc(sizeof(*regs), self->rules->len);
         for (i = 0; i < self->rules->len; ++i) {
-            /* Get the rule we are simulating */
-            ks_regex rule = (ks_regex)((ks_tuple)self->rules->elems[i])->elems[0];
-
-            /* Empty the simulator */
-            if (rule->n_states > self->_max_sim_len) {
-                self->_max_sim_len = rule->n_states;
-                self->_sim.cur = ks_zrealloc(self->_sim.cur, sizeof(*self->_sim.cur), self->_max_sim_len);
-                self->_sim.next = ks_zrealloc(self->_sim.next, sizeof(*self->_sim.next), self->_max_sim_len);
-            }
-
-            self->_sim.n_states = rule->n_states;
-            self->_sim.states = rule->states;
-
-            for (j = 0; j < self->_sim.n_states; ++j) self->_sim.cur[j] = self->_sim.next[j] = false;
-
-            self->_sim.cur[rule->s0] = true;
-
-            /* Position from the start of self->queue */
-            int pos = 0;
-
-            bool src_out = false;
-            while (!src_out) {
-                char utf8[5];
-                ks_ucp c = 0;
-                if (pos >= self->n_queue) {
-                    assert (pos == self->n_queue);
-                    /* Out of the queue, so we need to read another character */
-                    ks_ssize_t numc = 0;
-                    ks_ssize_t rsz = ksio_reads(self->src, 1, utf8, &numc);
-                    if (rsz < 1 || numc < 1) {
-                        kso_catch_ignore();
-                        src_out = true;
-                        break;
-                    }
-                    int _n;
-                    KS_UCP_FROM_UTF8(c, utf8, _n);
-
-                    /* Reallocate queue buffer, if needed */
-                    self->n_queue += 1;
-                    if (self->n_queue > self->_max_n_queue) {
-                        self->_max_n_queue = ks_nextsize(self->_max_n_queue, self->n_queue);
-                        self->queue = ks_realloc(self->queue, self->_max_n_queue);
-                    }
-
-                    /* Append to queue */
-                    self->queue[pos] = c;
-                    pos++;
-
-                } else {
-                    /* Read from existing queue */
-                    c = self->queue[pos];
-                    pos++;
-                }
-
-
-                /* Update state variables */
-                /* TODO: add an 'onchar()' method to allow custom handling of newlines */
-                if (c == '\n') {
-                    self->line++;
-                    self->col = 0;
-                } else {
-                    self->col++;
-                }
-
+            ks_tuple rule = (ks_tuple)ks_list_get(self->rules, i);
+            regs[i] = (ks_regex)rule->elems[0];
+            KS_DECREF(rule);
+        }
+        self->_all = ks_regex_newset(self->rules->len, regs);
+        ks_free(regs);
+    }
 
-                /* Now, simulate the NFA */
-                if (ks_regex_sim0_step(&self->_sim, c) == 0) break;
+    while (true) {
+        *is_out = false;
 
-                /* Now, check if we have exceeded the maximum length */
-                if (pos > maxl) {
-                    /* If so, see if we are in a matching state  */
-                    if (self->_sim.cur[rule->sf]) {
-                        maxi = i;
-                        maxl = pos;
-                    }
-                }
-            }
+        /* Find the longest match, reading more input as long as it may be longer */
+        ks_regex_lm lm;
+        ks_regex_lm_init(self->_all, &lm);
+        bool more = ks_regex_lm_feed(self->_all, &lm, self->n_queue, self->queue);
+        while (more) {
+            ks_ssize_t pos = self->n_queue;
+            int rsz = I_read(self);
+            if (rsz < 0) return NULL;
+            if (rsz == 0) break;
+            more = ks_regex_lm_feed(self->_all, &lm, self->n_queue - pos, self->queue + pos);
         }
 
-        /* Done with all the rules */
-        if (maxi < 0) {
+        int maxi = lm.tag, maxl = lm.stop;
+        if (maxl == 0) {
             /* No match was found */
             if (self->n_queue == 0) {
                 /* Just out of input, but no error */
@@ -152,15 +122,31 @@ static kso I_token(ksgram_Lexer self, bool* is_out) {
             /* Construct a string from the match */
             ks_str val = ks_str_new(maxl, self->queue);
 
+            /* Update the position */
+            int sline = self->line, scol = self->col, pos_b = self->pos_b, pos_c = self->pos_c;
+            for (i = 0; i < maxl; ++i) {
+                unsigned char c = self->queue[i];
+                if (c == '\n') {
+                    self->line++;
+                    self->col = 0;
+                    self->pos_c++;
+                } else if ((c & 0xC0) != 0x80) {
+                    /* Not a continuation byte, so a new character */
+                    self->col++;
+                    self->pos_c++;
+                }
+            }
+            self->pos_b += maxl;
+
             /* Shift the queue over and consume the tokens */
             self->n_queue -= maxl;
-            for (i = 0; i < self->n_queue; ++i) {
-                self->queue[i] = self->queue[i + maxl];
-            }
+            memmove(self->queue, self->queue + maxl, self->n_queue);
 
             /* Determine the action for the rule that matched */
-            kso action = ((ks_tuple)self->rules->elems[maxi])->elems[1];
-
+            ks_tuple rule = (ks_tuple)ks_list_get(self->rules, maxi);
+            kso action = rule->elems[1];
+            KS_INCREF(action);
+            KS_DECREF(rule);
 
             if (action == KSO_NONE) {
                 /* Skip the token */
@@ -169,6 +155,7 @@ static kso I_token(ksgram_Lexer self, bool* is_out) {
 
                 kso res = kso_call(action, 1, (kso[]){ (kso)val });
                 if (!res) {
+                    KS_DECREF(action);
                     KS_DECREF(val);
                     return NULL;
                 }
@@ -176,12 +163,14 @@ static kso I_token(ksgram_Lexer self, bool* is_out) {
                 if (res == KSO_NONE) {
                     KS_DECREF(res);
                 } else {
+                    KS_DECREF(action);
                     KS_DECREF(val);
                     return res;
                 }
             } else {
                 /* Assume the action is a token type to return */
-                ksgram_Token res = ksgram_Token_new(ksgramt_Token, action, val, 0, 0, 0, 0, 0, 0, 0, 0);
+                ksgram_Token res = ksgram_Token_new(ksgramt_Token, action, val, sline, scol, self->line, self->col, pos_b, pos_c, maxl, self->pos_c - pos_c);
+                KS_DECREF(action);
                 KS_DECREF(val);
                 return (kso)res;
 
@@ -193,6 +182,7 @@ static kso I_token(ksgram_Lexer self, bool* is_out) {
             }
 
             /* If it has gotten here, we need to just repeat because we've skipped the token */
+            KS_DECREF(action);
             KS_DECREF(val);
         }
     }
@@ -265,6 +255,8 @@ static KS_TFUNC(T, free) {
     KS_ARGS("self:*", &self, ksgramt_Lexer);
 
     KS_DECREF(self->rules);
+    KS_DECREF(self->src);
+    if (self->_all) KS_DECREF(self->_all);
     ks_free(self->queue);
 
     KSO_DEL(self);
@@ -351,7 +351,8 @@ ks_ssize_t ksio_readb(ksio_BaseIO self, ks_ssize_t sz_b, void* data) {
         /* Update state variables */
         fio->sz_r += real_sz;
 
-        if (real_sz == 0 && sz_b != 0) {
+        /* Reading nothing at the end of the file is not an error */
+        if (real_sz == 0 && sz_b != 0 && ferror(fio->fp)) {
             KS_THROW_ERRNO(eno, "Failed to read from %R", self);
             return -1;
         }
@@ -577,13 +578,13 @@ bool ksio_writeb(ksio_BaseIO self, ks_ssize_t sz_b, const void* data) {
         KS_GIL_LOCK();
         if (real_sz < 0) {
             KS_THROW_ERRNO(eno, "Failed to write to %R", self);
-            return -1;
+            return false;
         }
 
         /* Update state variables */
         rio->sz_r += real_sz;
 
-        return real_sz;
+        return true;
     } else if (kso_issub(self->type, ksiot_BytesIO) || kso_issub(self->type, ksiot_StringIO)) {
         ksio_StringIO sio = (ksio_StringIO)self;
 
@@ -652,13 +653,13 @@ bool ksio_writes(ksio_BaseIO self, ks_ssize_t sz_b, const void* data) {
         KS_GIL_LOCK();
         if (real_sz < 0) {
             KS_THROW_ERRNO(eno, "Failed to write to %R", self);
-            return -1;
+            return false;
         }
 
         /* Update state variables */
         rio->sz_r += real_sz;
 
-        return real_sz;
+        return true;
     } else if (kso_issub(self->type, ksiot_BytesIO) || kso_issub(self->type, ksiot_StringIO)) {
         ksio_StringIO sio = (ksio_StringIO)self;
 
@@ -743,6 +744,22 @@ static KS_TFUNC(T, read) {
     return NULL;
 }
 
+static KS_TFUNC(T, readinto) {
+    ksio_BaseIO self;
+    kso buf;
+    KS_ARGS("self:* buf", &self, ksiot_BaseIO, &buf);
+
+    unsigned char* data;
+    ks_ssize_t len_b;
+    if (!kso_get_buf(buf, true, &data, &len_b)) return NULL;
+
+    /* Read directly into the buffer */
+    ks_ssize_t rsz = len_b == 0 ? 0 : ksio_readb(self, len_b, data);
+    if (rsz < 0) return NULL;
+
+    return (kso)ks_int_new(rsz);
+}
+
 static KS_TFUNC(T, write) {
     ksio_BaseIO self;
     kso msg;
@@ -941,6 +958,7 @@ void _ksi_io_BaseIO() {
         {"eof",                    ksf_wrap(T_eof_, T_NAME ".eof(self)", "Calculate whether the stream has hit the EOF indicator")},
 
         {"read",                   ksf_wrap(T_read_, T_NAME ".read(self, sz=-1)", "Reads a message from the stream")},
+        {"readinto",               ksf_wrap(T_readinto_, T_NAME ".readinto(self, buf)", "Reads bytes from the stream directly into a writable buffer ('bytearray' or 'memoryview'), and returns the number of bytes read")},
         {"write",                  ksf_wrap(T_write_, T_NAME ".write(self, msg)", "Writes a messate to the stream")},
 
 
@@ -178,9 +178,17 @@ static KS_TFUNC(T, write) {
     KS_ARGS("self:* msg", &self, ksiot_FileIO, &msg);
     if (self->mb) {
         /* Write bytes */
+        if (kso_is_buf(msg)) {
+            /* Write without copying */
+            unsigned char* data;
+            ks_ssize_t len_b;
+            if (!kso_get_buf(msg, false, &data, &len_b)) return NULL;
+            if (!ksio_writeb((ksio_BaseIO)self, len_b, data)) return NULL;
+            return KSO_NONE;
+        }
         ks_bytes vm = kso_bytes(msg);
         if (!vm) return NULL;
-        if (ksio_writeb((ksio_BaseIO)self, vm->len_b, vm->data) < 0) {
+        if (!ksio_writeb((ksio_BaseIO)self, vm->len_b, vm->data)) {
             KS_DECREF(vm);
             return NULL;
         }
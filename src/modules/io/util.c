@@ -150,16 +150,15 @@ static bool add_uint(ksio_BaseIO self, ks_uint val, int base, struct sbfield sbf
 /* Add floating point value */
 static bool add_float(ksio_BaseIO self, ks_cfloat val, int base, struct sbfield sbf) {
     char tmp[256];
-    int i = 0;
-    if (sbf.p < 0) sbf.p = 11;
-    int req_sz = ks_cfloat_to_str(tmp, sizeof(tmp)-2, val, false, sbf.p, base);
-
-    /* TODO: reallocate */
-    assert (req_sz < 256);
-
-    ksio_addbuf(self, req_sz, tmp);
-
-    return true;
+    int req_sz = ks_cfloat_to_str(tmp, sizeof(tmp), val, false, sbf.p, base);
+    if (req_sz <= sizeof(tmp)) return ksio_addbuf(self, req_sz, tmp);
+
+    /* Very large numbers need more room */
+    char* atmp = ks_malloc(req_sz);
+    ks_cfloat_to_str(atmp, req_sz, val, false, sbf.p, base);
+    bool res = ksio_addbuf(self, req_sz, atmp);
+    ks_free(atmp);
+    return res;
 }
 
 /* Add generic object */
@@ -210,7 +209,10 @@ static bool add_O_list(ksio_BaseIO self, ks_list val) {
         ks_size_t i;
         for (i = 0; i < val->len; ++i) {
             if (i > 0) ksio_addbuf(self, 2, ", ");
-            if (!add_repr(self, val->elems[i])) return false;
+            kso ob = ks_list_get(val, i);
+            bool ok = add_repr(self, ob);
+            KS_DECREF(ob);
+            if (!ok) return false;
         }
         kso_outrepr();
     }
@@ -19,9 +19,12 @@ static KS_TFUNC(T, init) {
     ks_str target;
     KS_ARGS("self:* target:*", &self, kpm_cextt_project, &target, kst_str);
 
+    /* Make sure the attribute dictionary exists, since it is used directly */
+    kso_getattr_dict((kso)self);
+
     /* Add defaults */
     #define DEFA(_key, _val) do { \
-        ks_str k = ks_str_new(-1, _key), v = ks_str_new(-1, _val); \
+        ks_str k = ks_str_intern_c(-1, _key), v = ks_str_new(-1, _val); \
         ks_str rr = (ks_str)ksos_getenv(k, (kso)v); \
         KS_DECREF(v); \
         if (!rr) { \
@@ -243,6 +246,7 @@ static KS_TFUNC(T, rule_C) {
         KS_DECREF(DEFS);
         return false;
     }
+    ks_list_box(DEFS);
 
     int i;
     for (i = 0; i < DEFS->len; ++i) {
@@ -270,6 +274,7 @@ static KS_TFUNC(T, link_C) {
     ks_list objs;
     bool isdyn = true;
     KS_ARGS("self:* out:* objs:* ?isdyn:bool", &self, kpm_cextt_project, &out, kst_str, &objs, kst_list, &isdyn);
+    ks_list_box(objs);
 
     ksio_StringIO sio = ksio_StringIO_new();
     kso CC = ks_dict_get_c(self->attr, "CC");
@@ -26,6 +26,59 @@
 #define KSF(_x) _x
 
 
+/* -- TABLES -- */
+
+/* Lanczos approximation for Gamma (shared with the 'nx.gamma' kernels) */
+const ks_cfloat ksm_gamma_g = 4.7421875;
+const ks_cfloat ksm_gamma_a[KSM_GAMMA_N] = {
+    KSF(    0.99999999999999709182046422698042381484509186),
+    KSF(   57.15623566586292351657939348597744427325444289),
+    KSF(  -59.59796035547549124814226613160283600191010086),
+    KSF(   14.13609797474174717386341954087672601565916414),
+    KSF(   -0.49191381609762019978284002853030784416348279),
+    KSF(    0.00003399464998481188869891934155234155285737),
+    KSF(    0.00004652362892704857566523022496582288935897),
+    KSF(   -0.00009837447530487956467653837063470730301913),
+    KSF(    0.00015808870322491248883607241344366395885874),
+    KSF(   -0.00021026444172410488319269928300571190544166),
+    KSF(    0.00021743961811521264319614464960383469237637),
+    KSF(   -0.00016431810653676389021706956228018413242085),
+    KSF(    0.00008441822398385274329281181534545498133891),
+    KSF(   -0.00002619083840158140866966503624795490184143),
+    KSF(    0.00000368991826595316227036759674456787362014),
+};
+
+/* Coefficients for Zeta, with sign baked in (shared with the 'nx.zeta' kernels)
+ * TODO: don't bake it in and process two at a time, then subtract?
+ */
+const ks_cfloat ksm_zeta_d[KSM_ZETA_N] = {
+    KSF(    0.99999999999999999915316831449165727118563471),
+    KSF(   -0.99999999999999902360306660888083367703682290),
+    KSF(    0.99999999999981204316690636680631146518122476),
+    KSF(   -0.99999999998555166856908523792275077432760672),
+    KSF(    0.99999999940800649735732951813854279475607626),
+    KSF(   -0.99999998503354890275363160350936641430909587),
+    KSF(    0.99999974502366603527976642288281533472466576),
+    KSF(   -0.99999689655472650921631153193034098361274796),
+    KSF(    0.99997187750254100529229940639777459967973657),
+    KSF(   -0.99980442972843671759172152048046755950062770),
+    KSF(    0.99893193869494595536239464122713087646211307),
+    KSF(   -0.99533621807207493526577477521337969787914367),
+    KSF(    0.98348076239521758639648463726948994240630979),
+    KSF(   -0.95196348945735681894089485516634917708776065),
+    KSF(    0.88409295990333918743600045666910953960284266),
+    KSF(   -0.76551456344114746342744932366243798905448018),
+    KSF(    0.59768788135151320888308864751186656065740265),
+    KSF(   -0.40622785187314257981287325939000254252169923),
+    KSF(    0.23178649168173822888223257243452643710916944),
+    KSF(   -0.10672469148761619066168789786047244403958905),
+    KSF(    0.03778036573957455420677224392862216580892294),
+    KSF(   -0.00959406764049133001149894522477629131740788),
+    KSF(    0.00154935253821599118198119612325579859784227),
+    KSF(   -0.00011918096447815316784470739409659989214171),
+};
+
+
 /* -- GAMMA -- */
 
 /* NOTE: correct to 14.188319365090821 digits */
@@ -42,36 +95,15 @@ ks_cfloat ksm_gamma(ks_cfloat x) {
     } else {
         x -= 1.0;
 
-        /* Generated Table */
-        static const ks_cfloat g = 4.7421875;
-        static const int a_n = 15;
-        static const ks_cfloat a[] = {
-            KSF(    0.99999999999999709182046422698042381484509186),
-            KSF(   57.15623566586292351657939348597744427325444289),
-            KSF(  -59.59796035547549124814226613160283600191010086),
-            KSF(   14.13609797474174717386341954087672601565916414),
-            KSF(   -0.49191381609762019978284002853030784416348279),
-            KSF(    0.00003399464998481188869891934155234155285737),
-            KSF(    0.00004652362892704857566523022496582288935897),
-            KSF(   -0.00009837447530487956467653837063470730301913),
-            KSF(    0.00015808870322491248883607241344366395885874),
-            KSF(   -0.00021026444172410488319269928300571190544166),
-            KSF(    0.00021743961811521264319614464960383469237637),
-            KSF(   -0.00016431810653676389021706956228018413242085),
-            KSF(    0.00008441822398385274329281181534545498133891),
-            KSF(   -0.00002619083840158140866966503624795490184143),
-            KSF(    0.00000368991826595316227036759674456787362014),
-        };
-
         /* Sum over table */
-        ks_cfloat sum = a[0];
+        ks_cfloat sum = ksm_gamma_a[0];
         int i;
-        for (i = 1; i < a_n; ++i) {
-            sum += a[i] / (x + i);
+        for (i = 1; i < KSM_GAMMA_N; ++i) {
+            sum += ksm_gamma_a[i] / (x + i);
         }
 
         /* Recombine */
-        ks_cfloat tmp = x + g + 0.5;
+        ks_cfloat tmp = x + ksm_gamma_g + 0.5;
         return KSM_SQRT_2PI * pow(tmp, x + 0.5) * exp(-tmp) * sum;
     }
 }
@@ -88,42 +120,21 @@ ks_ccomplex ksm_cgamma(ks_ccomplex x) {
     } else {
         ks_cfloat xrs = x.re - 1.0;
 
-        /* Generated Table */
-        static const ks_cfloat g = 4.7421875;
-        static const int a_n = 15;
-        static const ks_cfloat a[] = {
-            KSF(    0.99999999999999709182046422698042381484509186),
-            KSF(   57.15623566586292351657939348597744427325444289),
-            KSF(  -59.59796035547549124814226613160283600191010086),
-            KSF(   14.13609797474174717386341954087672601565916414),
-            KSF(   -0.49191381609762019978284002853030784416348279),
-            KSF(    0.00003399464998481188869891934155234155285737),
-            KSF(    0.00004652362892704857566523022496582288935897),
-            KSF(   -0.00009837447530487956467653837063470730301913),
-            KSF(    0.00015808870322491248883607241344366395885874),
-            KSF(   -0.00021026444172410488319269928300571190544166),
-            KSF(    0.00021743961811521264319614464960383469237637),
-            KSF(   -0.00016431810653676389021706956228018413242085),
-            KSF(    0.00008441822398385274329281181534545498133891),
-            KSF(   -0.00002619083840158140866966503624795490184143),
-            KSF(    0.00000368991826595316227036759674456787362014),
-        };
-
         /* Sum over table */
         ks_ccomplex tmp0, tmp1;
-        ks_cfloat sumr = a[0], sumi = 0.0;
-        long double sum_re = a[0], sum_im = 0.0;
+        ks_cfloat sumr = ksm_gamma_a[0], sumi = 0.0;
+        long double sum_re = ksm_gamma_a[0], sum_im = 0.0;
         int i;
-        for (i = 1; i < a_n; ++i) {
-            /* sum += a[i] / (x + i) */
+        for (i = 1; i < KSM_GAMMA_N; ++i) {
+            /* sum += ksm_gamma_a[i] / (x + i) */
             tmp0 = KS_CC_MAKE(xrs + i, x.im);
-            tmp1 = ksm_cdiv(KS_CC_MAKE(a[i], 0), tmp0);
+            tmp1 = ksm_cdiv(KS_CC_MAKE(ksm_gamma_a[i], 0), tmp0);
             sumr += tmp1.re;
             sumi += tmp1.im;
         }
 
         /* Recombine */
-        ks_ccomplex t0 = KS_CC_MAKE(xrs + g + 0.5, x.im), t1 = KS_CC_MAKE(xrs + 0.5, x.im);
+        ks_ccomplex t0 = KS_CC_MAKE(xrs + ksm_gamma_g + 0.5, x.im), t1 = KS_CC_MAKE(xrs + 0.5, x.im);
         ks_ccomplex t2 = ksm_cpow(t0, t1), t3 = ksm_cexp(KS_CC_NEG(t0));
 
         t0 = ksm_cmul(ksm_cmul(KS_CC_MAKE(sumr, sumi), t2), t3);
@@ -150,40 +161,10 @@ ks_cfloat ksm_zeta(ks_cfloat x) {
     } else {
         /* x >= 0, summation will converge */
 
-        /* Computed table (with sign baked in) 
-         * TODO: don't bake it in and process two at a time, then subtract?
-         */
-        static const int n = 24;
-        static const ks_cfloat d[] = {
-            KSF(    0.99999999999999999915316831449165727118563471),
-            KSF(   -0.99999999999999902360306660888083367703682290),
-            KSF(    0.99999999999981204316690636680631146518122476),
-            KSF(   -0.99999999998555166856908523792275077432760672),
-            KSF(    0.99999999940800649735732951813854279475607626),
-            KSF(   -0.99999998503354890275363160350936641430909587),
-            KSF(    0.99999974502366603527976642288281533472466576),
-            KSF(   -0.99999689655472650921631153193034098361274796),
-            KSF(    0.99997187750254100529229940639777459967973657),
-            KSF(   -0.99980442972843671759172152048046755950062770),
-            KSF(    0.99893193869494595536239464122713087646211307),
-            KSF(   -0.99533621807207493526577477521337969787914367),
-            KSF(    0.98348076239521758639648463726948994240630979),
-            KSF(   -0.95196348945735681894089485516634917708776065),
-            KSF(    0.88409295990333918743600045666910953960284266),
-            KSF(   -0.76551456344114746342744932366243798905448018),
-            KSF(    0.59768788135151320888308864751186656065740265),
-            KSF(   -0.40622785187314257981287325939000254252169923),
-            KSF(    0.23178649168173822888223257243452643710916944),
-            KSF(   -0.10672469148761619066168789786047244403958905),
-            KSF(    0.03778036573957455420677224392862216580892294),
-            KSF(   -0.00959406764049133001149894522477629131740788),
-            KSF(    0.00154935253821599118198119612325579859784227),
-            KSF(   -0.00011918096447815316784470739409659989214171),
-        };
         ks_cfloat sum = 0.0;
         int i;
-        for (i = 0; i < n; ++i) {
-            sum += d[i] * pow(i + 1, -x);
+        for (i = 0; i < KSM_ZETA_N; ++i) {
+            sum += ksm_zeta_d[i] * pow(i + 1, -x);
         }
 
         // divide by the normalization factor in Proposition 1 (without d0, since everything has been normalized by that)
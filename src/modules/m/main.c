@@ -8,6 +8,7 @@
  */
 #include <ks/impl.h>
 #include <ks/m.h>
+#include <ks/nx.h>
 
 #define M_NAME "m"
 
@@ -321,6 +322,254 @@ static KS_TFUNC(m, sgn) {
     return (kso)ks_int_new(0);
 }
 
+/* Number Theory */
+
+/* Number of odd numbers in each segment of 'I_sieve()' */
+#define SIEVE_SEG 32768
+
+/* Minimum 'k' (after reflecting to 'k <= n/2') for which 'choose' factors the result into primes */
+#define CHOOSE_FACTOR_K 64
+
+/* Primes below 64, which are trial divided before Miller-Rabin */
+static const int I_smallp[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61 };
+
+/* Growable list of primes */
+struct I_plist {
+    ks_size_t n, max;
+    ks_uint64_t* p;
+};
+
+/* Callback for each prime found by 'I_sieve()', which stops the sieve if it returns false */
+typedef bool (*I_sieve_fn)(ks_uint64_t p, void* arg);
+
+/* Calls 'fn(p, arg)' for every prime 'p < n', in increasing order
+ *
+ * This is a segmented sieve of Eratosthenes over the odd numbers, so only the primes up to 'sqrt(n)' and
+ *   a single segment are kept in memory
+ */
+static bool I_sieve(ks_uint64_t n, I_sieve_fn fn, void* arg) {
+    if (n <= 2) return true;
+    if (!fn(2, arg)) return false;
+
+    /* Sieve for odd primes up to 'sqrt(n)' ('comp[i]' is for '2*i+1') */
+    ks_uint64_t r = (ks_uint64_t)sqrt((double)n);
+    while (r * r > n) r--;
+    while ((r + 1) * (r + 1) <= n) r++;
+
+    ks_size_t nc = r / 2 + 1, nb = 0, i, j;
+    unsigned char* comp = ks_malloc(nc);
+    memset(comp, 0, nc);
+    for (i = 1; i < nc; ++i) {
+        if (!comp[i]) {
+            nb++;
+            for (j = 2 * i * (i + 1); j < nc; j += 2 * i + 1) comp[j] = 1;
+        }
+    }
+    ks_uint64_t* bp = ks_zrealloc(NULL, sizeof(*bp), nb + 1);
+    for (i = 1, nb = 0; i < nc; ++i) {
+        if (!comp[i]) bp[nb++] = 2 * i + 1;
+    }
+    ks_free(comp);
+
+    unsigned char* seg = ks_malloc(SIEVE_SEG);
+    bool res = true;
+    ks_uint64_t lo;
+    for (lo = 3; res && lo < n; lo += 2 * SIEVE_SEG) {
+        /* Segment covers odd numbers in '[lo, hi)' */
+        ks_uint64_t hi = n - lo > 2 * SIEVE_SEG ? lo + 2 * SIEVE_SEG : n;
+        memset(seg, 0, SIEVE_SEG);
+        for (i = 0; i < nb && bp[i] * bp[i] < hi; ++i) {
+            ks_uint64_t p = bp[i], m = p * p;
+            if (m < lo) {
+                m = (lo + p - 1) / p * p;
+                if (!(m & 1)) m += p;
+            }
+            for (; m < hi; m += 2 * p) seg[(m - lo) / 2] = 1;
+        }
+        for (j = 0; lo + 2 * j < hi; ++j) {
+            if (!seg[j] && !fn(lo + 2 * j, arg)) {
+                res = false;
+                break;
+            }
+        }
+    }
+
+    ks_free(seg);
+    ks_free(bp);
+    return res;
+}
+
+static bool I_plist_push(ks_uint64_t p, void* arg) {
+    struct I_plist* L = arg;
+    if (L->n >= L->max) {
+        L->max = L->max * 2 + 64;
+        L->p = ks_zrealloc(L->p, sizeof(*L->p), L->max);
+    }
+    L->p[L->n++] = p;
+    return true;
+}
+
+/* Returns the high 64 bits of 'a * b' */
+static ks_uint64_t I_mulhi(ks_uint64_t a, ks_uint64_t b) {
+    ks_uint64_t a0 = a & 0xFFFFFFFF, a1 = a >> 32, b0 = b & 0xFFFFFFFF, b1 = b >> 32;
+    ks_uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    ks_uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+    return p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+/* Montgomery multiplication modulo odd 'n', where 'ninv*n == 1 (mod 2**64)' */
+static ks_uint64_t I_mont_mul(ks_uint64_t a, ks_uint64_t b, ks_uint64_t n, ks_uint64_t ninv) {
+    ks_uint64_t hi = I_mulhi(a, b), qh = I_mulhi(a * b * ninv, n);
+    return hi >= qh ? hi - qh : hi - qh + n;
+}
+
+/* Deterministic primality test for word-sized integers
+ *
+ * After trial division by small primes, this is Miller-Rabin with a set of bases known to have no
+ *   strong pseudoprimes below '2**64', using Montgomery arithmetic to avoid 128-bit division
+ */
+static bool I_isprime64(ks_uint64_t n) {
+    static const ks_uint64_t bases32[] = { 2, 7, 61 };
+    static const ks_uint64_t bases64[] = { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+    int i, j;
+    if (n < 2) return false;
+    for (i = 0; i < sizeof(I_smallp) / sizeof(*I_smallp); ++i) {
+        if (n % I_smallp[i] == 0) return n == I_smallp[i];
+    }
+    if (n < 67 * 67) return true;
+
+    ks_uint64_t ninv = n;
+    for (i = 0; i < 5; ++i) ninv *= 2 - n * ninv;
+
+    /* 'one' is '2**64 (mod n)', which is 1 in Montgomery form, and 'r2' converts into it */
+    ks_uint64_t one = (0 - n) % n, mone = n - one, r2 = one;
+    for (i = 0; i < 64; ++i) r2 = r2 >= n - r2 ? r2 - (n - r2) : r2 + r2;
+
+    ks_uint64_t d = n - 1;
+    int s = 0;
+    while (!(d & 1)) {
+        d >>= 1;
+        s++;
+    }
+
+    const ks_uint64_t* bases = n >> 32 ? bases64 : bases32;
+    int nbases = n >> 32 ? sizeof(bases64) / sizeof(*bases64) : sizeof(bases32) / sizeof(*bases32);
+    for (i = 0; i < nbases; ++i) {
+        ks_uint64_t a = bases[i] % n;
+        if (a == 0) continue;
+
+        /* x = a**d (mod n) */
+        ks_uint64_t b = I_mont_mul(a, r2, n, ninv), x = one, e = d;
+        while (e) {
+            if (e & 1) x = I_mont_mul(x, b, n, ninv);
+            b = I_mont_mul(b, b, n, ninv);
+            e >>= 1;
+        }
+        if (x == one || x == mone) continue;
+        for (j = 1; j < s && x != mone; ++j) x = I_mont_mul(x, x, n, ninv);
+        if (x != mone) return false;
+    }
+
+    return true;
+}
+
+#ifndef KS_HAVE_gmp
+
+/* Product of word-sized factors, packing as many as fit into each word */
+struct I_prod {
+    ks_size_t n, max;
+    unsigned long* f;
+    unsigned long acc;
+};
+
+static void I_prod_push(struct I_prod* P, unsigned long x) {
+    if (P->acc <= ULONG_MAX / x) {
+        P->acc *= x;
+        return;
+    }
+    if (P->n >= P->max) {
+        P->max = P->max * 2 + 64;
+        P->f = ks_zrealloc(P->f, sizeof(*P->f), P->max);
+    }
+    P->f[P->n++] = P->acc;
+    P->acc = x;
+}
+
+/* Sets 'r' to the product of 'f[:n]', with binary splitting so that multiplications are balanced */
+static void I_prod_mpz(mpz_t r, unsigned long* f, ks_size_t n) {
+    if (n <= 16) {
+        mpz_set_ui(r, 1);
+        ks_size_t i;
+        for (i = 0; i < n; ++i) mpz_mul_ui(r, r, f[i]);
+        return;
+    }
+    mpz_t t;
+    mpz_init(t);
+    I_prod_mpz(r, f, n / 2);
+    I_prod_mpz(t, f + n / 2, n - n / 2);
+    mpz_mul(r, r, t);
+    mpz_clear(t);
+}
+
+/* Sets 'r' to the product of 'P', and frees 'P' */
+static void I_prod_done(mpz_t r, struct I_prod* P) {
+    I_prod_push(P, ULONG_MAX);
+    I_prod_mpz(r, P->f, P->n);
+    ks_free(P->f);
+}
+
+/* Sets 'r' to 'n!', via the prime swing: 'n! = (n//2)!**2 * swing(n)', where 'swing(n)' is factored from 'L' (all primes '<= n') */
+static void I_fact(mpz_t r, ks_cint n, struct I_plist* L) {
+    if (n < 32) {
+        mpz_fac_ui(r, n);
+        return;
+    }
+    I_fact(r, n / 2, L);
+    mpz_mul(r, r, r);
+
+    struct I_prod P = { 0, 0, NULL, 1 };
+    ks_size_t i;
+    for (i = 0; i < L->n && L->p[i] <= n; ++i) {
+        unsigned long p = L->p[i], x = 1;
+        ks_cint q = n;
+        while ((q /= p) > 0) {
+            if (q & 1) x *= p;
+        }
+        if (x > 1) I_prod_push(&P, x);
+    }
+
+    mpz_t t;
+    mpz_init(t);
+    I_prod_done(t, &P);
+    mpz_mul(r, r, t);
+    mpz_clear(t);
+}
+
+/* Sets 'r' to 'n choose k' (for '0 <= k <= n/2'), from the exponent of each prime (Kummer's theorem) */
+static void I_choose(mpz_t r, ks_cint n, ks_cint k) {
+    struct I_plist L = { 0, 0, NULL };
+    I_sieve(n + 1, I_plist_push, &L);
+
+    struct I_prod P = { 0, 0, NULL, 1 };
+    ks_size_t i;
+    for (i = 0; i < L.n; ++i) {
+        unsigned long p = L.p[i], x = 1;
+        ks_cint a = n / p, b = k / p, c = (n - k) / p;
+        while (a > 0) {
+            if (a - b - c) x *= p;
+            a /= p;
+            b /= p;
+            c /= p;
+        }
+        if (x > 1) I_prod_push(&P, x);
+    }
+    ks_free(L.p);
+
+    I_prod_done(r, &P);
+}
+
+#endif
+
 static KS_TFUNC(m, isprime) {
     kso x;
     KS_ARGS("x", &x);
@@ -328,14 +577,17 @@ static KS_TFUNC(m, isprime) {
     ks_int ix = kso_int(x);
     if (!ix) return NULL;
 
-    bool res = false;
-
-    /* Get number of bits, according to Riemann hypothesis */
-    int nb = mpz_sizeinbase(ix->val, 2);
-    int mr_reps = nb * nb;
-    int gr = mpz_probab_prime_p(ix->val, nb);
-
-    res = gr != 0;
+    bool res;
+    if (mpz_sizeinbase(ix->val, 2) <= 64) {
+        /* Word-sized values (of either sign) are decided exactly */
+        ks_uint64_t n = 0;
+        size_t nw;
+        mpz_export(&n, &nw, -1, sizeof(n), 0, 0, ix->val);
+        res = I_isprime64(n);
+    } else {
+        /* Baillie-PSW, plus a few random Miller-Rabin rounds */
+        res = mpz_probab_prime_p(ix->val, 30) != 0;
+    }
 
     KS_DECREF(ix);
 
@@ -448,13 +700,16 @@ static KS_TFUNC(m, fact) {
         return NULL;
     }
 
-    #ifdef KS_INT_GMP
     mpz_t rx;
     mpz_init(rx);
 
+    #ifdef KS_HAVE_gmp
     mpz_fac_ui(rx, cx);
     #else
-
+    struct I_plist L = { 0, 0, NULL };
+    I_sieve(cx + 1, I_plist_push, &L);
+    I_fact(rx, cx, &L);
+    ks_free(L.p);
     #endif
 
     return (kso)ks_int_newzn(rx);
@@ -533,13 +788,36 @@ static KS_TFUNC(m, choose) {
         return NULL;
     }
     ks_cint cn = mpz_get_si(zin->val);
-    mpz_bin_uiui(res, cn, ck);
-    #endif    
+    if (ck > cn / 2) ck = cn - ck;
+    if (ck >= CHOOSE_FACTOR_K && cn / ck <= 65536) {
+        I_choose(res, cn, ck);
+    } else {
+        mpz_bin_uiui(res, cn, ck);
+    }
+    #endif
 
     KS_DECREF(zin);
     return (kso)ks_int_newzn(res);
 }
 
+static KS_TFUNC(m, primes) {
+    ks_cint n;
+    KS_ARGS("n:cint", &n);
+
+    ks_str nxk = ks_str_new(-1, "nx");
+    ks_module nxm = ks_import(nxk);
+    KS_DECREF(nxk);
+    if (!nxm) return NULL;
+    KS_DECREF(nxm);
+
+    struct I_plist L = { 0, 0, NULL };
+    if (n > 0) I_sieve(n, I_plist_push, &L);
+
+    nx_array res = nx_array_newc(nxt_array, L.p, nxd_s64, 1, (ks_size_t[]){ L.n }, NULL);
+    ks_free(L.p);
+    return (kso)res;
+}
+
 static KS_TFUNC(m, isclose) {
     kso x, y;
     ks_cfloat rel_err = 1e-6, abs_err = 1e-6;
@@ -622,6 +900,8 @@ ks_module _ksi_m() {
 
         {"isprime",                ksf_wrap(m_isprime_, M_NAME ".isprime(x)", "Calculate whether 'x' is prime in the field of integers")},
 
+        {"primes",                 ksf_wrap(m_primes_, M_NAME ".primes(n)", "Calculate all the primes less than 'n', as an 'nx.array' of 'nx.s64'\n\n    This uses a segmented sieve, so memory besides the result is 'O(sqrt(n))'")},
+
         {"modinv",                 ksf_wrap(m_modinv_, M_NAME ".modinv(x, N)", "Calculate the multiplicative inverse of 'x' modulo 'N'")},
 
         {"gcd",                    ksf_wrap(m_gcd_, M_NAME ".gcd(x, y)", "Compute the greatest common denominator of 'x' and 'y'\n\n    The result given by this function is always positive")},
@@ -40,6 +40,7 @@ ksnet_http_server ksnet_http_server_new(ks_type tp, kso addr) {
     }
 
     ksnet_http_server self = KSO_NEW(ksnet_http_server, tp);
+    self->attr = ks_dict_new(NULL);
     ks_dict_merge_ikv(self->attr, KS_IKV(
         {"addr",                   KS_NEWREF(addr)},
         {"sock",                   (kso)sock},
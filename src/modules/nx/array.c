@@ -164,7 +164,27 @@ static bool I_array_fill(ks_type tp, nx_dtype dtype, nx_array* resp, kso cur, in
 
 nx_array nx_array_newo(ks_type tp, kso obj, nx_dtype dtype) {
     if (!dtype) dtype = nxd_D;
-    
+
+    /* Unboxed lists are already a block of C values, so they can be cast directly */
+    if (kso_issub(obj->type, kst_list) && sizeof(ks_cint) == sizeof(ks_sint64_t)) {
+        ks_list lo = (ks_list)obj;
+        nx_dtype from = NULL;
+        if (lo->_strat == KS_LIST_S_INT && (dtype->kind == NX_DTYPE_INT || dtype == nxd_D)) {
+            from = nxd_s64;
+        } else if (lo->_strat == KS_LIST_S_FLOAT && (dtype->kind == NX_DTYPE_FLOAT || dtype->kind == NX_DTYPE_COMPLEX)) {
+            from = nxd_D;
+        }
+        if (from) {
+            ks_size_t len = lo->len;
+            nx_array res = nx_array_newc(tp, NULL, dtype, 1, &len, NULL);
+            if (!nx_cast(nx_make(lo->_raw_i, from, 1, &len, NULL), res->val)) {
+                KS_DECREF(res);
+                return NULL;
+            }
+            return res;
+        }
+    }
+
     /* Get block of objects */
     int rank;
     ks_size_t shape[NX_MAXRANK];
@@ -339,6 +359,24 @@ static KS_TFUNC(T, bytes) {
 
     return (kso)ksio_BytesIO_getf(sio);
 }
+static KS_TFUNC(T, memoryview) {
+    nx_array self;
+    KS_ARGS("self:*", &self, nxt_array);
+
+    /* Only dense (row-major, packed) data can be viewed as a single buffer */
+    ks_ssize_t sz = self->val.dtype->size;
+    int i;
+    for (i = self->val.rank - 1; i >= 0; --i) {
+        if (self->val.shape[i] > 1 && self->val.strides[i] != sz) {
+            KS_THROW(kst_ValError, "Cannot create 'memoryview' of non-contiguous array");
+            return NULL;
+        }
+        sz *= self->val.shape[i];
+    }
+
+    return (kso)ks_memoryview_new((kso)self, self->val.data, sz, false);
+}
+
 static KS_TFUNC(T, float) {
     nx_array self;
     KS_ARGS("self:*", &self, nxt_array);
@@ -743,6 +781,7 @@ void _ksi_nx_array() {
         {"__repr",                 ksf_wrap(T_str_, T_NAME ".__repr(self)", "")},
         {"__str",                  ksf_wrap(T_str_, T_NAME ".__str(self)", "")},
         {"__bytes",                ksf_wrap(T_bytes_, T_NAME ".__bytes(self)", "")},
+        {"__memoryview",           ksf_wrap(T_memoryview_, T_NAME ".__memoryview(self)", "")},
         {"__float",                ksf_wrap(T_float_, T_NAME ".__float(self)", "")},
         {"__int",                  ksf_wrap(T_int_, T_NAME ".__int(self)", "")},
         {"__iter",                 (kso)nxt_array_iter},
@@ -14,6 +14,7 @@
 
 static nx_dtype make_int(const char* name, const char* namecode, int sz) {
     nx_dtype res = KSO_NEW(nx_dtype, nxt_dtype);
+    res->attr = ks_dict_new(NULL);
 
     res->name = ks_str_new(-1, name);
     res->namecode = ks_str_new(-1, namecode);
@@ -26,6 +27,7 @@ static nx_dtype make_int(const char* name, const char* namecode, int sz) {
 
 static nx_dtype make_float(const char* name, const char* namecode, int sz) {
     nx_dtype res = KSO_NEW(nx_dtype, nxt_dtype);
+    res->attr = ks_dict_new(NULL);
 
     res->name = ks_str_new(-1, name);
     res->namecode = ks_str_new(-1, namecode);
@@ -38,6 +40,7 @@ static nx_dtype make_float(const char* name, const char* namecode, int sz) {
 
 static nx_dtype make_complex(const char* name, const char* namecode, int sz) {
     nx_dtype res = KSO_NEW(nx_dtype, nxt_dtype);
+    res->attr = ks_dict_new(NULL);
 
     res->name = ks_str_new(-1, name);
     res->namecode = ks_str_new(-1, namecode);
@@ -50,6 +53,7 @@ static nx_dtype make_complex(const char* name, const char* namecode, int sz) {
 
 nx_dtype nx_dtype_struct(ks_str name, kso members) {
     nx_dtype res = KSO_NEW(nx_dtype, nxt_dtype);
+    res->attr = ks_dict_new(NULL);
 
     KS_INCREF(name);
     res->name = name;
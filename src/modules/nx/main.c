@@ -516,6 +516,10 @@ T_A1(exp)
 T_A1(log)
 T_A1(sqrt)
 
+T_A1(gamma)
+T_A1(zeta)
+T_A1(erf)
+
 T_A1_r(abs)
 T_A1(conj)
 T_A1(neg)
@@ -636,6 +640,10 @@ ks_module _ksi_nx() {
 
         {"sqrt",                   ksf_wrap(M_sqrt_, M_NAME ".sqrt(x, y, r=none)", "Computes elementwise square root")},
 
+        {"gamma",                  ksf_wrap(M_gamma_, M_NAME ".gamma(x, r=none)", "Computes elementwise Gamma function (the same as 'm.gamma')")},
+        {"zeta",                   ksf_wrap(M_zeta_, M_NAME ".zeta(x, r=none)", "Computes elementwise Riemann Zeta function (the same as 'm.zeta')")},
+        {"erf",                    ksf_wrap(M_erf_, M_NAME ".erf(x, r=none)", "Computes elementwise error function (the same as 'm.erf'), which is only defined for real types")},
+
 
         {"min",                    ksf_wrap(M_min_, M_NAME ".min(x, axes=none, r=none)", "Minimum of elements")},
         {"max",                    ksf_wrap(M_max_, M_NAME ".max(x, axes=none, r=none)", "Maximum of elements")},
@@ -0,0 +1,27 @@
+/* erf.c - 'erf' kernel
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+#include <ks/nxi.h>
+#include <ks/nxt.h>
+
+#define KERN_FUNC(_name) NXK_PASTE(kern_, _name)
+
+#define NXK_DO_F
+#define NXK_FILE "erf.kern"
+#define K_NAME "erf"
+#include <ks/nxk.h>
+
+bool nx_erf(nx_t X, nx_t R) {
+
+    if (false) {}
+    #define LOOP(TYPE, NAME) else if (R.dtype == nxd_##NAME) { \
+        return !nx_apply_elem(KERN_FUNC(NAME), 2, (nx_t[]){ X, R }, R.dtype, NULL); \
+    }
+    NXT_PASTE_F(LOOP)
+    #undef LOOP
+
+    KS_THROW(kst_TypeError, "Unsupported types for kernel '%s': %R, %R", K_NAME, X.dtype, R.dtype);
+    return false;
+}
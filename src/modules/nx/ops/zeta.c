@@ -0,0 +1,32 @@
+/* zeta.c - 'zeta' kernel
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+#include <ks/nxi.h>
+#include <ks/nxt.h>
+#include <ks/m.h>
+
+#define KERN_FUNC(_name) NXK_PASTE(kern_, _name)
+
+/* Number of elements evaluated together by the real kernels */
+#define K_BLOCK 256
+
+#define NXK_DO_F
+#define NXK_DO_C
+#define NXK_FILE "zeta.kern"
+#define K_NAME "zeta"
+#include <ks/nxk.h>
+
+bool nx_zeta(nx_t X, nx_t R) {
+
+    if (false) {}
+    #define LOOP(TYPE, NAME) else if (R.dtype == nxd_##NAME) { \
+        return !nx_apply_elem(KERN_FUNC(NAME), 2, (nx_t[]){ X, R }, R.dtype, NULL); \
+    }
+    NXT_PASTE_FC(LOOP)
+    #undef LOOP
+
+    KS_THROW(kst_TypeError, "Unsupported types for kernel '%s': %R, %R", K_NAME, X.dtype, R.dtype);
+    return false;
+}
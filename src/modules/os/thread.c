@@ -40,18 +40,41 @@ static void join_active_threads() {
 }
 
 
-#ifdef KS_HAVE_pthreads
+#if defined(KS_TLS)
+
+/* Thread-local variable which we store the thread instance in, which is just a
+ *   memory load (as opposed to a call to 'pthread_getspecific()')
+ */
+static KS_TLS ksos_thread this_thread = NULL;
+
+#define SET_THIS_THREAD(_th) do { \
+    this_thread = (_th); \
+} while (0)
 
+#elif defined(KS_HAVE_pthreads)
 
 /* Thread-local key which we store the thread instance on */
 static pthread_key_t this_thread_key;
 
+#define SET_THIS_THREAD(_th) do { \
+    pthread_setspecific(this_thread_key, (void*)(_th)); \
+} while (0)
+
+#else
+
+#define SET_THIS_THREAD(_th) do { \
+} while (0)
+
+#endif
+
+
+#ifdef KS_HAVE_pthreads
 
 /* Initialize and begin pthreads-specific */
 static void* init_thread_pthreads(void* _self) {
     ksos_thread self = (ksos_thread)_self;
 
-    pthread_setspecific(this_thread_key, (void*)self);
+    SET_THIS_THREAD(self);
     KS_GIL_LOCK();
     self->is_active = true;
     self->is_queue = false;
@@ -111,10 +134,10 @@ ksos_thread ksos_thread_new(ks_type tp, ks_str name, kso of, ks_tuple args) {
 
 ksos_thread ksos_thread_get() {
     ksos_thread res = NULL;
-    #ifdef KS_HAVE_pthreads
+    #if defined(KS_TLS)
+    res = this_thread;
+    #elif defined(KS_HAVE_pthreads)
     res = (ksos_thread)pthread_getspecific(this_thread_key);
-    #else
-
     #endif
     return res ? res : ksg_main_thread;
 }
@@ -261,7 +284,7 @@ void _ksi_os_thread() {
     active_threads = ks_set_new(0, NULL);
     atexit(join_active_threads);
 
-    #ifdef KS_HAVE_pthreads
+    #if !defined(KS_TLS) && defined(KS_HAVE_pthreads)
 
     /* Create a per-thread keyed variable */
     int stat = pthread_key_create(&this_thread_key, NULL);
@@ -270,10 +293,10 @@ void _ksi_os_thread() {
         kso_exit_if_err();
     }
 
-    /* Set the variable for this thread */
-    pthread_setspecific(this_thread_key, (void*)ksg_main_thread);
+    #endif
 
-    #endif /* KS_HAVE_pthreads */
+    /* Set the variable for this thread */
+    SET_THIS_THREAD(ksg_main_thread);
 }
 
 
@@ -599,7 +599,7 @@ RULE(STMT) {
 
             if (TOK.kind == KS_TOK_AS) {
                 /* catch as <name> */
-                ks_str ename = ks_str_new(-1, "Exception");
+                ks_str ename = ks_str_intern_c(-1, "Exception");
                 tp = ks_ast_new(KS_AST_NAME, 0, NULL, (kso)ename, EAT());
                 KS_DECREF(ename);
                 
@@ -611,7 +611,7 @@ RULE(STMT) {
                 }
             } else if (TOK.kind == KS_TOK_LBRC) {
                 /* Don't handle here, parse below */
-                ks_str ename = ks_str_new(-1, "Exception");
+                ks_str ename = ks_str_intern_c(-1, "Exception");
                 tp = ks_ast_new(KS_AST_NAME, 0, NULL, (kso)ename, TOK);
                 KS_DECREF(ename);
 
@@ -1216,7 +1216,7 @@ RULE(E15) {
         res = ks_ast_new(KS_AST_FUNC, 0, NULL, NULL, EAT());
         ks_str fname = NULL;
         if (TOK.kind == KS_TOK_NAME) {
-            fname = ks_tok_str(src, EAT());
+            fname = ks_tok_name(src, EAT());
         } else {
             fname = ks_str_new(-1, "<anon-func>");
         }
@@ -1333,7 +1333,7 @@ RULE(E15) {
         res = ks_ast_new(KS_AST_TYPE, 0, NULL, NULL, EAT());
         ks_str tname = NULL;
         if (TOK.kind == KS_TOK_NAME) {
-            tname = ks_tok_str(src, EAT());
+            tname = ks_tok_name(src, EAT());
         } else {
             tname = ks_str_new(-1, "<anon-type>");
         }
@@ -1350,7 +1350,7 @@ RULE(E15) {
             ks_ast_pushn(res, ext);
             
         } else {
-            ks_ast ext = ks_ast_newn(KS_AST_NAME, 0, NULL, (kso)ks_str_new(-1, "object"), res->tok);
+            ks_ast ext = ks_ast_newn(KS_AST_NAME, 0, NULL, (kso)ks_str_intern_c(-1, "object"), res->tok);
             ks_ast_pushn(res, ext);
         }
 
@@ -1374,7 +1374,7 @@ RULE(E15) {
         res = ks_ast_new(KS_AST_ENUM, 0, NULL, NULL, EAT());
         ks_str tname = NULL;
         if (TOK.kind == KS_TOK_NAME) {
-            tname = ks_tok_str(src, EAT());
+            tname = ks_tok_name(src, EAT());
         } else {
             tname = ks_str_new(-1, "<anon-enum>");
         }
@@ -1460,7 +1460,7 @@ RULE(E15) {
             t = EAT();
             if (TOK.kind == KS_TOK_NAME) {
                 t = EAT();
-                res = ks_ast_newn(KS_AST_ATTR, 1, (ks_ast[]){ res }, (kso)ks_tok_str(src, t), t);
+                res = ks_ast_newn(KS_AST_ATTR, 1, (ks_ast[]){ res }, (kso)ks_tok_name(src, t), t);
             } else {
                 KS_THROW_SYNTAX(fname, src, TOK, "Expected a valid name after '.' for attribute reference");
                 KS_DECREF(res);
@@ -1699,8 +1699,8 @@ RULE(ATOM) {
     /* Check for single token expressions */
     if (TOK.kind == KS_TOK_NAME) {
         ks_tok t = EAT();
-        ks_str v = ks_tok_str(src, t);
-        kso r = ks_dict_get_ih(kwconst, (kso)v, v->v_hash);
+        ks_str v = ks_tok_name(src, t);
+        kso r = ks_dict_get_ih(kwconst, (kso)v, KS_STR_HASH(v));
         ks_ast res = NULL;
         if (r) {
             KS_DECREF(v);
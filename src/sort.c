@@ -58,9 +58,9 @@ static bool my_le(kso L, kso R, bool* is_le, kso cmpfunc) {
 
 // Merge 'A' and 'B'
 static bool my_merge(ks_size_t n, kso* elems, kso* keys, ks_size_t A_n, kso* A_elems, kso* A_keys, ks_size_t B_n, kso* B_elems, kso* B_keys, kso cmpfunc) {
-    // check if they are already merged
+    // check if they are already merged (i.e. the end of 'A' comes before the start of 'B')
     bool is_sorted;
-    if (!my_le(A_keys[A_n - 1], B_keys[B_n - 1], &is_sorted, cmpfunc)) return false;
+    if (!my_le(A_keys[A_n - 1], B_keys[0], &is_sorted, cmpfunc)) return false;
 
     if (is_sorted) {
         memcpy(elems, A_elems, sizeof(*elems) * A_n);
@@ -183,8 +183,682 @@ bool ks_sort_merge(ks_size_t n, kso* elems, kso* keys, kso cmpfunc) {
     return res;
 }
 
-bool ks_sort(ks_size_t n, kso* elems, kso* keys, kso cmpfunc) {
-    return ks_sort_merge(n, elems, keys, cmpfunc);
+
+
+/* Timsort
+ *
+ * Natural merge sort which finds existing runs (extending short ones with binary insertion sort), and merges them
+ *   while keeping the run lengths balanced. When one run keeps 'winning' during a merge, it switches to galloping
+ *   (exponential search), so sorted and nearly-sorted inputs take close to linear time
+ *
+ * If a comparison throws an error, the input is left as some permutation of itself
+ *
+ * SEE: https://github.com/python/cpython/blob/main/Objects/listsort.txt
+ */
+
+/* Minimum number of consecutive wins before galloping */
+#define S_MIN_GALLOP 7
+
+/* Maximum number of pending runs (enough for 2**64 elements) */
+#define S_MAX_RUNS 85
+
+/* Kinds of comparisons, which are specialized when all keys are of the same builtin type */
+enum {
+    S_GENERIC = 0,
+    S_INT,
+    S_FLOAT,
+    S_STR,
+};
+
+/* Slice of keys and their elements ('e' is NULL when the keys are the elements) */
+struct s_slice {
+    kso* k;
+    kso* e;
+};
+
+/* Sorting state */
+struct s_sort {
+
+    /* Custom comparison function, or NULL */
+    kso cmpfunc;
+
+    /* Kind of comparison (see 'S_*') */
+    int kind;
+
+    /* Current threshold for galloping, which adapts to the data */
+    ks_ssize_t min_gallop;
+
+    /* Temporary buffer for merges (allocated on demand) */
+    struct s_slice tmp;
+    ks_ssize_t tmp_n;
+
+    /* Stack of pending runs */
+    int n_runs;
+    struct {
+        struct s_slice base;
+        ks_ssize_t len;
+    } runs[S_MAX_RUNS];
+
+};
+
+/* Compute whether 'L < R' (which is '!(R <= L)'), storing in 'out' */
+static inline bool s_lt(struct s_sort* S, kso L, kso R, bool* out) {
+    switch (S->kind) {
+        case S_INT:
+            *out = mpz_cmp(((ks_int)L)->val, ((ks_int)R)->val) < 0;
+            return true;
+        case S_FLOAT:
+            *out = !(((ks_float)R)->val <= ((ks_float)L)->val);
+            return true;
+        case S_STR:
+            *out = ks_str_cmp((ks_str)L, (ks_str)R) < 0;
+            return true;
+    }
+
+    bool le;
+    if (!my_le(R, L, &le, S->cmpfunc)) return false;
+    *out = !le;
+    return true;
+}
+
+/* Slice operations, which apply to the elements as well, if they are separate */
+
+static inline struct s_slice s_at(struct s_slice a, ks_ssize_t i) {
+    a.k += i;
+    if (a.e) a.e += i;
+    return a;
+}
+
+static inline void s_move(struct s_slice dst, ks_ssize_t di, struct s_slice src, ks_ssize_t si, ks_ssize_t n) {
+    memmove(dst.k + di, src.k + si, sizeof(*dst.k) * n);
+    if (dst.e) memmove(dst.e + di, src.e + si, sizeof(*dst.e) * n);
+}
+
+static inline void s_set(struct s_slice dst, ks_ssize_t di, struct s_slice src, ks_ssize_t si) {
+    dst.k[di] = src.k[si];
+    if (dst.e) dst.e[di] = src.e[si];
+}
+
+static void s_reverse(struct s_slice a, ks_ssize_t n) {
+    ks_ssize_t i;
+    for (i = 0; i < n / 2; ++i) {
+        kso t = a.k[i];
+        a.k[i] = a.k[n - 1 - i];
+        a.k[n - 1 - i] = t;
+        if (a.e) {
+            t = a.e[i];
+            a.e[i] = a.e[n - 1 - i];
+            a.e[n - 1 - i] = t;
+        }
+    }
 }
 
+/* Ensure the temporary buffer can hold 'n' items */
+static void s_reserve(struct s_sort* S, ks_ssize_t n, bool has_e) {
+    if (n <= S->tmp_n) return;
+    ks_free(S->tmp.k);
+    S->tmp.k = ks_malloc(sizeof(*S->tmp.k) * (has_e ? 2 * n : n));
+    S->tmp.e = has_e ? S->tmp.k + n : NULL;
+    S->tmp_n = n;
+}
 
+/* Find the length of the run at the start of 'a' (reversing it if it is strictly descending) */
+static bool s_count_run(struct s_sort* S, struct s_slice a, ks_ssize_t n, ks_ssize_t* res) {
+    ks_ssize_t i = 1;
+    bool lt;
+    if (n > 1) {
+        if (!s_lt(S, a.k[1], a.k[0], &lt)) return false;
+        i = 2;
+        if (lt) {
+            /* Strictly descending, so reversing keeps it stable */
+            while (i < n) {
+                if (!s_lt(S, a.k[i], a.k[i - 1], &lt)) return false;
+                if (!lt) break;
+                i++;
+            }
+            s_reverse(a, i);
+        } else {
+            while (i < n) {
+                if (!s_lt(S, a.k[i], a.k[i - 1], &lt)) return false;
+                if (lt) break;
+                i++;
+            }
+        }
+    }
+
+    *res = i;
+    return true;
+}
+
+/* Binary insertion sort of 'a', where the first 'start' elements are already sorted */
+static bool s_binsort(struct s_sort* S, struct s_slice a, ks_ssize_t n, ks_ssize_t start) {
+    ks_ssize_t i;
+    for (i = start; i < n; ++i) {
+        kso pk = a.k[i], pe = a.e ? a.e[i] : NULL;
+        ks_ssize_t lo = 0, hi = i;
+        while (lo < hi) {
+            ks_ssize_t mid = lo + (hi - lo) / 2;
+            bool lt;
+            if (!s_lt(S, pk, a.k[mid], &lt)) return false;
+            if (lt) hi = mid;
+            else lo = mid + 1;
+        }
+        s_move(a, lo + 1, a, lo, i - lo);
+        a.k[lo] = pk;
+        if (a.e) a.e[lo] = pe;
+    }
+    return true;
+}
+
+/* Find where 'key' belongs in the sorted 'a', to the left of any equal elements, searching outwards from 'hint' */
+static bool s_gallop_left(struct s_sort* S, kso key, kso* a, ks_ssize_t n, ks_ssize_t hint, ks_ssize_t* res) {
+    ks_ssize_t ofs = 1, lastofs = 0, maxofs, k;
+    bool lt;
+    if (!s_lt(S, a[hint], key, &lt)) return false;
+    if (lt) {
+        /* a[hint] < key, so gallop right until a[hint+lastofs] < key <= a[hint+ofs] */
+        maxofs = n - hint;
+        while (ofs < maxofs) {
+            if (!s_lt(S, a[hint + ofs], key, &lt)) return false;
+            if (!lt) break;
+            lastofs = ofs;
+            ofs = 2 * ofs + 1;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        lastofs += hint;
+        ofs += hint;
+    } else {
+        /* key <= a[hint], so gallop left until a[hint-ofs] < key <= a[hint-lastofs] */
+        maxofs = hint + 1;
+        while (ofs < maxofs) {
+            if (!s_lt(S, a[hint - ofs], key, &lt)) return false;
+            if (lt) break;
+            lastofs = ofs;
+            ofs = 2 * ofs + 1;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        k = lastofs;
+        lastofs = hint - ofs;
+        ofs = hint - k;
+    }
+
+    /* Now, a[lastofs] < key <= a[ofs], so binary search in between */
+    lastofs++;
+    while (lastofs < ofs) {
+        ks_ssize_t m = lastofs + (ofs - lastofs) / 2;
+        if (!s_lt(S, a[m], key, &lt)) return false;
+        if (lt) lastofs = m + 1;
+        else ofs = m;
+    }
+
+    *res = ofs;
+    return true;
+}
+
+/* Find where 'key' belongs in the sorted 'a', to the right of any equal elements, searching outwards from 'hint' */
+static bool s_gallop_right(struct s_sort* S, kso key, kso* a, ks_ssize_t n, ks_ssize_t hint, ks_ssize_t* res) {
+    ks_ssize_t ofs = 1, lastofs = 0, maxofs, k;
+    bool lt;
+    if (!s_lt(S, key, a[hint], &lt)) return false;
+    if (lt) {
+        /* key < a[hint], so gallop left until a[hint-ofs] <= key < a[hint-lastofs] */
+        maxofs = hint + 1;
+        while (ofs < maxofs) {
+            if (!s_lt(S, key, a[hint - ofs], &lt)) return false;
+            if (!lt) break;
+            lastofs = ofs;
+            ofs = 2 * ofs + 1;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        k = lastofs;
+        lastofs = hint - ofs;
+        ofs = hint - k;
+    } else {
+        /* a[hint] <= key, so gallop right until a[hint+lastofs] <= key < a[hint+ofs] */
+        maxofs = n - hint;
+        while (ofs < maxofs) {
+            if (!s_lt(S, key, a[hint + ofs], &lt)) return false;
+            if (lt) break;
+            lastofs = ofs;
+            ofs = 2 * ofs + 1;
+        }
+        if (ofs > maxofs) ofs = maxofs;
+        lastofs += hint;
+        ofs += hint;
+    }
+
+    /* Now, a[lastofs] <= key < a[ofs], so binary search in between */
+    lastofs++;
+    while (lastofs < ofs) {
+        ks_ssize_t m = lastofs + (ofs - lastofs) / 2;
+        if (!s_lt(S, key, a[m], &lt)) return false;
+        if (lt) ofs = m;
+        else lastofs = m + 1;
+    }
+
+    *res = ofs;
+    return true;
+}
+
+/* Merge adjacent runs 'a' and 'b' (where 'na <= nb'), working from the left
+ * 'a[0]' belongs after 'b[0]', and 'a[na-1]' belongs at the end
+ */
+static bool s_merge_lo(struct s_sort* S, struct s_slice a, ks_ssize_t na, struct s_slice b, ks_ssize_t nb) {
+    struct s_slice dest = a;
+    s_reserve(S, na, a.e != NULL);
+    s_move(S->tmp, 0, a, 0, na);
+    a = S->tmp;
+
+    ks_ssize_t min_gallop = S->min_gallop, acount, bcount, k;
+    bool lt, res = false;
+
+    s_set(dest, 0, b, 0);
+    dest = s_at(dest, 1);
+    b = s_at(b, 1);
+    if (--nb == 0) goto done;
+    if (na == 1) goto copy_b;
+
+    while (true) {
+        acount = bcount = 0;
+
+        /* Merge one at a time, until a run wins consistently */
+        while (true) {
+            if (!s_lt(S, b.k[0], a.k[0], &lt)) goto fail;
+            if (lt) {
+                s_set(dest, 0, b, 0);
+                dest = s_at(dest, 1);
+                b = s_at(b, 1);
+                bcount++;
+                acount = 0;
+                if (--nb == 0) goto done;
+                if (bcount >= min_gallop) break;
+            } else {
+                s_set(dest, 0, a, 0);
+                dest = s_at(dest, 1);
+                a = s_at(a, 1);
+                acount++;
+                bcount = 0;
+                if (--na == 1) goto copy_b;
+                if (acount >= min_gallop) break;
+            }
+        }
+
+        /* Gallop, until neither run is winning by much */
+        min_gallop++;
+        do {
+            if (min_gallop > 1) min_gallop--;
+            S->min_gallop = min_gallop;
+
+            if (!s_gallop_right(S, b.k[0], a.k, na, 0, &k)) goto fail;
+            acount = k;
+            if (k) {
+                s_move(dest, 0, a, 0, k);
+                dest = s_at(dest, k);
+                a = s_at(a, k);
+                na -= k;
+                if (na == 1) goto copy_b;
+                /* Only possible with an inconsistent comparison function */
+                if (na == 0) goto done;
+            }
+            s_set(dest, 0, b, 0);
+            dest = s_at(dest, 1);
+            b = s_at(b, 1);
+            if (--nb == 0) goto done;
+
+            if (!s_gallop_left(S, a.k[0], b.k, nb, 0, &k)) goto fail;
+            bcount = k;
+            if (k) {
+                s_move(dest, 0, b, 0, k);
+                dest = s_at(dest, k);
+                b = s_at(b, k);
+                nb -= k;
+                if (nb == 0) goto done;
+            }
+            s_set(dest, 0, a, 0);
+            dest = s_at(dest, 1);
+            a = s_at(a, 1);
+            if (--na == 1) goto copy_b;
+        } while (acount >= S_MIN_GALLOP || bcount >= S_MIN_GALLOP);
+
+        min_gallop++;
+        S->min_gallop = min_gallop;
+    }
+
+done:
+    res = true;
+fail:
+    /* Put the rest of 'a' back, even on an error, so nothing is lost */
+    if (na) s_move(dest, 0, a, 0, na);
+    return res;
+
+copy_b:
+    /* The last element of 'a' belongs at the end */
+    s_move(dest, 0, b, 0, nb);
+    s_set(dest, nb, a, 0);
+    return true;
+}
+
+/* Merge adjacent runs 'a' and 'b' (where 'na >= nb'), working from the right
+ * 'a[0]' belongs at the start, and 'a[na-1]' belongs after 'b[nb-1]'
+ */
+static bool s_merge_hi(struct s_sort* S, struct s_slice a, ks_ssize_t na, struct s_slice b, ks_ssize_t nb) {
+    struct s_slice dest = s_at(b, nb - 1), basea = a, baseb;
+    s_reserve(S, nb, a.e != NULL);
+    s_move(S->tmp, 0, b, 0, nb);
+    baseb = S->tmp;
+    b = s_at(S->tmp, nb - 1);
+    a = s_at(a, na - 1);
+
+    ks_ssize_t min_gallop = S->min_gallop, acount, bcount, k;
+    bool lt, res = false;
+
+    s_set(dest, 0, a, 0);
+    dest = s_at(dest, -1);
+    a = s_at(a, -1);
+    if (--na == 0) goto done;
+    if (nb == 1) goto copy_a;
+
+    while (true) {
+        acount = bcount = 0;
+
+        /* Merge one at a time, until a run wins consistently */
+        while (true) {
+            if (!s_lt(S, b.k[0], a.k[0], &lt)) goto fail;
+            if (lt) {
+                s_set(dest, 0, a, 0);
+                dest = s_at(dest, -1);
+                a = s_at(a, -1);
+                acount++;
+                bcount = 0;
+                if (--na == 0) goto done;
+                if (acount >= min_gallop) break;
+            } else {
+                s_set(dest, 0, b, 0);
+                dest = s_at(dest, -1);
+                b = s_at(b, -1);
+                bcount++;
+                acount = 0;
+                if (--nb == 1) goto copy_a;
+                if (bcount >= min_gallop) break;
+            }
+        }
+
+        /* Gallop, until neither run is winning by much */
+        min_gallop++;
+        do {
+            if (min_gallop > 1) min_gallop--;
+            S->min_gallop = min_gallop;
+
+            if (!s_gallop_right(S, b.k[0], basea.k, na, na - 1, &k)) goto fail;
+            k = na - k;
+            acount = k;
+            if (k) {
+                dest = s_at(dest, -k);
+                a = s_at(a, -k);
+                s_move(dest, 1, a, 1, k);
+                na -= k;
+                if (na == 0) goto done;
+            }
+            s_set(dest, 0, b, 0);
+            dest = s_at(dest, -1);
+            b = s_at(b, -1);
+            if (--nb == 1) goto copy_a;
+
+            if (!s_gallop_left(S, a.k[0], baseb.k, nb, nb - 1, &k)) goto fail;
+            k = nb - k;
+            bcount = k;
+            if (k) {
+                dest = s_at(dest, -k);
+                b = s_at(b, -k);
+                s_move(dest, 1, b, 1, k);
+                nb -= k;
+                if (nb == 1) goto copy_a;
+                /* Only possible with an inconsistent comparison function */
+                if (nb == 0) goto done;
+            }
+            s_set(dest, 0, a, 0);
+            dest = s_at(dest, -1);
+            a = s_at(a, -1);
+            if (--na == 0) goto done;
+        } while (acount >= S_MIN_GALLOP || bcount >= S_MIN_GALLOP);
+
+        min_gallop++;
+        S->min_gallop = min_gallop;
+    }
+
+done:
+    res = true;
+fail:
+    /* Put the rest of 'b' back, even on an error, so nothing is lost */
+    if (nb) s_move(dest, 1 - nb, baseb, 0, nb);
+    return res;
+
+copy_a:
+    /* The first element of 'b' belongs at the start */
+    dest = s_at(dest, -na);
+    a = s_at(a, -na);
+    s_move(dest, 1, a, 1, na);
+    s_set(dest, 0, b, 0);
+    return true;
+}
+
+/* Merge the pending runs 'i' and 'i+1' */
+static bool s_merge_at(struct s_sort* S, int i) {
+    struct s_slice a = S->runs[i].base, b = S->runs[i + 1].base;
+    ks_ssize_t na = S->runs[i].len, nb = S->runs[i + 1].len, k;
+
+    S->runs[i].len = na + nb;
+    if (i == S->n_runs - 3) S->runs[i + 1] = S->runs[i + 2];
+    S->n_runs--;
+
+    /* Elements of 'a' before where 'b[0]' goes are already in place */
+    if (!s_gallop_right(S, b.k[0], a.k, na, 0, &k)) return false;
+    a = s_at(a, k);
+    na -= k;
+    if (na == 0) return true;
+
+    /* Elements of 'b' after where 'a[na-1]' goes are already in place */
+    if (!s_gallop_left(S, a.k[na - 1], b.k, nb, nb - 1, &nb)) return false;
+    if (nb == 0) return true;
+
+    return na <= nb ? s_merge_lo(S, a, na, b, nb) : s_merge_hi(S, a, na, b, nb);
+}
+
+/* Merge pending runs until the lengths on the stack are decreasing faster than the Fibonacci numbers */
+static bool s_merge_collapse(struct s_sort* S) {
+    while (S->n_runs > 1) {
+        int n = S->n_runs - 2;
+        if ((n > 0 && S->runs[n - 1].len <= S->runs[n].len + S->runs[n + 1].len) || (n > 1 && S->runs[n - 2].len <= S->runs[n - 1].len + S->runs[n].len)) {
+            if (S->runs[n - 1].len < S->runs[n + 1].len) n--;
+        } else if (S->runs[n].len > S->runs[n + 1].len) {
+            break;
+        }
+        if (!s_merge_at(S, n)) return false;
+    }
+    return true;
+}
+
+/* Merge all pending runs */
+static bool s_merge_force(struct s_sort* S) {
+    while (S->n_runs > 1) {
+        int n = S->n_runs - 2;
+        if (n > 0 && S->runs[n - 1].len < S->runs[n + 1].len) n--;
+        if (!s_merge_at(S, n)) return false;
+    }
+    return true;
+}
+
+/* Compute the minimum run length, so 'n / minrun' is a power of two (or slightly less) */
+static ks_ssize_t s_minrun(ks_ssize_t n) {
+    ks_ssize_t r = 0;
+    while (n >= 64) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+bool ks_sort_tim(ks_size_t n, kso* elems, kso* keys, kso cmpfunc) {
+    if (n <= 1) {
+        /* Already sorted (trivially) */
+        return true;
+    }
+
+    struct s_sort S;
+    S.cmpfunc = cmpfunc == KSO_NONE ? NULL : cmpfunc;
+    S.kind = S_GENERIC;
+    S.min_gallop = S_MIN_GALLOP;
+    S.tmp.k = S.tmp.e = NULL;
+    S.tmp_n = 0;
+    S.n_runs = 0;
+
+    if (!S.cmpfunc) {
+        /* Check for keys which all have the same (exact) builtin type, so comparisons can't fail or call out */
+        ks_type tp = keys[0]->type;
+        ks_size_t i;
+        for (i = 1; i < n && keys[i]->type == tp; ++i) {}
+        if (i == n) {
+            if (tp == kst_int) S.kind = S_INT;
+            else if (tp == kst_float) S.kind = S_FLOAT;
+            else if (tp == kst_str) S.kind = S_STR;
+        }
+    }
+
+    struct s_slice all = { keys, keys == elems ? NULL : elems };
+    ks_ssize_t minrun = s_minrun(n), lo = 0, rem = n;
+    bool res = true;
+    while (res && rem > 0) {
+        struct s_slice run = s_at(all, lo);
+        ks_ssize_t nr;
+        if (!s_count_run(&S, run, rem, &nr)) {
+            res = false;
+            break;
+        }
+
+        /* Extend short runs */
+        if (nr < minrun) {
+            ks_ssize_t force = rem < minrun ? rem : minrun;
+            if (!s_binsort(&S, run, force, nr)) {
+                res = false;
+                break;
+            }
+            nr = force;
+        }
+
+        S.runs[S.n_runs].base = run;
+        S.runs[S.n_runs].len = nr;
+        S.n_runs++;
+        res = s_merge_collapse(&S);
+
+        lo += nr;
+        rem -= nr;
+    }
+    if (res) res = s_merge_force(&S);
+
+    ks_free(S.tmp.k);
+    return res;
+}
+
+
+/* Unboxed values
+ *
+ * Lists with unboxed storage are sorted with a stable LSD radix sort over the bits of the values (transformed so
+ *   that unsigned order is numeric order). It never calls out, and digits which are the same for every value are skipped
+ */
+
+/* Below this size, use insertion sort */
+#define S_RAW_SMALL 64
+
+#define S_SIGN ((ks_uint64_t)1 << 63)
+
+/* Transform 64 bits (of an integer, or a non-NaN float) into a key with the same order */
+static inline ks_uint64_t s_rkey(ks_uint64_t x, bool isf) {
+    if (!isf) return x ^ S_SIGN;
+
+    /* '-0.0' is equal to '0.0', so it keeps its position */
+    if (x == S_SIGN) x = 0;
+    return (x & S_SIGN) ? ~x : (x | S_SIGN);
+}
+
+static void s_sort_raw(ks_size_t n, ks_uint64_t* vals, bool isf) {
+    ks_size_t i, j;
+
+    /* Check whether it is already sorted */
+    for (i = 1; i < n && s_rkey(vals[i - 1], isf) <= s_rkey(vals[i], isf); ++i) {}
+    if (i >= n) return;
+
+    if (n < S_RAW_SMALL) {
+        for (i = 1; i < n; ++i) {
+            ks_uint64_t x = vals[i], k = s_rkey(x, isf);
+            for (j = i; j > 0 && s_rkey(vals[j - 1], isf) > k; --j) {
+                vals[j] = vals[j - 1];
+            }
+            vals[j] = x;
+        }
+        return;
+    }
+
+    /* Histograms of every digit, computed in a single pass */
+    ks_size_t cts[8][256];
+    memset(cts, 0, sizeof(cts));
+    int d;
+    for (i = 0; i < n; ++i) {
+        ks_uint64_t k = s_rkey(vals[i], isf);
+        for (d = 0; d < 8; ++d) {
+            cts[d][(k >> (8 * d)) & 0xFF]++;
+        }
+    }
+
+    ks_uint64_t* tmp = ks_zmalloc(sizeof(*tmp), n);
+    ks_uint64_t* src = vals, *dst = tmp;
+    for (d = 0; d < 8; ++d) {
+        ks_size_t* ct = cts[d];
+        if (ct[(s_rkey(src[0], isf) >> (8 * d)) & 0xFF] == n) continue;
+
+        /* Turn counts into starting positions */
+        ks_size_t pos = 0, t;
+        for (j = 0; j < 256; ++j) {
+            t = ct[j];
+            ct[j] = pos;
+            pos += t;
+        }
+
+        for (i = 0; i < n; ++i) {
+            ks_uint64_t x = src[i];
+            dst[ct[(s_rkey(x, isf) >> (8 * d)) & 0xFF]++] = x;
+        }
+
+        ks_uint64_t* swp = src;
+        src = dst;
+        dst = swp;
+    }
+
+    if (src != vals) memcpy(vals, src, sizeof(*vals) * n);
+    ks_free(tmp);
+}
+
+static int s_cmp_ci(const void* L, const void* R) {
+    ks_cint a = *(const ks_cint*)L, b = *(const ks_cint*)R;
+    return (a > b) - (a < b);
+}
+
+bool ks_sort_ci(ks_size_t n, ks_cint* vals) {
+    if (sizeof(*vals) != sizeof(ks_uint64_t)) {
+        /* Equal integers are indistinguishable, so this need not be stable */
+        qsort(vals, n, sizeof(*vals), s_cmp_ci);
+        return true;
+    }
+
+    s_sort_raw(n, (ks_uint64_t*)vals, false);
+    return true;
+}
+
+bool ks_sort_cf(ks_size_t n, ks_cfloat* vals) {
+    assert(sizeof(*vals) == sizeof(ks_uint64_t));
+    s_sort_raw(n, (ks_uint64_t*)vals, true);
+    return true;
+}
+
+bool ks_sort(ks_size_t n, kso* elems, kso* keys, kso cmpfunc) {
+    return ks_sort_tim(n, elems, keys, cmpfunc);
+}
@@ -9,6 +9,213 @@
 
 #define T_NAME "Exception"
 
+/* Internal */
+
+/* Parse a conversion (just after the '%') the same way 'ksio_fmtv()' does, and return the conversion
+ *   character ('\0' if there was none)
+ * Sets '*ws' and '*ps' to whether the width and precision are arguments ('*')
+ */
+static char I_spec(const char** fmt, bool* ws, bool* ps) {
+    const char* f = *fmt;
+    while (*f == '+' || *f == '-' || *f == ' ' || *f == '0') f++;
+
+    if ((*ws = *f == '*')) f++;
+    else while ('0' <= *f && *f <= '9') f++;
+
+    *ps = false;
+    if (*f == '.') {
+        f++;
+        if ((*ps = *f == '*')) f++;
+        else while ('0' <= *f && *f <= '9') f++;
+    }
+
+    char c = *f;
+    if (c) f++;
+    *fmt = f;
+    return c;
+}
+
+/* Walk the arguments for 'fmt', and return whether they can all be snapshotted
+ * If 'self' is given, they are stored in it
+ */
+static bool I_snap(ks_Exception self, const char* fmt, va_list ap) {
+    int n = 0, w, p;
+    bool ws, ps;
+    kso obj;
+    char* ss;
+    while ((fmt = strchr(fmt, '%')) != NULL) {
+        fmt++;
+        char c = I_spec(&fmt, &ws, &ps);
+        if (c == '%') continue;
+        if (n >= KS_EXC_MAXFARGS) return false;
+
+        switch (c) {
+        case 'i':
+            w = va_arg(ap, int);
+            if (self) self->fargs[n].i = w;
+            break;
+        case 'l':
+            if (self) self->fargs[n].i = va_arg(ap, ks_cint);
+            else va_arg(ap, ks_cint);
+            break;
+        case 'f':
+            if (self) self->fargs[n].f = va_arg(ap, ks_cfloat);
+            else va_arg(ap, ks_cfloat);
+            break;
+        case 'p':
+            ss = va_arg(ap, void*);
+            if (self) self->fargs[n].u = (ks_uint)ss;
+            break;
+        case 'u':
+            if (self) self->fargs[n].u = va_arg(ap, ks_uint);
+            else va_arg(ap, ks_uint);
+            break;
+
+        case 'O':
+        case 'S':
+        case 'R':
+        case 'T':
+            obj = va_arg(ap, kso);
+            /* Objects being freed can't be held on to */
+            if (obj->refs <= 0) return false;
+            if (self) {
+                /* For '%T', only the type is needed */
+                if (c == 'T') obj = (kso)obj->type;
+                KS_INCREF(obj);
+                self->fargs[n].o = obj;
+            }
+            break;
+
+        /* Both are stored as the bytes they produce */
+        case 'c':
+        case 's':
+            w = ws ? va_arg(ap, int) : -1;
+            p = ps ? va_arg(ap, int) : -1;
+            if (c == 'c') {
+                w = va_arg(ap, int);
+                if (p < 0) p = 1;
+                if (self) {
+                    ss = ks_malloc(p + 1);
+                    memset(ss, w, p);
+                }
+            } else {
+                ss = va_arg(ap, char*);
+                if (p < 0) p = strlen(ss);
+                if (self) {
+                    char* cp = ks_malloc(p + 1);
+                    memcpy(cp, ss, p);
+                    ss = cp;
+                }
+            }
+            if (self) {
+                self->fargs[n].s.len = p;
+                self->fargs[n].s.data = ss;
+            }
+            break;
+
+        default:
+            /* '%J' refers to an array the caller owns, and anything else is an error that
+             *   'ksio_fmtv()' should report right away
+             */
+            return false;
+        }
+
+        n++;
+        if (self) self->n_fargs = n;
+    }
+
+    return true;
+}
+
+/* Release the snapshot of arguments */
+static void I_unsnap(ks_Exception self) {
+    const char* fmt = self->fmt;
+    bool ws, ps;
+    int n = 0;
+    while (n < self->n_fargs && (fmt = strchr(fmt, '%')) != NULL) {
+        fmt++;
+        char c = I_spec(&fmt, &ws, &ps);
+        if (c == 'O' || c == 'S' || c == 'R' || c == 'T') {
+            KS_DECREF(self->fargs[n].o);
+        } else if (c == 'c' || c == 's') {
+            ks_free(self->fargs[n].s.data);
+        }
+        if (c != '%') n++;
+    }
+    self->fmt = NULL;
+    self->n_fargs = 0;
+}
+
+/* Render the message from the snapshot
+ * Arguments that fail to convert are shown as a placeholder with their type
+ */
+static bool I_render(ksio_BaseIO io, ks_Exception self) {
+    const char* fmt = self->fmt;
+    char spec[32];
+    bool ws, ps;
+    int n = 0;
+    while (*fmt) {
+        const char* lit = fmt;
+        while (*fmt && *fmt != '%') fmt++;
+        if (!ksio_addbuf(io, fmt - lit, lit)) return false;
+        if (!*fmt) break;
+
+        const char* sp = fmt++;
+        char c = I_spec(&fmt, &ws, &ps);
+        if (c == '%') {
+            if (!ksio_addbuf(io, 1, "%")) return false;
+            continue;
+        }
+
+        /* Re-format a single argument with the same specifier */
+        int sl = fmt - sp;
+        if (sl >= sizeof(spec)) sl = sizeof(spec) - 1;
+        memcpy(spec, sp, sl);
+        spec[sl] = '\0';
+
+        bool ok = true;
+        switch (c) {
+        case 'i':
+            ok = ksio_add(io, spec, (int)self->fargs[n].i);
+            break;
+        case 'l':
+            ok = ksio_add(io, spec, self->fargs[n].i);
+            break;
+        case 'f':
+            ok = ksio_add(io, spec, self->fargs[n].f);
+            break;
+        case 'p':
+            ok = ksio_add(io, spec, (void*)self->fargs[n].u);
+            break;
+        case 'u':
+            ok = ksio_add(io, spec, self->fargs[n].u);
+            break;
+        case 'T':
+            ok = ksio_add(io, "%S", ((ks_type)self->fargs[n].o)->i__fullname);
+            break;
+        case 'O':
+        case 'S':
+        case 'R':
+            ok = ksio_add(io, spec, self->fargs[n].o);
+            if (!ok) {
+                /* Its conversion failed, so stand in for just this argument */
+                kso_catch_ignore();
+                ok = ksio_add(io, "<'%T' object>", self->fargs[n].o);
+            }
+            break;
+        case 'c':
+        case 's':
+            ok = ksio_addbuf(io, self->fargs[n].s.len, self->fargs[n].s.data);
+            break;
+        }
+        if (!ok) return false;
+        n++;
+    }
+
+    return true;
+}
+
+
 /* C-API */
 
 ks_Exception ks_Exception_new_c(ks_type tp, const char* cfile, const char* cfunc, int cline, const char* fmt, ...) {
@@ -21,20 +228,59 @@ ks_Exception ks_Exception_new_c(ks_type tp, const char* cfile, const char* cfunc
 
 ks_Exception ks_Exception_new_cv(ks_type tp, const char* cfile, const char* cfunc, int cline, const char* fmt, va_list ap) {
     assert(kso_issub(tp, kst_Exception));
-    ks_str what = ks_fmtv(fmt, ap);
-    if (!what) return NULL;
+
+    /* Check the arguments on a copy, since they may need to be formatted right away */
+    va_list cp;
+    va_copy(cp, ap);
+    bool snap = fmt && I_snap(NULL, fmt, cp);
+    va_end(cp);
+
+    ks_str what = NULL;
+    if (!snap) {
+        what = ks_fmtv(fmt, ap);
+        if (!what) return NULL;
+    }
 
     ks_Exception self = KSO_NEW(ks_Exception, tp);
 
     self->inner = NULL;
     self->frames = ks_list_new(0, NULL);
+    self->n_pend = -1;
 
     self->args = ks_list_new(0, NULL);
     self->what = what;
 
+    self->n_fargs = 0;
+    if (snap) {
+        self->fmt = fmt;
+        I_snap(self, fmt, ap);
+    } else {
+        self->fmt = NULL;
+    }
+
     return self;
 }
 
+ks_str ks_Exception_what(ks_Exception self) {
+    if (!self->what) {
+        /* Conversions may run kscript code (i.e. '__repr'), so keep any exception in flight out of their way */
+        ksos_thread th = ksos_thread_get();
+        ks_Exception exc = th->exc;
+        th->exc = NULL;
+
+        ksio_StringIO sio = ksio_StringIO_new();
+        if (self->fmt && !I_render((ksio_BaseIO)sio, self)) {
+            /* Keep what was rendered before the stream failed */
+            kso_catch_ignore();
+        }
+        self->what = ksio_StringIO_getf(sio);
+        I_unsnap(self);
+
+        th->exc = exc;
+    }
+
+    return (ks_str)KS_NEWREF(self->what);
+}
 
 
 /* Type Functions */
@@ -46,6 +292,7 @@ static KS_TFUNC(T, init) {
 
     self->inner = NULL;
     self->frames = ks_list_new(0, NULL);
+    self->n_pend = -1;
     if (what) {
         KS_INCREF(what);
         self->what = what;
@@ -64,6 +311,7 @@ static KS_TFUNC(T, free) {
     KS_NDECREF(self->frames);
     KS_NDECREF(self->args);
     KS_NDECREF(self->what);
+    if (self->fmt) I_unsnap(self);
 
     if (self->inner) KS_DECREF(self->inner);
 
@@ -76,14 +324,17 @@ static KS_TFUNC(T, str) {
     ks_Exception self;
     KS_ARGS("self:*", &self, kst_Exception);
 
-    return KS_NEWREF(self->what);
+    return (kso)ks_Exception_what(self);
 }
 
 static KS_TFUNC(T, repr) {
     ks_Exception self;
     KS_ARGS("self:*", &self, kst_Exception);
 
-    return (kso)ks_fmt("%T(%R, %R, %R, %R)", self, self->what, self->args, self->frames, self->inner ? (kso)self->inner : KSO_NONE);
+    ks_str what = ks_Exception_what(self);
+    kso res = (kso)ks_fmt("%T(%R, %R, %R, %R)", self, what, self->args, self->frames, self->inner ? (kso)self->inner : KSO_NONE);
+    KS_DECREF(what);
+    return res;
 }
 
 /* Export */
@@ -0,0 +1,433 @@
+/* types/bytearray.c - 'bytearray' type
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+
+#define T_NAME "bytearray"
+
+
+/* Internals */
+
+/* Ensure 'self' has room for 'len_b' bytes */
+static void s_reserve(ks_bytearray self, ks_ssize_t len_b) {
+    if (len_b > self->max_len_b) {
+        self->max_len_b = ks_nextsize(self->max_len_b, len_b);
+        self->data = ks_realloc(self->data, self->max_len_b);
+    }
+}
+
+/* Check that 'self' may change size */
+static bool s_check_resize(ks_bytearray self) {
+    if (self->n_views > 0) {
+        KS_THROW(kst_SizeError, "Cannot resize '%T' object while it has memoryviews", self);
+        return false;
+    }
+    return true;
+}
+
+/* Convert 'ob' to a single byte */
+static bool s_get_byte(kso ob, unsigned char* val) {
+    ks_cint v;
+    if (!kso_get_ci(ob, &v)) return false;
+    if (v < 0 || v > 255) {
+        KS_THROW(kst_ValError, "Byte values must be in range(256), but got %l", v);
+        return false;
+    }
+    *val = v;
+    return true;
+}
+
+/* Append the contents of 'ob', which may be bytes-like or an iterable of 'int' */
+static bool s_extend(ks_bytearray self, kso ob) {
+    unsigned char* data;
+    ks_ssize_t len_b;
+    if (kso_is_buf(ob)) {
+        if (!kso_get_buf(ob, false, &data, &len_b)) return false;
+        return ks_bytearray_push(self, len_b, data);
+    }
+
+    ks_list elems = ks_list_newi(ob);
+    if (!elems) return false;
+
+    if (!s_check_resize(self)) {
+        KS_DECREF(elems);
+        return false;
+    }
+    s_reserve(self, self->len_b + elems->len);
+
+    ks_cint i;
+    for (i = 0; i < elems->len; ++i) {
+        if (!s_get_byte(elems->elems[i], &self->data[self->len_b + i])) {
+            KS_DECREF(elems);
+            return false;
+        }
+    }
+    self->len_b += elems->len;
+    KS_DECREF(elems);
+    return true;
+}
+
+
+/* C-API */
+
+ks_bytearray ks_bytearray_new(ks_type tp, ks_ssize_t len_b, const void* data) {
+    ks_bytearray self = KSO_NEW(ks_bytearray, tp);
+
+    self->len_b = 0;
+    self->max_len_b = 0;
+    self->n_views = 0;
+    self->data = NULL;
+
+    s_reserve(self, len_b);
+    if (data) {
+        memcpy(self->data, data, len_b);
+    } else {
+        memset(self->data, 0, len_b);
+    }
+    self->len_b = len_b;
+
+    return self;
+}
+
+bool ks_bytearray_resize(ks_bytearray self, ks_ssize_t len_b) {
+    if (len_b == self->len_b) return true;
+    if (!s_check_resize(self)) return false;
+
+    s_reserve(self, len_b);
+    if (len_b > self->len_b) {
+        memset(self->data + self->len_b, 0, len_b - self->len_b);
+    }
+    self->len_b = len_b;
+    return true;
+}
+
+bool ks_bytearray_push(ks_bytearray self, ks_ssize_t len_b, const void* data) {
+    if (!s_check_resize(self)) return false;
+
+    /* 'data' may point into 'self', so save its offset in case of reallocation */
+    ks_ssize_t off = (const unsigned char*)data - self->data;
+    bool inside = self->data && off >= 0 && off < self->len_b;
+
+    s_reserve(self, self->len_b + len_b);
+    memcpy(self->data + self->len_b, inside ? self->data + off : data, len_b);
+    self->len_b += len_b;
+    return true;
+}
+
+bool ks_bytearray_splice(ks_bytearray self, ks_ssize_t pos, ks_ssize_t len_b, ks_ssize_t sz_b, const void* data) {
+    if (sz_b == len_b) {
+        memmove(self->data + pos, data, sz_b);
+        return true;
+    }
+    if (!s_check_resize(self)) return false;
+
+    /* Copy first, since 'data' may be part of 'self' */
+    void* tmp = ks_malloc(sz_b);
+    memcpy(tmp, data, sz_b);
+
+    ks_ssize_t new_len_b = self->len_b - len_b + sz_b;
+    s_reserve(self, new_len_b);
+    memmove(self->data + pos + sz_b, self->data + pos + len_b, self->len_b - pos - len_b);
+    memcpy(self->data + pos, tmp, sz_b);
+    self->len_b = new_len_b;
+
+    ks_free(tmp);
+    return true;
+}
+
+
+/* Type Functions */
+
+static KS_TFUNC(T, free) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    ks_free(self->data);
+
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, new) {
+    ks_type tp;
+    kso obj = KSO_NONE;
+    KS_ARGS("tp:* ?obj", &tp, kst_type, &obj);
+
+    if (obj == KSO_NONE) {
+        return (kso)ks_bytearray_new(tp, 0, NULL);
+    } else if (KS_TYPE_HAS(obj->type, KS_TF_INT)) {
+        /* Zero-filled of a given size */
+        ks_cint sz;
+        if (!kso_get_ci(obj, &sz)) return NULL;
+        if (sz < 0) {
+            KS_THROW(kst_SizeError, "Negative size %l", sz);
+            return NULL;
+        }
+        return (kso)ks_bytearray_new(tp, sz, NULL);
+    }
+
+    ks_bytearray self = ks_bytearray_new(tp, 0, NULL);
+    if (!s_extend(self, obj)) {
+        KS_DECREF(self);
+        return NULL;
+    }
+
+    return (kso)self;
+}
+
+static KS_TFUNC(T, bytes) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    return (kso)ks_bytes_new(self->len_b, (char*)self->data);
+}
+
+static KS_TFUNC(T, repr) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    ks_bytes b = ks_bytes_new(self->len_b, (char*)self->data);
+    ks_str res = ks_fmt("%T(%R)", self, b);
+    KS_DECREF(b);
+    return (kso)res;
+}
+
+static KS_TFUNC(T, bool) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    return KSO_BOOL(self->len_b != 0);
+}
+
+static KS_TFUNC(T, len) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    return (kso)ks_int_new(self->len_b);
+}
+
+static KS_TFUNC(T, eq) {
+    kso L, R;
+    KS_ARGS("L R", &L, &R);
+
+    unsigned char *dL, *dR;
+    ks_ssize_t nL, nR;
+    if (kso_is_buf(L) && kso_is_buf(R) && !KS_TYPE_HAS(L->type, KS_TF_STR) && !KS_TYPE_HAS(R->type, KS_TF_STR)) {
+        if (!kso_get_buf(L, false, &dL, &nL) || !kso_get_buf(R, false, &dR, &nR)) return NULL;
+        return KSO_BOOL(nL == nR && memcmp(dL, dR, nL) == 0);
+    }
+
+    return KSO_UNDEFINED;
+}
+
+static KS_TFUNC(T, add) {
+    kso L, R;
+    KS_ARGS("L R", &L, &R);
+
+    unsigned char *dL, *dR;
+    ks_ssize_t nL, nR;
+    if (kso_is_buf(L) && kso_is_buf(R) && !KS_TYPE_HAS(L->type, KS_TF_STR) && !KS_TYPE_HAS(R->type, KS_TF_STR)) {
+        if (!kso_get_buf(L, false, &dL, &nL) || !kso_get_buf(R, false, &dR, &nR)) return NULL;
+        ks_bytearray res = ks_bytearray_new(kso_issub(L->type, kst_bytearray) ? L->type : R->type, nL + nR, NULL);
+        memcpy(res->data, dL, nL);
+        memcpy(res->data + nL, dR, nR);
+        return (kso)res;
+    }
+
+    return KSO_UNDEFINED;
+}
+
+static KS_TFUNC(T, getelem) {
+    ks_bytearray self;
+    kso idx;
+    KS_ARGS("self:* idx", &self, kst_bytearray, &idx);
+
+    if (kso_issub(idx->type, kst_slice)) {
+        ks_cint first, last, delta;
+        if (!ks_slice_get_citer((ks_slice)idx, self->len_b, &first, &last, &delta)) return NULL;
+
+        ks_bytearray res = ks_bytearray_new(self->type, 0, NULL);
+        if (delta == 1) {
+            ks_bytearray_push(res, last - first, self->data + first);
+        } else {
+            ks_cint i;
+            for (i = first; i != last; i += delta) {
+                ks_bytearray_push(res, 1, self->data + i);
+            }
+        }
+        return (kso)res;
+    }
+
+    ks_cint i;
+    if (!kso_get_ci(idx, &i)) return NULL;
+    if (i < 0) i += self->len_b;
+    if (i < 0 || i >= self->len_b) {
+        KS_THROW_INDEX(self, idx);
+        return NULL;
+    }
+
+    return (kso)ks_int_new(self->data[i]);
+}
+
+static KS_TFUNC(T, setelem) {
+    ks_bytearray self;
+    kso idx, val;
+    KS_ARGS("self:* idx val", &self, kst_bytearray, &idx, &val);
+
+    if (kso_issub(idx->type, kst_slice)) {
+        ks_cint first, last, delta;
+        if (!ks_slice_get_citer((ks_slice)idx, self->len_b, &first, &last, &delta)) return NULL;
+
+        /* Keep 'val' alive, as it may be converted */
+        ks_bytearray tmp = NULL;
+        unsigned char* data;
+        ks_ssize_t len_b;
+        if (kso_is_buf(val)) {
+            if (!kso_get_buf(val, false, &data, &len_b)) return NULL;
+        } else {
+            tmp = ks_bytearray_new(kst_bytearray, 0, NULL);
+            if (!s_extend(tmp, val)) {
+                KS_DECREF(tmp);
+                return NULL;
+            }
+            data = tmp->data;
+            len_b = tmp->len_b;
+        }
+
+        bool ok = true;
+        if (delta == 1 || first == last) {
+            if (last < first) last = first;
+            ok = ks_bytearray_splice(self, first, last - first, len_b, data);
+        } else {
+            ks_cint i, j, n = (last - first) / delta;
+            if (n != len_b) {
+                KS_THROW(kst_SizeError, "Attempted to assign %l bytes to extended slice of size %l", (ks_cint)len_b, n);
+                ok = false;
+            } else {
+                for (i = first, j = 0; i != last; i += delta, ++j) {
+                    self->data[i] = data[j];
+                }
+            }
+        }
+
+        if (tmp) KS_DECREF(tmp);
+        if (!ok) return NULL;
+        return KSO_NONE;
+    }
+
+    ks_cint i;
+    if (!kso_get_ci(idx, &i)) return NULL;
+    if (i < 0) i += self->len_b;
+    if (i < 0 || i >= self->len_b) {
+        KS_THROW_INDEX(self, idx);
+        return NULL;
+    }
+    if (!s_get_byte(val, &self->data[i])) return NULL;
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, push) {
+    ks_bytearray self;
+    int nargs;
+    kso* args;
+    KS_ARGS("self:* *args", &self, kst_bytearray, &nargs, &args);
+
+    int i;
+    for (i = 0; i < nargs; ++i) {
+        unsigned char c;
+        if (!s_get_byte(args[i], &c)) return NULL;
+        if (!ks_bytearray_push(self, 1, &c)) return NULL;
+    }
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, pop) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    if (self->len_b == 0) {
+        KS_THROW(kst_SizeError, "Cannot pop from empty '%T'", self);
+        return NULL;
+    }
+    if (!s_check_resize(self)) return NULL;
+
+    return (kso)ks_int_new(self->data[--self->len_b]);
+}
+
+static KS_TFUNC(T, extend) {
+    ks_bytearray self;
+    kso objs;
+    KS_ARGS("self:* objs", &self, kst_bytearray, &objs);
+
+    if (!s_extend(self, objs)) return NULL;
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, clear) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    if (!ks_bytearray_resize(self, 0)) return NULL;
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, resize) {
+    ks_bytearray self;
+    ks_cint sz;
+    KS_ARGS("self:* sz:cint", &self, kst_bytearray, &sz);
+
+    if (sz < 0) {
+        KS_THROW(kst_SizeError, "Negative size %l", sz);
+        return NULL;
+    }
+    if (!ks_bytearray_resize(self, sz)) return NULL;
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, decode) {
+    ks_bytearray self;
+    KS_ARGS("self:*", &self, kst_bytearray);
+
+    if (!ks_str_isutf8(self->len_b, (char*)self->data)) {
+        KS_THROW(kst_ValError, "Invalid UTF-8 in '%T' object", self);
+        return NULL;
+    }
+
+    return (kso)ks_str_new(self->len_b, (char*)self->data);
+}
+
+
+/* Export */
+
+static struct ks_type_s tp;
+ks_type kst_bytearray = &tp;
+
+void _ksi_bytearray() {
+    _ksinit(kst_bytearray, kst_object, T_NAME, sizeof(struct ks_bytearray_s), -1, "Sequence of bytes ('int' in range(256)), which is mutable. Appending is amortized constant time\n\n    While a 'memoryview' of it exists, it may be modified but not resized", KS_IKV(
+        {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
+        {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, obj=none)", "")},
+        {"__repr",               ksf_wrap(T_repr_, T_NAME ".__repr(self)", "")},
+        {"__str",                ksf_wrap(T_repr_, T_NAME ".__str(self)", "")},
+        {"__bytes",              ksf_wrap(T_bytes_, T_NAME ".__bytes(self)", "")},
+        {"__bool",               ksf_wrap(T_bool_, T_NAME ".__bool(self)", "")},
+        {"__len",                ksf_wrap(T_len_, T_NAME ".__len(self)", "")},
+        {"__eq",                 ksf_wrap(T_eq_, T_NAME ".__eq(L, R)", "")},
+        {"__add",                ksf_wrap(T_add_, T_NAME ".__add(L, R)", "")},
+        {"__getelem",            ksf_wrap(T_getelem_, T_NAME ".__getelem(self, idx)", "")},
+        {"__setelem",            ksf_wrap(T_setelem_, T_NAME ".__setelem(self, idx, val)", "")},
+
+        {"push",                 ksf_wrap(T_push_, T_NAME ".push(self, *args)", "Append bytes (given as 'int's) to the end")},
+        {"pop",                  ksf_wrap(T_pop_, T_NAME ".pop(self)", "Remove and return the last byte")},
+        {"extend",               ksf_wrap(T_extend_, T_NAME ".extend(self, objs)", "Append the contents of a bytes-like object, or an iterable of 'int's")},
+        {"clear",                ksf_wrap(T_clear_, T_NAME ".clear(self)", "Remove all bytes")},
+        {"resize",               ksf_wrap(T_resize_, T_NAME ".resize(self, sz)", "Change the size, filling new bytes with zeros")},
+        {"decode",               ksf_wrap(T_decode_, T_NAME ".decode(self)", "Decode into a string")},
+    ));
+}
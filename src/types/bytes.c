@@ -16,7 +16,7 @@ ks_bytes ks_bytes_newnt(ks_type tp, ks_ssize_t len_b, char* data) {
     
     self->len_b = len_b;
     self->data = data;
-    self->v_hash = ks_hash_bytes(len_b, data);
+    self->has_hash = false;
 
     return self;
 }
@@ -38,11 +38,63 @@ ks_bytes ks_bytes_newn(ks_ssize_t len_b, char* data) {
     
     self->len_b = len_b;
     self->data = data;
-    self->v_hash = ks_hash_bytes(len_b, data);
+    self->has_hash = false;
 
     return self;
 }
 
+ks_bytes ks_bytes_sub(ks_bytes self, ks_ssize_t off_b, ks_ssize_t len_b) {
+    ks_bytes base = self->_base ? self->_base : self;
+    if (len_b < KS_STR_VIEW_MIN || 2 * len_b < base->len_b) {
+        return ks_bytes_new(len_b, (char*)self->data + off_b);
+    }
+
+    ks_bytes res = ks_bytes_newn(len_b, (char*)self->data + off_b);
+    KS_INCREF(base);
+    res->_base = base;
+    return res;
+}
+
+ks_bytes ks_bytes_cat(ks_bytes L, ks_bytes R) {
+    char* data = ks_malloc(L->len_b + R->len_b);
+    memcpy(data, L->data, L->len_b);
+    memcpy(data + L->len_b, R->data, R->len_b);
+    return ks_bytes_newn(L->len_b + R->len_b, data);
+}
+
+void _ks_bytes_append(ks_bytes self, ks_bytes other) {
+    ks_size_t len_b = self->len_b + other->len_b;
+
+    if (self->_grow) {
+        /* Capacity is the next power of two, so this reallocates O(log(N)) times */
+        if (ks_nextpow2(len_b) > ks_nextpow2(self->len_b)) {
+            self->data = ks_realloc(self->data, ks_nextpow2(len_b));
+        }
+    } else {
+        /* Move to a buffer that can grow */
+        unsigned char* data = ks_malloc(ks_nextpow2(len_b));
+        memcpy(data, self->data, self->len_b);
+        if (self->_base) {
+            KS_DECREF(self->_base);
+            self->_base = NULL;
+        } else {
+            ks_free(self->data);
+        }
+        self->data = data;
+        self->_grow = true;
+    }
+
+    memcpy(self->data + self->len_b, other->data, other->len_b);
+    self->len_b = len_b;
+    self->has_hash = false;
+}
+
+ks_hash_t _ks_bytes_hash(ks_bytes self) {
+    self->v_hash = ks_hash_bytes(self->len_b, self->data);
+    self->has_hash = true;
+    return self->v_hash;
+}
+
 ks_bytes ks_bytes_newo(ks_type tp, kso obj) {
     if (kso_issub(obj->type, tp)) return (ks_bytes)KS_NEWREF(obj);
 
@@ -65,7 +117,11 @@ static KS_TFUNC(T, free) {
     ks_bytes self;
     KS_ARGS("self:*", &self, kst_bytes);
 
-    ks_free(self->data);
+    if (self->_base) {
+        KS_DECREF(self->_base);
+    } else {
+        ks_free(self->data);
+    }
 
     KSO_DEL(self);
 
@@ -92,11 +148,38 @@ static KS_TFUNC(T, decode) {
     KS_ARGS("self:*", &self, kst_bytes);
 
     /* TODO; other encodings */
+    if (!ks_str_isutf8(self->len_b, (const char*)self->data)) {
+        KS_THROW(kst_ValError, "Invalid UTF-8 in 'bytes' object");
+        return NULL;
+    }
 
     return (kso)ks_str_new(self->len_b, self->data);
 }
 
 
+static KS_TFUNC(T, add) {
+    kso L, R;
+    KS_ARGS("L R", &L, &R);
+
+    if (KS_TYPE_HAS(L->type, KS_TF_BYTES) && KS_TYPE_HAS(R->type, KS_TF_BYTES)) {
+        return (kso)ks_bytes_cat((ks_bytes)L, (ks_bytes)R);
+    }
+
+    return KSO_UNDEFINED;
+}
+
+static KS_TFUNC(T, eq) {
+    kso L, R;
+    KS_ARGS("L R", &L, &R);
+
+    if (KS_TYPE_HAS(L->type, KS_TF_BYTES) && KS_TYPE_HAS(R->type, KS_TF_BYTES)) {
+        ks_bytes bL = (ks_bytes)L, bR = (ks_bytes)R;
+        return KSO_BOOL(L == R || (bL->len_b == bR->len_b && memcmp(bL->data, bR->data, bL->len_b) == 0));
+    }
+
+    return KSO_UNDEFINED;
+}
+
 static KS_TFUNC(T, bool) {
     ks_bytes self;
     KS_ARGS("self:*", &self, kst_bytes);
@@ -120,6 +203,8 @@ void _ksi_bytes() {
     _ksinit(kst_bytes, kst_object, T_NAME, sizeof(struct ks_bytes_s), -1, "Sequence of bytes ('int' in range(256)), which is immutable. Similar to a 'str' but has no notion of 'codepoints' or 'characters'", KS_IKV(
         {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
         {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, obj)", "")},
+        {"__add",                ksf_wrap(T_add_, T_NAME ".__add(L, R)", "")},
+        {"__eq",                 ksf_wrap(T_eq_, T_NAME ".__eq(L, R)", "")},
         {"__bool",               ksf_wrap(T_bool_, T_NAME ".__bool(self)", "")},
         {"__len",                ksf_wrap(T_len_, T_NAME ".__len(self)", "")},
         {"decode",               ksf_wrap(T_decode_, T_NAME ".decode(self)", "Decode into a string")},
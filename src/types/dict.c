@@ -22,8 +22,13 @@
 /* New/target load factor for rehashing */
 #define S_LOAD_NEW       (0.3)
 
-/* Maximum proportion of holes in the entries array. Once the ratio exceeds this, holes are filled */
-#define S_HOLES_MAX      (0.5)
+/* Number of bits of the hash shifted into the probe sequence each step */
+#define S_PERTURB_SHIFT  5
+
+/* Extra probes allowed beyond the number of buckets (one per 'S_PERTURB_SHIFT' bits in the hash,
+ *   after which the probe sequence is guaranteed to be a full cycle)
+ */
+#define S_PERTURB_TRIES  (1 + 8 * sizeof(ks_hash_t) / S_PERTURB_SHIFT)
 
 
 /* Template to conditionally execute different code based on size 
@@ -69,16 +74,32 @@ static double s_load(ks_dict self) {
  */
 static bool s_search(ks_dict self, kso key, ks_hash_t hash, ks_ssize_t* rb, ks_ssize_t* re) {
     if (self->len_buckets <= 0) {
-        /* no elements, but avoid modulo by 0 */
+        /* Small dictionary, with no buckets, so search the entries linearly */
         *rb = *re = -1;
+
+        ks_size_t i;
+        for (i = 0; i < self->len_ents; ++i) {
+            struct ks_dict_ent* ent = &self->ents[i];
+            if (ent->key && ent->hash == hash) {
+                bool is_eq = ent->key == key;
+                if (!is_eq && !kso_eq(ent->key, key, &is_eq)) return false;
+
+                if (is_eq) {
+                    *re = i;
+                    return true;
+                }
+            }
+        }
+
         return true;
     }
 
-    /* Calculate bucket index based on hash */
-    ks_size_t bi = hash % self->len_buckets;
+    /* Calculate bucket index based on hash ('len_buckets' is always a power of two) */
+    ks_size_t mask = self->len_buckets - 1;
+    ks_size_t bi = hash & mask;
 
-    /* First bucket index, and number of tries thus far */
-    ks_size_t bi0 = bi, tries = 0;
+    /* Higher bits of the hash, which are shifted in while probing, and number of tries thus far */
+    ks_size_t perturb = hash, tries = 0;
 
     do {
         /* Element index (>=0 means valid, < 0 means special case) */
@@ -115,48 +136,59 @@ static bool s_search(ks_dict self, kso key, ks_hash_t hash, ks_ssize_t* rb, ks_s
 
         /* Probe for the next bucket in the hash table
          *
-         * For now, we use linear probing
+         * We use the perturbed probe sequence (from CPython), which mixes in the upper bits of the hash
+         *   so that keys which agree on their lower bits don't cluster. Once 'perturb' is zero, it
+         *   is the recurrence 'bi = 5 * bi + 1 (mod 2**k)', which visits every bucket
          */
-        bi = (bi + 1) % self->len_buckets;
+        perturb >>= S_PERTURB_SHIFT;
+        bi = (5 * bi + 1 + perturb) & mask;
 
-    } while (bi != bi0);
+    } while (++tries <= self->len_buckets + S_PERTURB_TRIES);
 
     /* Not found, and no room to insert, so signal that */
     *rb = *re = -1;
-    return -1;
+    return true;
 }
 
-/* Fill holes in the entries array of 'self'
+/* Fill holes (deleted entries) in the entries array of 'self', keeping the order of insertion
  *
- * Returns true if the operation completed, false if an error was thrown
+ * NOTE: This invalidates any buckets, so they must be rebuilt afterwards
  */
-static bool s_fill_holes(ks_dict self) {
-
-    if (self->len_ents <= self->len_real || self->len_ents <= 0) return true;
-
-    ks_ssize_t* em = ks_zmalloc(self->len_ents, sizeof(*em));
-    if (!em) {
-        //KS_THROW_OUTOFMEM();
-        return false;
-    }
+static void s_fill_holes(ks_dict self) {
+    if (self->len_ents <= self->len_real) return;
 
-    /* Calculate index translation map for the entries */
     ks_size_t i, j = 0;
-
     for (i = 0; i < self->len_ents; ++i) {
-        em[i] = j;
-        if (self->ents[i].key != NULL) j++;
+        if (self->ents[i].key) self->ents[j++] = self->ents[i];
     }
 
+    assert(j == self->len_real);
+    self->len_ents = j;
+}
 
-    /* Replace current indices with new indices */
-    for (i = 0; i < self->len_ents; ++i) self->ents[em[i]] = self->ents[i];
-    S_T_SIZE(self, self->len_ents,
-        for (i = 0; i < self->len_buckets; ++i) if (__buckets[i] >= 0)
-            __buckets[i] = em[__buckets[i]];
-    );
+/* Ensure there is room for at least 'len' entries
+ *
+ * Returns true if the operation completed, false if an error was thrown
+ */
+static bool s_reserve(ks_dict self, ks_size_t len) {
+    if (len <= self->_max_len_ents) return true;
+
+    ks_size_t new_max = ks_nextsize(self->_max_len_ents, len);
+    struct ks_dict_ent* new_ents;
+    if (self->ents == self->_small_ents) {
+        /* Move out of the inline entries */
+        new_ents = ks_zmalloc(sizeof(*new_ents), new_max);
+        if (new_ents) memcpy(new_ents, self->ents, sizeof(*new_ents) * self->len_ents);
+    } else {
+        new_ents = ks_zrealloc(self->ents, sizeof(*new_ents), new_max);
+    }
+    if (!new_ents) {
+        KS_THROW(kst_SizeError, "Failed to allocate %l entries for dictionary", (ks_cint)new_max);
+        return false;
+    }
 
-    ks_free(em);
+    self->ents = new_ents;
+    self->_max_len_ents = new_max;
     return true;
 }
 
@@ -165,11 +197,18 @@ static bool s_fill_holes(ks_dict self) {
  * Returns true if the operation completed, false if an error was thrown
  */
 static bool s_resize(ks_dict self, ks_size_t new_len_buckets) {
-    new_len_buckets = ks_nextprime(new_len_buckets);
-    if (self->len_buckets >= new_len_buckets) return true;
+    new_len_buckets = ks_nextpow2(new_len_buckets);
+    if (self->len_buckets >= new_len_buckets) {
+        /* Already large enough, but rehash in place if there are deleted entries to reclaim */
+        if (self->len_ents == self->len_real) return true;
+        new_len_buckets = self->len_buckets;
+    }
 
     ks_size_t i;
 
+    /* Remove deleted entries before building the new buckets, since their indices would change */
+    s_fill_holes(self);
+
     /* Calculate required size of buckets array */
     ks_size_t new_bucket_sz = 0;
     S_T_SIZE(self, self->len_ents, 
@@ -210,7 +249,7 @@ static bool s_resize(ks_dict self, ks_size_t new_len_buckets) {
     }
     
     assert(self->len_real == ct);
-    return self->len_ents * S_HOLES_MAX >= self->len_real ? s_fill_holes(self) : true;
+    return true;
 }
 
 /* C-API */
@@ -222,17 +261,19 @@ ks_dict ks_dict_newt(ks_type tp, struct ks_ikv* ikv) {
     self->refs = 1;
 
     self->len_buckets = self->len_ents = self->len_real = 0;
-    self->_max_len_buckets_b = self->_max_len_ents = 0;
+    self->_max_len_buckets_b = 0;
 
-    self->ents = NULL;
+    /* Start out small, with only the inline entries */
+    self->ents = self->_small_ents;
+    self->_max_len_ents = KS_DICT_SMALL;
     self->buckets_s8 = NULL;
 
     /* Initialize elements */
     if (ikv) {
         struct ks_ikv* p = ikv;
         while (p->key) {
-            ks_str k = ks_str_new(-1, p->key);
-            ks_dict_set_h(self, (kso)k, k->v_hash, p->val);
+            ks_str k = ks_str_intern_c(-1, p->key);
+            ks_dict_set_h(self, (kso)k, KS_STR_HASH(k), p->val);
             KS_DECREF(k);
             p++;
         }
@@ -248,17 +289,19 @@ ks_dict ks_dict_new(struct ks_ikv* ikv) {
     self->refs = 1;
 
     self->len_buckets = self->len_ents = self->len_real = 0;
-    self->_max_len_buckets_b = self->_max_len_ents = 0;
+    self->_max_len_buckets_b = 0;
 
-    self->ents = NULL;
+    /* Start out small, with only the inline entries */
+    self->ents = self->_small_ents;
+    self->_max_len_ents = KS_DICT_SMALL;
     self->buckets_s8 = NULL;
 
     /* Initialize elements */
     if (ikv) {
         struct ks_ikv* p = ikv;
         while (p->key) {
-            ks_str k = ks_str_new(-1, p->key);
-            ks_dict_set_h(self, (kso)k, k->v_hash, p->val);
+            ks_str k = ks_str_intern_c(-1, p->key);
+            ks_dict_set_h(self, (kso)k, KS_STR_HASH(k), p->val);
             KS_DECREF(k);
             p++;
         }
@@ -281,6 +324,14 @@ ks_dict ks_dict_newkv(int nargs, kso* args) {
 
     assert(nargs % 2 == 0);
     int i;
+
+    /* Size the table up front, if it won't fit inline */
+    if (nargs / 2 > KS_DICT_SMALL) {
+        if (!s_reserve(res, nargs / 2) || !s_resize(res, (ks_size_t)(nargs / 2 / S_LOAD_NEW))) {
+            KS_DECREF(res);
+            return NULL;
+        }
+    }
     for (i = 0; i < nargs; i += 2) {
         if (!ks_dict_set(res, args[i], args[i+1])) {
             KS_DECREF(res);
@@ -302,7 +353,7 @@ void ks_dict_clear(ks_dict self) {
         }
     }
 
-    self->len_ents = 0;
+    self->len_ents = self->len_real = 0;
     self->len_buckets = 0;
 }
 
@@ -328,11 +379,11 @@ bool ks_dict_merge_ikv(ks_dict self, struct ks_ikv* ikv) {
 
         /* If there was a valid dictionary to modify. Otherwise, keep going */
         if (res) {
-            ks_str key = ks_str_new(-1, it->key);
+            ks_str key = ks_str_intern_c(-1, it->key);
             assert(key != NULL);
             kso val = it->val;
             assert(val != NULL);
-            bool had_err = !ks_dict_set_h(self, (kso)key, key->v_hash, val);
+            bool had_err = !ks_dict_set_h(self, (kso)key, KS_STR_HASH(key), val);
 
             /* This function works by taking the references from the list of elements */
             KS_DECREF(key);
@@ -385,8 +436,8 @@ kso ks_dict_get_ih(ks_dict self, kso key, ks_hash_t hash) {
 }
 
 kso ks_dict_get_c(ks_dict self, const char* ckey) {
-    ks_str key = ks_str_new(-1, ckey);
-    kso res = ks_dict_get_h(self, (kso)key, key->v_hash);
+    ks_str key = ks_str_intern_c(-1, ckey);
+    kso res = ks_dict_get_h(self, (kso)key, KS_STR_HASH(key));
     KS_DECREF(key);
     return res;
 }
@@ -397,15 +448,15 @@ bool ks_dict_set(ks_dict self, kso key, kso val) {
     return ks_dict_set_h(self, key, hash, val);
 }
 bool ks_dict_set_c1(ks_dict self, const char* ckey, kso val) {
-    ks_str key = ks_str_new(-1, ckey);
-    bool res = ks_dict_set_h(self, (kso)key, key->v_hash, val);
+    ks_str key = ks_str_intern_c(-1, ckey);
+    bool res = ks_dict_set_h(self, (kso)key, KS_STR_HASH(key), val);
     KS_DECREF(key);
     KS_DECREF(val);
     return res;
 }
 bool ks_dict_set_c(ks_dict self, const char* ckey, kso val) {
-    ks_str key = ks_str_new(-1, ckey);
-    bool res = ks_dict_set_h(self, (kso)key, key->v_hash, val);
+    ks_str key = ks_str_intern_c(-1, ckey);
+    bool res = ks_dict_set_h(self, (kso)key, KS_STR_HASH(key), val);
     KS_DECREF(key);
     return res;
 }
@@ -413,57 +464,64 @@ bool ks_dict_set_h(ks_dict self, kso key, ks_hash_t hash, kso val) {
     ks_ssize_t rb, re;
 
     /* Resize if needed */
-    if (s_load(self) > S_LOAD_MAX || self->len_buckets == 0)
-        if (!s_resize(self, (ks_size_t)(self->len_ents / S_LOAD_NEW)))
+    if (self->len_buckets > 0 && s_load(self) > S_LOAD_MAX)
+        if (!s_resize(self, (ks_size_t)(self->len_real / S_LOAD_NEW)))
             return false;
 
     if (!s_search(self, key, hash, &rb, &re)) return false;
 
-    if (re < 0) {
-        /* Not found, so add to the dictionary*/
-        
-        re = self->len_ents++;
-        if (self->len_ents > self->_max_len_ents) {
-            self->_max_len_ents = ks_nextsize(self->_max_len_ents, self->len_ents);
-            self->ents = ks_zrealloc(self->ents, sizeof(*self->ents), self->_max_len_ents);
-        }
-
-        /* Add to entries */
-        self->len_real++;
-        
-        KS_INCREF(key);
+    if (re >= 0) {
+        /* Found, so replace value*/
         KS_INCREF(val);
-        
-        self->ents[re].hash = hash;
-        self->ents[re].key = key;
+        KS_DECREF(self->ents[re].val);
         self->ents[re].val = val;
+        return true;
+    }
 
-        /* Add buckets if needed */
-        if (rb < 0 || (self->len_ents == KS_SINT8_MAX || self->len_ents == KS_SINT16_MAX || self->len_ents == KS_SINT32_MAX)) {
-            /* No bucket found, we need to resize/fill holes */
-            if (!s_resize(self, (ks_size_t)(self->len_ents / S_LOAD_NEW)))
-                return false;
+    /* Not found, so add to the dictionary */
+    if (self->len_buckets == 0 && self->len_ents >= KS_DICT_SMALL) {
+        /* Small dictionary is full, so either reclaim deleted entries or build a hash table */
+        s_fill_holes(self);
+        if (self->len_ents >= KS_DICT_SMALL) {
+            if (!s_reserve(self, self->len_ents + 1)) return false;
+            if (!s_resize(self, (ks_size_t)((self->len_ents + 1) / S_LOAD_NEW))) return false;
+            if (!s_search(self, key, hash, &rb, &re)) return false;
+        }
+    }
 
-            /* Now, refind it */
-            ks_ssize_t new_re;
-            if (!s_search(self, key, hash, &rb, &new_re)) return false;
+    if (!s_reserve(self, self->len_ents + 1)) return false;
+    re = self->len_ents++;
 
-            assert(rb >= 0 && re == new_re);
-        }
+    /* Add to entries */
+    self->len_real++;
+    
+    KS_INCREF(key);
+    KS_INCREF(val);
+    
+    self->ents[re].hash = hash;
+    self->ents[re].key = key;
+    self->ents[re].val = val;
 
-        /* Set the bucket to point to it */
-        S_T_SIZE(self, self->len_ents, 
-            __buckets[rb] = re;
-        );
+    /* Small dictionaries have no buckets */
+    if (self->len_buckets == 0) return true;
 
-        return true;
-    } else {
-        /* Found, so replace value*/
-        KS_INCREF(val);
-        KS_DECREF(self->ents[re].val);
-        self->ents[re].val = val;
-        return true;
+    /* Add buckets if needed */
+    if (rb < 0 || (self->len_ents == KS_SINT8_MAX || self->len_ents == KS_SINT16_MAX || self->len_ents == KS_SINT32_MAX)) {
+        /* No bucket found (or the bucket size changed), so we need to grow and rehash, which will
+         *   also add the new entry to the buckets
+         */
+        ks_size_t new_len_buckets = (ks_size_t)(self->len_real / S_LOAD_NEW);
+        if (new_len_buckets <= self->len_buckets && self->len_ents == self->len_real) new_len_buckets = 2 * self->len_buckets;
+
+        return s_resize(self, new_len_buckets);
     }
+
+    /* Set the bucket to point to it */
+    S_T_SIZE(self, self->len_ents, 
+        __buckets[rb] = re;
+    );
+
+    return true;
 }
 
 bool ks_dict_has(ks_dict self, kso key, bool* exists) {
@@ -480,8 +538,8 @@ bool ks_dict_has_h(ks_dict self, kso key, ks_hash_t hash, bool* exists) {
     return true;
 }
 bool ks_dict_has_c(ks_dict self, const char* key, bool* exists) {
-    ks_str o = ks_str_new(-1, key);
-    bool res = ks_dict_has_h(self, (kso)o, o->v_hash, exists);
+    ks_str o = ks_str_intern_c(-1, key);
+    bool res = ks_dict_has_h(self, (kso)o, KS_STR_HASH(o), exists);
     KS_DECREF(o);
     return res;
 }
@@ -500,10 +558,18 @@ bool ks_dict_del_h(ks_dict self, kso key, ks_hash_t hash, bool* existed) {
     *existed = re >= 0;
 
     if (*existed) {
-        assert (rb >= 0);
-        S_T_SIZE(self, self->len_ents,
-            __buckets[rb] = B_DELETED;
-        );
+        if (self->len_buckets > 0) {
+            assert (rb >= 0);
+            S_T_SIZE(self, self->len_ents,
+                __buckets[rb] = B_DELETED;
+            );
+        }
+
+        /* Leave a hole in the entries, which is filled when the table is resized */
+        KS_DECREF(self->ents[re].key);
+        KS_DECREF(self->ents[re].val);
+        self->ents[re].key = self->ents[re].val = NULL;
+        self->len_real--;
     }
 
     return true;
@@ -566,7 +632,7 @@ static KS_TFUNC(T, free) {
         }
     }
 
-    ks_free(self->ents);
+    if (self->ents != self->_small_ents) ks_free(self->ents);
     ks_free(self->buckets_s8);
 
     KSO_DEL(self);
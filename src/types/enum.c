@@ -121,6 +121,7 @@ static KS_TFUNC(T, make) {
     ks_dict i_v2m = ks_dict_new(NULL), i_n2m = ks_dict_new(NULL);
     if (kso_issub(members->type, kst_list)) {
         ks_list lm = (ks_list)members;
+        ks_list_box(lm);
         int i;
         for (i = 0; i < lm->len; ++i) {
             ks_list ol = ks_list_newi(lm->elems[i]);
@@ -7,10 +7,6 @@
 
 #define T_NAME "float"
 
-/* Precision (in digits) for regular and scientific output */
-#define F_PREC_REG (KS_CFLOAT_DIG)
-#define F_PREC_SCI (KS_CFLOAT_DIG)
-
 /* Absolute value at which numbers are printed in scientific format as opposed to regular */
 #define A_SCI_BIG 1.0e10
 #define A_SCI_SML 1.0e-10
@@ -33,6 +29,414 @@ static int I_digv(ks_ucp c) {
 }
 
 
+/* Powers of ten, as 128-bit mantissas (rounded down, with the top bit set) and binary exponents, such that
+ *   10^e ~= (hi * 2^64 + lo) * 2^e2
+ *
+ * These are used for both formatting (Grisu2) and parsing (Eisel-Lemire). Instead of a large table in the source, each
+ *   entry is computed exactly (with 'mpz') the first time it is needed
+ */
+#define P10_MIN (-348)
+#define P10_MAX 347
+
+static struct {
+    ks_uint64_t hi, lo;
+    int e2;
+    bool ok;
+} I_p10s[P10_MAX - P10_MIN + 1];
+
+static void I_p10(int e, ks_uint64_t* hi, ks_uint64_t* lo, int* e2) {
+    assert(P10_MIN <= e && e <= P10_MAX);
+    int i = e - P10_MIN;
+    if (!I_p10s[i].ok) {
+        mpz_t x, y;
+        mpz_init(x);
+        mpz_init(y);
+        mpz_ui_pow_ui(x, 10, e < 0 ? -e : e);
+        int nb = mpz_sizeinbase(x, 2);
+        if (e >= 0) {
+            if (nb > 128) mpz_fdiv_q_2exp(x, x, nb - 128);
+            else mpz_mul_2exp(x, x, 128 - nb);
+            I_p10s[i].e2 = nb - 128;
+        } else {
+            /* 2^(127+nb) / 10^-e is in [2^127, 2^128) */
+            mpz_set_ui(y, 1);
+            mpz_mul_2exp(y, y, 127 + nb);
+            mpz_fdiv_q(x, y, x);
+            I_p10s[i].e2 = -(127 + nb);
+        }
+
+        /* Extract 32 bits at a time, in case 'unsigned long' is small */
+        ks_uint64_t w[4];
+        int j;
+        for (j = 0; j < 4; ++j) {
+            w[j] = mpz_get_ui(x) & 0xFFFFFFFF;
+            mpz_fdiv_q_2exp(x, x, 32);
+        }
+        I_p10s[i].lo = w[0] | (w[1] << 32);
+        I_p10s[i].hi = w[2] | (w[3] << 32);
+        I_p10s[i].ok = true;
+        mpz_clear(x);
+        mpz_clear(y);
+    }
+    *hi = I_p10s[i].hi;
+    *lo = I_p10s[i].lo;
+    *e2 = I_p10s[i].e2;
+}
+
+/* Returns the high 64 bits of 'a * b', and stores the low 64 bits in '*lo' */
+static ks_uint64_t I_mul64(ks_uint64_t a, ks_uint64_t b, ks_uint64_t* lo) {
+    ks_uint64_t a0 = a & 0xFFFFFFFF, a1 = a >> 32, b0 = b & 0xFFFFFFFF, b1 = b >> 32;
+    ks_uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    ks_uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+    *lo = (mid << 32) | (p00 & 0xFFFFFFFF);
+    return p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+/* Number of leading zero bits in 'x' (which must be non-zero) */
+static int I_clz64(ks_uint64_t x) {
+    int r = 0;
+    while (!(x & ((ks_uint64_t)1 << 63))) {
+        x <<= 1;
+        r++;
+    }
+    return r;
+}
+
+static const ks_uint64_t I_pow10_u64[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+    10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+/* Powers of ten which are exactly representable as doubles */
+static const double I_pow10_f64[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+    1e20, 1e21, 1e22,
+};
+
+/* Custom floating point number ('f * 2^e'), used by Grisu */
+struct I_diyfp {
+    ks_uint64_t f;
+    int e;
+};
+
+/* Multiply, rounding to 64 bits */
+static struct I_diyfp I_diyfp_mul(struct I_diyfp x, struct I_diyfp y) {
+    ks_uint64_t lo, hi = I_mul64(x.f, y.f, &lo);
+    return (struct I_diyfp){ hi + (lo >> 63), x.e + y.e + 64 };
+}
+
+/* Round the last digit of 'dig' towards 'w' (which is 'wp_w' below the upper bound), while staying in the interval, and
+ *   return whether 'w' is too close (within 'err') to halfway between two digits to be sure of the closest one
+ */
+static bool I_grisu_round(char* dig, int n, ks_uint64_t delta, ks_uint64_t rest, ks_uint64_t ten_kappa, ks_uint64_t wp_w, ks_uint64_t err) {
+    while (rest < wp_w && delta - rest >= ten_kappa && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        dig[n - 1]--;
+        rest += ten_kappa;
+    }
+    ks_uint64_t d = rest < wp_w ? wp_w - rest : rest - wp_w;
+    return d + err >= ten_kappa / 2;
+}
+
+/* Convert 'man * 10^e10' to the nearest double (Eisel-Lemire), returning false if it could not be decided (in which
+ *   case a slower, exact method should be used)
+ *
+ * SEE: "Number Parsing at a Gigabyte per Second" (Daniel Lemire)
+ */
+static bool I_eisel_lemire(ks_uint64_t man, int e10, double* out) {
+    if (man == 0) {
+        *out = 0;
+        return true;
+    }
+    if (e10 < P10_MIN || e10 > P10_MAX) return false;
+
+    /* Exact when both the mantissa and power of ten are exactly representable */
+    if (man <= ((ks_uint64_t)1 << 53) && -22 <= e10 && e10 <= 22) {
+        *out = e10 < 0 ? (double)man / I_pow10_f64[-e10] : (double)man * I_pow10_f64[e10];
+        return true;
+    }
+
+    ks_uint64_t phi, plo;
+    int pe;
+    I_p10(e10, &phi, &plo, &pe);
+
+    int clz = I_clz64(man);
+    man <<= clz;
+
+    ks_uint64_t xlo, xhi = I_mul64(man, phi, &xlo);
+    if ((xhi & 0x1FF) == 0x1FF && xlo + man < man) {
+        /* The low half of the power may carry into the bits that matter */
+        ks_uint64_t ylo, yhi = I_mul64(man, plo, &ylo);
+        ks_uint64_t mhi = xhi, mlo = xlo + yhi;
+        if (mlo < xlo) mhi++;
+        if ((mhi & 0x1FF) == 0x1FF && mlo + 1 == 0 && ylo + man < man) return false;
+        xhi = mhi;
+        xlo = mlo;
+    }
+
+    /* Take 54 bits, then round to 53 */
+    int msb = (int)(xhi >> 63);
+    ks_uint64_t rman = xhi >> (msb + 9);
+    int rexp = pe + 1213 + msb - clz;
+    if (xlo == 0 && (xhi & 0x1FF) == 0 && (rman & 3) == 1) return false;
+
+    rman += rman & 1;
+    rman >>= 1;
+    if (rman >> 53) {
+        rman >>= 1;
+        rexp++;
+    }
+
+    /* Subnormals and overflow are left to the slow path */
+    if (rexp <= 0 || rexp >= 0x7FF) return false;
+
+    ks_uint64_t bits = ((ks_uint64_t)rexp << 52) | (rman & (((ks_uint64_t)1 << 52) - 1));
+    memcpy(out, &bits, sizeof(bits));
+    return true;
+}
+
+/* Try to parse a simple base-10 float ('[0-9]*\.?[0-9]*([eE][+-]?[0-9]+)?', without a sign) quickly, returning false
+ *   if it should be handled by the general method
+ */
+static bool I_parse10(const char* str, int sz, double* out) {
+    int i = 0, nd = 0, e10 = 0;
+    ks_uint64_t man = 0;
+    bool any = false;
+
+    /* Significant digits (up to 19 of them), keeping track of where the decimal point goes */
+    while (i < sz && str[i] >= '0' && str[i] <= '9') {
+        any = true;
+        if (man || str[i] != '0') {
+            if (nd >= 19) return false;
+            man = 10 * man + (str[i] - '0');
+            nd++;
+        }
+        i++;
+    }
+    if (i < sz && str[i] == '.') {
+        i++;
+        while (i < sz && str[i] >= '0' && str[i] <= '9') {
+            any = true;
+            if (man || str[i] != '0') {
+                if (nd >= 19) return false;
+                man = 10 * man + (str[i] - '0');
+                nd++;
+            }
+            e10--;
+            i++;
+        }
+    }
+    if (!any) return false;
+
+    if (i < sz && (str[i] == 'e' || str[i] == 'E')) {
+        i++;
+        bool neg = i < sz && str[i] == '-';
+        if (i < sz && (str[i] == '-' || str[i] == '+')) i++;
+        if (i >= sz) return false;
+        int x = 0;
+        while (i < sz && str[i] >= '0' && str[i] <= '9') {
+            if (x < 100000) x = 10 * x + (str[i] - '0');
+            i++;
+        }
+        e10 += neg ? -x : x;
+    }
+    if (i != sz) return false;
+
+    return I_eisel_lemire(man, e10, out);
+}
+
+
+/* Generate digits of a positive, finite 'val' (Grisu2), such that 'val ~= dig * 10^K'
+ *
+ * The digits always convert back to 'val'. Since the bounds are only known approximately, there may be a shorter
+ *   representation, in which case '*unsafe' is set. Likewise, '*near' is set when the last digit may not be the closest
+ *
+ * SEE: "Printing Floating-Point Numbers Quickly and Accurately with Integers" (Florian Loitsch)
+ */
+static int I_grisu2(double val, char* dig, int* K, bool* unsafe, bool* near) {
+    ks_uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    ks_uint64_t frac = bits & (((ks_uint64_t)1 << 52) - 1);
+    int bexp = (bits >> 52) & 0x7FF;
+
+    struct I_diyfp v;
+    if (bexp != 0) {
+        v.f = frac | ((ks_uint64_t)1 << 52);
+        v.e = bexp - 1075;
+    } else {
+        v.f = frac;
+        v.e = -1074;
+    }
+
+    /* Boundaries halfway to the neighboring doubles, with the same exponent */
+    struct I_diyfp wp = { (v.f << 1) + 1, v.e - 1 }, wm;
+    while (!(wp.f & ((ks_uint64_t)1 << 53))) {
+        wp.f <<= 1;
+        wp.e--;
+    }
+    wp.f <<= 10;
+    wp.e -= 10;
+    if (v.f == ((ks_uint64_t)1 << 52)) {
+        wm = (struct I_diyfp){ (v.f << 2) - 1, v.e - 2 };
+    } else {
+        wm = (struct I_diyfp){ (v.f << 1) - 1, v.e - 1 };
+    }
+    wm.f <<= wm.e - wp.e;
+    wm.e = wp.e;
+
+    /* Scale by a power of ten, so the upper boundary has a binary exponent in [-61, -57] */
+    int k = (int)ceil((-61 - wp.e) * 0.30102999566398114);
+    ks_uint64_t chi, clo;
+    int ce;
+    I_p10(k, &chi, &clo, &ce);
+    struct I_diyfp c = { chi + (clo >> 63), ce + 64 };
+    if (c.f == 0) {
+        c.f = (ks_uint64_t)1 << 63;
+        c.e++;
+    }
+    *K = -k;
+
+    int lz = I_clz64(v.f);
+    v.f <<= lz;
+    v.e -= lz;
+    struct I_diyfp W = I_diyfp_mul(v, c), Wp = I_diyfp_mul(wp, c), Wm = I_diyfp_mul(wm, c);
+    Wm.f++;
+    Wp.f--;
+
+    /* Generate digits of 'Wp' until they are within 'delta' of it. Each scaled bound may be off by a couple of units,
+     *   so when the previous digit was close to stopping, a shorter representation may exist
+     */
+    ks_uint64_t delta = Wp.f - Wm.f, wp_w = Wp.f - W.f, err = 8;
+    int sh = -Wp.e;
+    ks_uint64_t one = (ks_uint64_t)1 << sh;
+    ks_uint32_t p1 = (ks_uint32_t)(Wp.f >> sh);
+    ks_uint64_t p2 = Wp.f & (one - 1);
+    int n = 0, kappa = 0;
+    while (kappa < 10 && p1 >= I_pow10_u64[kappa]) kappa++;
+
+    *unsafe = false;
+    while (kappa > 0) {
+        ks_uint32_t d = p1 / (ks_uint32_t)I_pow10_u64[kappa - 1];
+        p1 %= (ks_uint32_t)I_pow10_u64[kappa - 1];
+        if (d || n) dig[n++] = '0' + d;
+        kappa--;
+        ks_uint64_t rest = ((ks_uint64_t)p1 << sh) + p2, ten_kappa = I_pow10_u64[kappa] << sh;
+        if (rest <= delta) {
+            *K += kappa;
+            *near = I_grisu_round(dig, n, delta, rest, ten_kappa, wp_w, err);
+            return n;
+        }
+        *unsafe = n > 0 && (rest <= delta + err || rest + err >= ten_kappa);
+    }
+    while (true) {
+        p2 *= 10;
+        delta *= 10;
+        err *= 10;
+        int d = (int)(p2 >> sh);
+        if (d || n) dig[n++] = '0' + d;
+        p2 &= one - 1;
+        kappa--;
+        if (p2 < delta) {
+            *K += kappa;
+            *near = I_grisu_round(dig, n, delta, p2, one, -kappa < 20 ? wp_w * I_pow10_u64[-kappa] : 0, err);
+            return n;
+        }
+        *unsafe = n > 0 && (p2 <= delta + err || p2 + err >= one);
+    }
+}
+
+/* Convert 'man * 10^e10' to the nearest double */
+static double I_dec2d(ks_uint64_t man, int e10) {
+    double r;
+    if (I_eisel_lemire(man, e10, &r)) return r;
+
+    char tmp[64];
+    snprintf(tmp, sizeof(tmp), "%llue%i", (unsigned long long)man, e10);
+    return strtod(tmp, NULL);
+}
+
+/* Compare 'man * 10^e10' with 'val' exactly, returning the sign of the difference */
+static int I_cmpexact(ks_uint64_t man, int e10, double val) {
+    int e2;
+    double m = frexp(val, &e2);
+    ks_uint64_t vm = (ks_uint64_t)ldexp(m, 53);
+    e2 -= 53;
+
+    mpz_t L, R, t;
+    mpz_init(L);
+    mpz_init(R);
+    mpz_init(t);
+    mpz_set_ui(L, (unsigned long)(man >> 32));
+    mpz_mul_2exp(L, L, 32);
+    mpz_add_ui(L, L, (unsigned long)(man & 0xFFFFFFFF));
+    mpz_set_ui(R, (unsigned long)(vm >> 32));
+    mpz_mul_2exp(R, R, 32);
+    mpz_add_ui(R, R, (unsigned long)(vm & 0xFFFFFFFF));
+
+    mpz_ui_pow_ui(t, 10, e10 < 0 ? -e10 : e10);
+    if (e10 >= 0) mpz_mul(L, L, t);
+    else mpz_mul(R, R, t);
+    if (e2 >= 0) mpz_mul_2exp(R, R, e2);
+    else mpz_mul_2exp(L, L, -e2);
+
+    int res = mpz_cmp(L, R);
+    mpz_clear(L);
+    mpz_clear(R);
+    mpz_clear(t);
+    return res < 0 ? -1 : res > 0;
+}
+
+/* Of 't - 1', 't' and 't + 1' (scaled by '10^e10'), find the one closest to 'val' that converts back to it */
+static bool I_pick(double val, ks_uint64_t t, int e10, ks_uint64_t* res) {
+    ks_uint64_t good[3];
+    int j, nb = 0;
+    for (j = -1; j <= 1; ++j) {
+        if (t + j > 0 && I_dec2d(t + j, e10) == val) good[nb++] = t + j;
+    }
+    if (nb == 0) return false;
+
+    /* Between two candidates, take the closer one (or the even one, if they are equally close) */
+    *res = good[0];
+    for (j = 1; j < nb; ++j) {
+        int c = I_cmpexact(10 * good[j - 1] + 5, e10 - 1, val);
+        if (c > 0 || (c == 0 && good[j - 1] % 2 == 0)) break;
+        *res = good[j];
+    }
+    return true;
+}
+
+/* Generate the shortest digits of a positive, finite 'val', such that 'val ~= dig * 10^K' (of the shortest, the one
+ *   closest to 'val' is chosen)
+ */
+static int I_shortest(double val, char* dig, int* K) {
+    bool unsafe, near;
+    int n = I_grisu2(val, dig, K, &unsafe, &near);
+    if (!unsafe && !near) return n;
+
+    /* Grisu2 could have missed a shorter or closer representation, so check its neighbors exactly */
+    ks_uint64_t t = 0, r;
+    int j;
+    for (j = 0; j < n; ++j) t = 10 * t + (dig[j] - '0');
+    if (near && I_pick(val, t, *K, &r)) t = r;
+    while (unsafe && t >= 10 && I_pick(val, t / 10, *K + 1, &r)) {
+        t = r;
+        *K += 1;
+    }
+    while (t % 10 == 0) {
+        t /= 10;
+        *K += 1;
+    }
+
+    char tmp[24];
+    n = 0;
+    do {
+        tmp[n++] = '0' + t % 10;
+        t /= 10;
+    } while (t > 0);
+    for (j = 0; j < n; ++j) dig[j] = tmp[n - 1 - j];
+    return n;
+}
+
 /* C-API */
 
 ks_float ks_float_newt(ks_type tp, ks_cfloat val) {
@@ -84,6 +488,11 @@ bool ks_cfloat_from_str(const char* str, int sz, ks_cfloat* out) {
 
 
     if (base == 10) {
+        if (I_parse10(str, sz, out)) {
+            if (isNeg) *out = -*out;
+            return true;
+        }
+
         char* rve = NULL;
         int st = 0;
         if (nt) {
@@ -94,11 +503,12 @@ bool ks_cfloat_from_str(const char* str, int sz, ks_cfloat* out) {
             }
 
         } else {
-            char* ts = ks_malloc(sz + 1);
+            char tsb[128];
+            char* ts = sz < sizeof(tsb) ? tsb : ks_malloc(sz + 1);
             memcpy(ts, str, sz);
             ts[sz] = '\0';
             *out = strtod(ts, &rve);
-            ks_free(ts);
+            if (ts != tsb) ks_free(ts);
             if (rve != ts + sz) {
                 KS_THROW(kst_ValError, "Invalid format for base %i float: '%.*s' (invalid digits)", base, o_sz, o_str);
                 return false;
@@ -228,7 +638,7 @@ int ks_cfloat_to_str(char* str, int sz, ks_cfloat val, bool sci, int prec, int b
     }
 
     /* Now, we are working with a real number */
-    bool is_neg = val < 0;
+    bool is_neg = signbit(val);
     if (is_neg) {
         val = -val;
         ADDC('-');
@@ -240,6 +650,46 @@ int ks_cfloat_to_str(char* str, int sz, ks_cfloat val, bool sci, int prec, int b
         return i;
     }
 
+    if (prec < 0 && base == 10) {
+        /* Shortest digits that convert back to 'val', with 'dp' digits before the decimal point */
+        char dig[32];
+        int K, n = I_shortest(val, dig, &K);
+        int dp = n + K;
+
+        if (sci) {
+            ADDC(dig[0]);
+            ADDC('.');
+            if (n == 1) ADDC('0');
+            for (j = 1; j < n; ++j) ADDC(dig[j]);
+
+            int x = dp - 1;
+            ADDC('e');
+            ADDC(x >= 0 ? '+' : '-');
+            if (x < 0) x = -x;
+            char xd[8];
+            k = 0;
+            do {
+                xd[k++] = '0' + x % 10;
+                x /= 10;
+            } while (x > 0);
+            while (k > 0) ADDC(xd[--k]);
+        } else if (dp <= 0) {
+            ADDC('0');
+            ADDC('.');
+            for (j = 0; j < -dp; ++j) ADDC('0');
+            for (j = 0; j < n; ++j) ADDC(dig[j]);
+        } else if (dp < n) {
+            for (j = 0; j < dp; ++j) ADDC(dig[j]);
+            ADDC('.');
+            for (j = dp; j < n; ++j) ADDC(dig[j]);
+        } else {
+            for (j = 0; j < n; ++j) ADDC(dig[j]);
+            for (j = n; j < dp; ++j) ADDC('0');
+            ADDS(".0");
+        }
+        return i;
+    }
+
     /* Now, val > 0 */
 
     /**/ if (base ==  2) ADDS("0b");
@@ -424,10 +874,10 @@ static KS_TFUNC(T, str) {
 
     char tmp[256];
     
-    int sz = ks_cfloat_to_str(tmp, sizeof(tmp) - 1, self->val, sci, sci ? F_PREC_SCI : F_PREC_REG, 10);
+    int sz = ks_cfloat_to_str(tmp, sizeof(tmp) - 1, self->val, sci, -1, 10);
     if (sz >= sizeof(tmp) - 1) {
         char* atmp = ks_malloc(sz + 5);
-        int asz = ks_cfloat_to_str(atmp, sz+4, self->val, sci, sci ? F_PREC_SCI : F_PREC_REG, 10);
+        int asz = ks_cfloat_to_str(atmp, sz+4, self->val, sci, -1, 10);
         //assert(sz == asz);
         ks_str res = ks_str_new(asz, atmp);
         ks_free(atmp);
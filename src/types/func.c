@@ -11,6 +11,7 @@
 
 kso ksf_wrap(ks_cfunc cfunc, const char* sig, const char* doc) {
     ks_func self = KSO_NEW(ks_func, kst_func);
+    self->attr = ks_dict_new(NULL);
 
     self->is_cfunc = true;
     self->cfunc = cfunc;
@@ -42,6 +43,7 @@ kso ksf_wrap(ks_cfunc cfunc, const char* sig, const char* doc) {
 
 ks_func ks_func_new_k(kso bc, ks_tuple args, int n_defa, kso* defa, int vararg_idx, ks_str sig, ks_str doc) {
     ks_func self = KSO_NEW(ks_func, kst_func);
+    self->attr = ks_dict_new(NULL);
     ks_ssize_t sl = sig->len_b;
 
     int first_lpar = -1, first_dot = -1;
@@ -155,7 +157,7 @@ static KS_TFUNC(T, str) {
     ks_func self;
     KS_ARGS("self:*", &self, kst_func);
 
-    kso sig = ks_dict_get_h(self->attr, (kso)_ksva__sig, _ksva__sig->v_hash);
+    kso sig = ks_dict_get_h(self->attr, (kso)_ksva__sig, KS_STR_HASH(_ksva__sig));
     ks_str res = ks_fmt("<%T %R>", self, sig);
     KS_DECREF(sig);
 
@@ -11,6 +11,81 @@
 
 /* C-API */
 
+/* Whether a list is using unboxed storage */
+#define S_UNBOXED(_self) ((_self)->_strat == KS_LIST_S_INT || (_self)->_strat == KS_LIST_S_FLOAT)
+
+/* Size of each element in the array in use */
+static ks_size_t s_esize(ks_list self) {
+    if (self->_strat == KS_LIST_S_INT) return sizeof(*self->_raw_i);
+    else if (self->_strat == KS_LIST_S_FLOAT) return sizeof(*self->_raw_f);
+    return sizeof(*self->elems);
+}
+
+/* Pointer to the array in use */
+static unsigned char* s_data(ks_list self) {
+    return S_UNBOXED(self) ? (unsigned char*)self->_raw_i : (unsigned char*)self->elems;
+}
+
+/* Ensure capacity for 'cap' elements in the array in use */
+static void s_reserve(ks_list self, ks_size_t cap) {
+    if (cap > self->_max_len) {
+        self->_max_len = ks_nextsize(self->_max_len, cap);
+        if (S_UNBOXED(self)) {
+            self->_raw_i = ks_zrealloc(self->_raw_i, s_esize(self), self->_max_len);
+        } else {
+            self->elems = ks_zrealloc(self->elems, sizeof(*self->elems), self->_max_len);
+        }
+    }
+}
+
+/* Return the unboxed strategy that can hold 'ob', or 'KS_LIST_S_OBJ' if there is none */
+static int s_kind(kso ob) {
+    if (ob->type == kst_int) {
+        return mpz_fits_slong_p(((ks_int)ob)->val) ? KS_LIST_S_INT : KS_LIST_S_OBJ;
+    } else if (ob->type == kst_float) {
+        return KS_LIST_S_FLOAT;
+    }
+    return KS_LIST_S_OBJ;
+}
+
+/* Store the value of 'ob' (which must match the strategy) unboxed at 'idx' */
+static void s_setraw(ks_list self, ks_size_t idx, kso ob) {
+    if (self->_strat == KS_LIST_S_INT) {
+        self->_raw_i[idx] = mpz_get_si(((ks_int)ob)->val);
+    } else {
+        self->_raw_f[idx] = ((ks_float)ob)->val;
+    }
+}
+
+/* Switch an empty list to the strategy 'strat', keeping its capacity */
+static void s_switch(ks_list self, int strat) {
+    assert(self->len == 0);
+    void* data = s_data(self);
+    self->elems = NULL;
+    self->_strat = strat;
+    self->_raw_i = ks_zrealloc(data, s_esize(self), self->_max_len);
+}
+
+/* Prepare to store 'ob' in 'self', switching strategies if needed, and return whether it should be stored
+ *   unboxed (otherwise, 'self->elems' is valid)
+ */
+static bool s_accept(ks_list self, kso ob) {
+    if (self->_strat == KS_LIST_S_OBJ) return false;
+
+    int k = s_kind(ob);
+    if (k != KS_LIST_S_OBJ) {
+        if (k == self->_strat) return true;
+        if (self->len == 0) {
+            s_switch(self, k);
+            return true;
+        }
+    }
+
+    /* Heterogeneous, so the list holds objects from now on */
+    ks_list_box(self);
+    return false;
+}
+
 ks_list ks_list_new(ks_ssize_t len, kso* elems) {
     ks_list self = KSO_NEW(ks_list, kst_list);
 
@@ -55,10 +130,7 @@ ks_list ks_list_newit(ks_type tp, kso objs) {
     kso ob;
     while ((ob = ks_cit_next(&it)) != NULL) {
         ks_ssize_t idx = res->len++;
-        if (res->len > res->_max_len) {
-            res->_max_len = ks_nextsize(res->len, res->_max_len);
-            res->elems = ks_zrealloc(res->elems, sizeof(*res->elems), res->_max_len);
-        }
+        s_reserve(res, res->len);
 
         /* Absorb reference */
         res->elems[idx] = ob;
@@ -76,57 +148,160 @@ ks_list ks_list_newi(kso objs) {
     return ks_list_newit(kst_list, objs);
 }
 bool ks_list_reserve(ks_list self, int cap) {
-    if (cap > self->_max_len) {
-        self->_max_len = ks_nextsize(self->_max_len, cap);
-        self->elems = ks_zrealloc(self->elems, sizeof(*self->elems), self->_max_len);
+    s_reserve(self, cap);
+    return true;
+}
+
+void ks_list_box(ks_list self) {
+    if (!S_UNBOXED(self)) return;
+
+    kso* elems = ks_zmalloc(sizeof(*elems), self->_max_len);
+    ks_size_t i;
+    if (self->_strat == KS_LIST_S_INT) {
+        for (i = 0; i < self->len; ++i) {
+            elems[i] = (kso)ks_int_new(self->_raw_i[i]);
+        }
+    } else {
+        for (i = 0; i < self->len; ++i) {
+            elems[i] = (kso)ks_float_new(self->_raw_f[i]);
+        }
+    }
+
+    ks_free(self->_raw_i);
+    self->_raw_i = NULL;
+    self->elems = elems;
+    self->_strat = KS_LIST_S_ANY;
+}
+
+void ks_list_unbox(ks_list self) {
+    if (self->_strat == KS_LIST_S_OBJ) self->_strat = KS_LIST_S_ANY;
+    if (self->_strat != KS_LIST_S_ANY || self->len == 0) return;
+
+    int k = s_kind(self->elems[0]);
+    if (k == KS_LIST_S_OBJ) return;
+
+    ks_size_t i;
+    for (i = 1; i < self->len; ++i) {
+        if (s_kind(self->elems[i]) != k) return;
     }
+
+    /* Homogeneous, so convert the elements */
+    kso* elems = self->elems;
+    ks_size_t len = self->len;
+    self->elems = NULL;
+    self->_strat = k;
+    self->_raw_i = ks_zmalloc(s_esize(self), self->_max_len);
+    for (i = 0; i < len; ++i) {
+        s_setraw(self, i, elems[i]);
+        KS_DECREF(elems[i]);
+    }
+    ks_free(elems);
+}
+
+kso ks_list_get(ks_list self, ks_cint idx) {
+    if (self->_strat == KS_LIST_S_INT) {
+        return (kso)ks_int_new(self->_raw_i[idx]);
+    } else if (self->_strat == KS_LIST_S_FLOAT) {
+        return (kso)ks_float_new(self->_raw_f[idx]);
+    }
+    return KS_NEWREF(self->elems[idx]);
+}
+
+bool ks_list_set(ks_list self, ks_cint idx, kso ob) {
+    if (S_UNBOXED(self)) {
+        if (s_kind(ob) == self->_strat) {
+            s_setraw(self, idx, ob);
+            return true;
+        }
+        ks_list_box(self);
+    }
+
+    KS_INCREF(ob);
+    KS_DECREF(self->elems[idx]);
+    self->elems[idx] = ob;
     return true;
 }
 
+ks_list ks_list_slice(ks_list self, ks_cint first, ks_cint last, ks_cint delta) {
+    ks_list res = ks_list_new(0, NULL);
+    ks_cint i;
+    if (S_UNBOXED(self)) {
+        res->_strat = KS_LIST_S_ANY;
+        s_switch(res, self->_strat);
+        for (i = first; i != last; i += delta) {
+            s_reserve(res, res->len + 1);
+            if (self->_strat == KS_LIST_S_INT) res->_raw_i[res->len++] = self->_raw_i[i];
+            else res->_raw_f[res->len++] = self->_raw_f[i];
+        }
+    } else {
+        for (i = first; i != last; i += delta) {
+            ks_list_push(res, self->elems[i]);
+        }
+        ks_list_unbox(res);
+    }
+
+    return res;
+}
+
 void ks_list_clear(ks_list self) {
-    ks_size_t i;
-    for (i = 0; i < self->len; ++i) {
-        KS_DECREF(self->elems[i]);
+    if (!S_UNBOXED(self)) {
+        ks_size_t i;
+        for (i = 0; i < self->len; ++i) {
+            KS_DECREF(self->elems[i]);
+        }
     }
     self->len = 0;
 }
 
 bool ks_list_push(ks_list self, kso ob) {
-    bool res = ks_list_pushu(self, ob);
-    if (res) KS_INCREF(ob);
-    return res;
+    KS_INCREF(ob);
+    return ks_list_pushu(self, ob);
 }
 
 bool ks_list_pushu(ks_list self, kso ob) {
-    ks_size_t i = self->len++;
-    if (self->len > self->_max_len) {
-        self->_max_len = ks_nextsize(self->len, self->_max_len);
-        self->elems = ks_zrealloc(self->elems, sizeof(*self->elems), self->_max_len);
+    ks_size_t i = self->len;
+    if (self->_strat != KS_LIST_S_OBJ && s_accept(self, ob)) {
+        s_reserve(self, i + 1);
+        s_setraw(self, i, ob);
+        KS_DECREF(ob);
+    } else {
+        s_reserve(self, i + 1);
+        self->elems[i] = ob;
     }
-    self->elems[i] = ob;
+    self->len++;
     return true;
 }
 bool ks_list_pushan(ks_list self, ks_cint len, kso* objs) {
-    ks_ssize_t i = self->len;
-    self->len += len;
-    if (self->len > self->_max_len) {
-        self->_max_len = ks_nextsize(self->_max_len, self->len);
-        self->elems = ks_zrealloc(self->elems, sizeof(*self->elems), self->_max_len);
+    ks_ssize_t i;
+    if (self->_strat != KS_LIST_S_OBJ) {
+        for (i = 0; i < len; ++i) {
+            ks_list_pushu(self, objs[i]);
+        }
+        return true;
     }
 
+    i = self->len;
+    s_reserve(self, self->len + len);
+    self->len += len;
+
     memcpy(self->elems + i, objs, len * sizeof(*objs));
     return true;
 }
 
 
 bool ks_list_pusha(ks_list self, ks_cint len, kso* objs) {
-    ks_ssize_t i = self->len;
-    self->len += len;
-    if (self->len > self->_max_len) {
-        self->_max_len = ks_nextsize(self->_max_len, self->len);
-        self->elems = ks_zrealloc(self->elems, sizeof(*self->elems), self->_max_len);
+    ks_ssize_t i;
+    if (self->_strat != KS_LIST_S_OBJ) {
+        for (i = 0; i < len; ++i) {
+            ks_list_push(self, objs[i]);
+        }
+        return true;
     }
 
+    i = self->len;
+    s_reserve(self, self->len + len);
+    self->len += len;
+
     memcpy(self->elems + i, objs, len * sizeof(*objs));
     for (i = 0; i < len; ++i) {
         KS_INCREF(objs[i]);
@@ -138,19 +313,36 @@ bool ks_list_pusha(ks_list self, ks_cint len, kso* objs) {
 
 bool ks_list_pushall(ks_list self, kso objs) {
     if (kso_issub(objs->type, kst_list)) {
-        return ks_list_pusha(self, ((ks_list)objs)->len, ((ks_list)objs)->elems);
+        ks_list lo = (ks_list)objs;
+        ks_size_t i, n = lo->len;
+        if (S_UNBOXED(lo)) {
+            if (self->_strat != KS_LIST_S_OBJ && (self->_strat == lo->_strat || self->len == 0)) {
+                /* Copy the unboxed values directly */
+                if (self->_strat != lo->_strat) s_switch(self, lo->_strat);
+                s_reserve(self, self->len + n);
+                memcpy(s_data(self) + self->len * s_esize(self), s_data(lo), n * s_esize(lo));
+                self->len += n;
+            } else {
+                for (i = 0; i < n; ++i) {
+                    ks_list_pushu(self, ks_list_get(lo, i));
+                }
+            }
+            return true;
+        }
+
+        /* Reserve first, in case 'self == lo' */
+        s_reserve(self, self->len + n);
+        return ks_list_pusha(self, n, lo->elems);
     } else if (kso_issub(objs->type, kst_tuple)) {
         return ks_list_pusha(self, ((ks_tuple)objs)->len, ((ks_tuple)objs)->elems);
     } else {
         ks_cit it = ks_cit_make(objs);
         kso ob;
         while (ob = ks_cit_next(&it)) {
-            if (!ks_list_push(self, ob)) {
-                KS_DECREF(ob);
+            if (!ks_list_pushu(self, ob)) {
                 ks_cit_done(&it);
                 return false;
             }
-            KS_DECREF(ob);
         }
         ks_cit_done(&it);
         if (it.exc) return false;
@@ -159,34 +351,45 @@ bool ks_list_pushall(ks_list self, kso objs) {
     }
 }
 bool ks_list_insert(ks_list self, ks_cint idx, kso ob) {
-    bool res = ks_list_insertu(self, idx, ob);
     KS_INCREF(ob);
-    return res;
+    return ks_list_insertu(self, idx, ob);
 }
 
 
 bool ks_list_insertu(ks_list self, ks_cint idx, kso ob) {
+    bool raw = s_accept(self, ob);
+    s_reserve(self, self->len + 1);
+
+    ks_size_t sz = s_esize(self);
+    unsigned char* data = s_data(self);
+    memmove(data + (idx + 1) * sz, data + idx * sz, (self->len - idx) * sz);
     self->len++;
-    if (self->len > self->_max_len) {
-        self->_max_len = ks_nextsize(self->len, self->_max_len);
-        self->elems = ks_zrealloc(self->elems, sizeof(*self->elems), self->_max_len);
-    }
 
-    ks_ssize_t i;
-    for (i = self->len - 1; i > idx; --i) {
-        self->elems[i] = self->elems[i - 1];
+    if (raw) {
+        s_setraw(self, idx, ob);
+        KS_DECREF(ob);
+    } else {
+        self->elems[idx] = ob;
     }
-    self->elems[idx] = ob;
     return true;
 }
 
 
 
 kso ks_list_pop(ks_list self) {
+    if (S_UNBOXED(self)) {
+        kso res = ks_list_get(self, self->len - 1);
+        self->len--;
+        return res;
+    }
     return self->elems[--self->len];
 }
 
 void ks_list_popu(ks_list self) {
+    if (S_UNBOXED(self)) {
+        self->len--;
+        return;
+    }
     kso el = self->elems[--self->len];
     KS_DECREF(el);
 }
@@ -195,12 +398,11 @@ void ks_list_popu(ks_list self) {
 bool ks_list_del(ks_list self, ks_cint idx) {
     if (idx < 0) idx += self->len;
 
-    KS_DECREF(self->elems[idx]);
+    if (!S_UNBOXED(self)) KS_DECREF(self->elems[idx]);
 
-    ks_cint i;
-    for (i = idx; i < self->len - 1; ++i) {
-        self->elems[i] = self->elems[i + 1];
-    }
+    ks_size_t sz = s_esize(self);
+    unsigned char* data = s_data(self);
+    memmove(data + idx * sz, data + (idx + 1) * sz, (self->len - idx - 1) * sz);
 
     self->len--;
 
@@ -213,11 +415,15 @@ static KS_TFUNC(T, free) {
     ks_list self;
     KS_ARGS("self:*", &self, kst_list);
 
-    ks_size_t i;
-    for (i = 0; i < self->len; ++i) {
-        KS_DECREF(self->elems[i]);
+    if (S_UNBOXED(self)) {
+        ks_free(self->_raw_i);
+    } else {
+        ks_size_t i;
+        for (i = 0; i < self->len; ++i) {
+            KS_DECREF(self->elems[i]);
+        }
+        ks_free(self->elems);
     }
-    ks_free(self->elems);
 
     KSO_DEL(self);
 
@@ -234,6 +440,7 @@ static KS_TFUNC(T, new) {
 
     self->len = self->_max_len = 0;
     self->elems = NULL;
+    self->_strat = KS_LIST_S_ANY;
 
     return (kso)self;
 }
@@ -276,8 +483,29 @@ static KS_TFUNC(T, eq) {
         ks_list lL = (ks_list)L, lR = (ks_list)R;
 
         if (lL->len != lR->len) return KSO_FALSE;
+        if (lL == lR) return KSO_TRUE;
 
         ks_cint i;
+        if (lL->_strat == KS_LIST_S_INT && lR->_strat == KS_LIST_S_INT) {
+            return KSO_BOOL(memcmp(lL->_raw_i, lR->_raw_i, sizeof(*lL->_raw_i) * lL->len) == 0);
+        } else if (lL->_strat == KS_LIST_S_FLOAT && lR->_strat == KS_LIST_S_FLOAT) {
+            for (i = 0; i < lL->len; ++i) {
+                if (lL->_raw_f[i] != lR->_raw_f[i]) return KSO_FALSE;
+            }
+            return KSO_TRUE;
+        } else if (S_UNBOXED(lL) || S_UNBOXED(lR)) {
+            for (i = 0; i < lL->len; ++i) {
+                kso a = ks_list_get(lL, i), b = ks_list_get(lR, i);
+                bool g;
+                bool ok = kso_eq(a, b, &g);
+                KS_DECREF(a);
+                KS_DECREF(b);
+                if (!ok) return NULL;
+                if (!g) return KSO_FALSE;
+            }
+            return KSO_TRUE;
+        }
+
         for (i = 0; i < lL->len; ++i) {
             kso a = lL->elems[i], b = lR->elems[i];
             if (a == b) continue;
@@ -301,6 +529,7 @@ static KS_TFUNC(T, add) {
     KS_ARGS("L R", &L, &R);
 
     ks_list res = ks_list_new(0, NULL);
+    ks_list_unbox(res);
 
     if (!ks_list_pushall(res, L)) {
         KS_DECREF(res);
@@ -324,8 +553,9 @@ static KS_TFUNC(T, mul) {
             return NULL;
         }
         ks_list res = ks_list_new(0, NULL);
+        ks_list_unbox(res);
         while (ct > 0) {
-            ks_list_pusha(res, ((ks_list)L)->len, ((ks_list)L)->elems);
+            ks_list_pushall(res, L);
             ct--;
         }
 
@@ -337,8 +567,9 @@ static KS_TFUNC(T, mul) {
             return NULL;
         }
         ks_list res = ks_list_new(0, NULL);
+        ks_list_unbox(res);
         while (ct > 0) {
-            ks_list_pusha(res, ((ks_list)R)->len, ((ks_list)R)->elems);
+            ks_list_pushall(res, R);
             ct--;
         }
 
@@ -377,8 +608,8 @@ static KS_TFUNC(T, pop) {
     if (_nargs == 1) {
         return (kso)ks_list_pop(self);
     } else {
-        ks_list res = ks_list_newn(num, self->elems + self->len - num);
-        self->len -= num;
+        ks_list res = ks_list_slice(self, self->len - num, self->len, 1);
+        while (num-- > 0) ks_list_popu(self);
         return (kso)res;
     }
 }
@@ -388,6 +619,38 @@ static KS_TFUNC(T, index) {
     KS_ARGS("self:* elem", &self, kst_list, &elem);
 
     ks_cint i;
+    if (S_UNBOXED(self)) {
+        if (s_kind(elem) == self->_strat) {
+            /* Search the unboxed values directly */
+            if (self->_strat == KS_LIST_S_INT) {
+                ks_cint v = mpz_get_si(((ks_int)elem)->val);
+                for (i = 0; i < self->len; ++i) {
+                    if (self->_raw_i[i] == v) return (kso)ks_int_new(i);
+                }
+            } else {
+                ks_cfloat v = ((ks_float)elem)->val;
+                for (i = 0; i < self->len; ++i) {
+                    if (self->_raw_f[i] == v) return (kso)ks_int_new(i);
+                }
+            }
+        } else {
+            for (i = 0; i < self->len; ++i) {
+                kso ob = ks_list_get(self, i);
+                bool eq;
+                bool ok = kso_eq(elem, ob, &eq);
+                KS_DECREF(ob);
+                if (!ok) {
+                    return NULL;
+                } else if (eq) {
+                    return (kso)ks_int_new(i);
+                }
+            }
+        }
+
+        KS_THROW_VAL(self, elem);
+        return NULL;
+    }
+
     for (i = 0; i < self->len; ++i) {
         kso ob = self->elems[i];
         if (ob == elem) {
@@ -412,6 +675,22 @@ static KS_TFUNC(T, sort) {
     kso keys = NULL;
     KS_ARGS("self:* ?cmpfunc ?keys", &self, kst_list, &cmpfunc, &keys);
 
+    if ((!keys || keys == KSO_NONE) && (!cmpfunc || cmpfunc == KSO_NONE)) {
+        /* Sort unboxed values directly (floats with NaNs use the general ordering instead) */
+        if (self->_strat == KS_LIST_S_INT) {
+            ks_sort_ci(self->len, self->_raw_i);
+            return KSO_NONE;
+        } else if (self->_strat == KS_LIST_S_FLOAT) {
+            ks_size_t i;
+            for (i = 0; i < self->len && self->_raw_f[i] == self->_raw_f[i]; ++i) {}
+            if (i == self->len) {
+                ks_sort_cf(self->len, self->_raw_f);
+                return KSO_NONE;
+            }
+        }
+    }
+    ks_list_box(self);
+
     if (!keys || keys == KSO_NONE) {
         /* Use entries as keys */
         if (!ks_sort(self->len, self->elems, self->elems, cmpfunc)) {
@@ -482,7 +761,7 @@ void _ksi_list() {
         {"__new",                ksf_wrap(TI_new_, TI_NAME ".__new(tp, of)", "")},
     ));
 
-    _ksinit(kst_list, kst_object, T_NAME, sizeof(struct ks_list_s), -1, "List of references to other objects, which is mutable\n\n    Internally, a 'list' is not a linked-list-like data structure, but closer to an array. Specifically, it is an array of references, so children are not copied or duplicated, only a reference is made to them", KS_IKV(
+    _ksinit(kst_list, kst_object, T_NAME, sizeof(struct ks_list_s), -1, "List of references to other objects, which is mutable\n\n    Internally, a 'list' is not a linked-list-like data structure, but closer to an array. Specifically, it is an array of references, so children are not copied or duplicated, only a reference is made to them\n\n    Lists of only 'int's or only 'float's store their values directly (unboxed), and create the objects when they are accessed", KS_IKV(
         {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
         {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, *args)", "")},
         {"__init",               ksf_wrap(T_init_, T_NAME ".__init(self, objs=none)", "")},
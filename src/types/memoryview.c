@@ -0,0 +1,277 @@
+/* types/memoryview.c - 'memoryview' type
+ *
+ * @author: Cade Brown <cade@kscript.org>
+ */
+#include <ks/impl.h>
+
+#define T_NAME "memoryview"
+
+
+/* C-API */
+
+ks_memoryview ks_memoryview_new(kso obj, void* data, ks_ssize_t len_b, bool readonly) {
+    ks_memoryview self = KSO_NEW(ks_memoryview, kst_memoryview);
+
+    KS_INCREF(obj);
+    self->obj = obj;
+    self->data = data;
+    self->len_b = len_b;
+    self->readonly = readonly;
+
+    /* Pin the size of the owner */
+    if (kso_issub(obj->type, kst_bytearray)) {
+        ((ks_bytearray)obj)->n_views++;
+    }
+
+    return self;
+}
+
+bool kso_is_buf(kso ob) {
+    return KS_TYPE_HAS(ob->type, KS_TF_BYTES) || KS_TYPE_HAS(ob->type, KS_TF_STR) || kso_issub(ob->type, kst_bytearray) || kso_issub(ob->type, kst_memoryview);
+}
+
+bool kso_get_buf(kso ob, bool writable, unsigned char** data, ks_ssize_t* len_b) {
+    if (kso_issub(ob->type, kst_bytearray)) {
+        *data = ((ks_bytearray)ob)->data;
+        *len_b = ((ks_bytearray)ob)->len_b;
+        return true;
+    } else if (kso_issub(ob->type, kst_memoryview)) {
+        ks_memoryview mv = (ks_memoryview)ob;
+        if (writable && mv->readonly) {
+            KS_THROW(kst_TypeError, "'%T' object is read-only", ob);
+            return false;
+        }
+        *data = mv->data;
+        *len_b = mv->len_b;
+        return true;
+    } else if (writable) {
+        KS_THROW(kst_TypeError, "Expected a writable bytes-like object ('bytearray' or 'memoryview'), but got '%T'", ob);
+        return false;
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_BYTES)) {
+        *data = ((ks_bytes)ob)->data;
+        *len_b = ((ks_bytes)ob)->len_b;
+        return true;
+    } else if (KS_TYPE_HAS(ob->type, KS_TF_STR)) {
+        *data = (unsigned char*)((ks_str)ob)->data;
+        *len_b = ((ks_str)ob)->len_b;
+        return true;
+    }
+
+    KS_THROW(kst_TypeError, "Expected a bytes-like object, but got '%T'", ob);
+    return false;
+}
+
+
+/* Type Functions */
+
+static KS_TFUNC(T, free) {
+    ks_memoryview self;
+    KS_ARGS("self:*", &self, kst_memoryview);
+
+    if (kso_issub(self->obj->type, kst_bytearray)) {
+        ((ks_bytearray)self->obj)->n_views--;
+    }
+    KS_DECREF(self->obj);
+
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, new) {
+    ks_type tp;
+    kso obj;
+    int nargs;
+    kso* args;
+    KS_ARGS("tp:* obj *args", &tp, kst_type, &obj, &nargs, &args);
+
+    if (nargs == 0 && kso_issub(obj->type, kst_memoryview)) {
+        return KS_NEWREF(obj);
+    } else if (nargs == 0 && kso_issub(obj->type, kst_bytearray)) {
+        ks_bytearray b = (ks_bytearray)obj;
+        return (kso)ks_memoryview_new(obj, b->data, b->len_b, false);
+    } else if (nargs == 0 && KS_TYPE_HAS(obj->type, KS_TF_BYTES)) {
+        ks_bytes b = (ks_bytes)obj;
+        return (kso)ks_memoryview_new(obj, b->data, b->len_b, true);
+    } else if (nargs == 0 && KS_TYPE_HAS(obj->type, KS_TF_STR)) {
+        ks_str s = (ks_str)obj;
+        return (kso)ks_memoryview_new(obj, s->data, s->len_b, true);
+    }
+
+    /* Let the object expose its own memory */
+    ks_str key = ks_str_new(-1, "__memoryview");
+    kso f = kso_getattr(obj, key);
+    KS_DECREF(key);
+    if (!f) {
+        kso_catch_ignore();
+        KS_THROW(kst_TypeError, "Cannot create '%R' of '%T' object", tp, obj);
+        return NULL;
+    }
+
+    kso res = kso_call(f, nargs, args);
+    KS_DECREF(f);
+    if (!res) return NULL;
+    if (!kso_issub(res->type, kst_memoryview)) {
+        KS_THROW(kst_TypeError, "'%T.__memoryview()' returned non-'memoryview' object of type '%T'", obj, res);
+        KS_DECREF(res);
+        return NULL;
+    }
+
+    return res;
+}
+
+static KS_TFUNC(T, repr) {
+    ks_memoryview self;
+    KS_ARGS("self:*", &self, kst_memoryview);
+
+    return (kso)ks_fmt("<%T of %T (%l bytes)>", self, self->obj, (ks_cint)self->len_b);
+}
+
+static KS_TFUNC(T, bytes) {
+    ks_memoryview self;
+    KS_ARGS("self:*", &self, kst_memoryview);
+
+    return (kso)ks_bytes_new(self->len_b, (char*)self->data);
+}
+
+static KS_TFUNC(T, bool) {
+    ks_memoryview self;
+    KS_ARGS("self:*", &self, kst_memoryview);
+
+    return KSO_BOOL(self->len_b != 0);
+}
+
+static KS_TFUNC(T, len) {
+    ks_memoryview self;
+    KS_ARGS("self:*", &self, kst_memoryview);
+
+    return (kso)ks_int_new(self->len_b);
+}
+
+static KS_TFUNC(T, eq) {
+    kso L, R;
+    KS_ARGS("L R", &L, &R);
+
+    unsigned char *dL, *dR;
+    ks_ssize_t nL, nR;
+    if (kso_is_buf(L) && kso_is_buf(R) && !KS_TYPE_HAS(L->type, KS_TF_STR) && !KS_TYPE_HAS(R->type, KS_TF_STR)) {
+        if (!kso_get_buf(L, false, &dL, &nL) || !kso_get_buf(R, false, &dR, &nR)) return NULL;
+        return KSO_BOOL(nL == nR && memcmp(dL, dR, nL) == 0);
+    }
+
+    return KSO_UNDEFINED;
+}
+
+static KS_TFUNC(T, getelem) {
+    ks_memoryview self;
+    kso idx;
+    KS_ARGS("self:* idx", &self, kst_memoryview, &idx);
+
+    if (kso_issub(idx->type, kst_slice)) {
+        ks_cint first, last, delta;
+        if (!ks_slice_get_citer((ks_slice)idx, self->len_b, &first, &last, &delta)) return NULL;
+        if (delta != 1 && first != last) {
+            KS_THROW(kst_ValError, "'%T' slices must be contiguous (step of 1)", self);
+            return NULL;
+        }
+        if (last < first) last = first;
+
+        /* Sub-views reference the original owner */
+        return (kso)ks_memoryview_new(self->obj, self->data + first, last - first, self->readonly);
+    }
+
+    ks_cint i;
+    if (!kso_get_ci(idx, &i)) return NULL;
+    if (i < 0) i += self->len_b;
+    if (i < 0 || i >= self->len_b) {
+        KS_THROW_INDEX(self, idx);
+        return NULL;
+    }
+
+    return (kso)ks_int_new(self->data[i]);
+}
+
+static KS_TFUNC(T, setelem) {
+    ks_memoryview self;
+    kso idx, val;
+    KS_ARGS("self:* idx val", &self, kst_memoryview, &idx, &val);
+
+    if (self->readonly) {
+        KS_THROW(kst_TypeError, "'%T' object is read-only", self);
+        return NULL;
+    }
+
+    if (kso_issub(idx->type, kst_slice)) {
+        ks_cint first, last, delta;
+        if (!ks_slice_get_citer((ks_slice)idx, self->len_b, &first, &last, &delta)) return NULL;
+        if (delta != 1 && first != last) {
+            KS_THROW(kst_ValError, "'%T' slices must be contiguous (step of 1)", self);
+            return NULL;
+        }
+        if (last < first) last = first;
+
+        unsigned char* data;
+        ks_ssize_t len_b;
+        if (!kso_get_buf(val, false, &data, &len_b)) return NULL;
+        if (len_b != last - first) {
+            KS_THROW(kst_SizeError, "Cannot resize '%T' object (attempted to assign %l bytes to slice of size %l)", self, (ks_cint)len_b, last - first);
+            return NULL;
+        }
+        memmove(self->data + first, data, len_b);
+
+        return KSO_NONE;
+    }
+
+    ks_cint i, v;
+    if (!kso_get_ci(idx, &i)) return NULL;
+    if (i < 0) i += self->len_b;
+    if (i < 0 || i >= self->len_b) {
+        KS_THROW_INDEX(self, idx);
+        return NULL;
+    }
+    if (!kso_get_ci(val, &v)) return NULL;
+    if (v < 0 || v > 255) {
+        KS_THROW(kst_ValError, "Byte values must be in range(256), but got %l", v);
+        return NULL;
+    }
+    self->data[i] = v;
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(T, getattr) {
+    ks_memoryview self;
+    ks_str attr;
+    KS_ARGS("self:* attr:*", &self, kst_memoryview, &attr, kst_str);
+
+    if (ks_str_eq_c(attr, "obj", 3)) {
+        return KS_NEWREF(self->obj);
+    } else if (ks_str_eq_c(attr, "readonly", 8)) {
+        return KSO_BOOL(self->readonly);
+    }
+
+    KS_THROW_ATTR(self, attr);
+    return NULL;
+}
+
+
+/* Export */
+
+static struct ks_type_s tp;
+ks_type kst_memoryview = &tp;
+
+void _ksi_memoryview() {
+    _ksinit(kst_memoryview, kst_object, T_NAME, sizeof(struct ks_memoryview_s), -1, "View of the memory of another object, which does not copy it\n\n    Works on 'bytes', 'str', and 'bytearray' (which is writable), as well as any object with a '__memoryview(self, *args)' method (such as 'nx.array' and 'ffi' pointers)\n\n    Slicing a view (with a step of 1) creates another view of the same memory", KS_IKV(
+        {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
+        {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, obj, *args)", "")},
+        {"__repr",               ksf_wrap(T_repr_, T_NAME ".__repr(self)", "")},
+        {"__str",                ksf_wrap(T_repr_, T_NAME ".__str(self)", "")},
+        {"__getattr",            ksf_wrap(T_getattr_, T_NAME ".__getattr(self, attr)", "")},
+        {"__bytes",              ksf_wrap(T_bytes_, T_NAME ".__bytes(self)", "")},
+        {"__bool",               ksf_wrap(T_bool_, T_NAME ".__bool(self)", "")},
+        {"__len",                ksf_wrap(T_len_, T_NAME ".__len(self)", "")},
+        {"__eq",                 ksf_wrap(T_eq_, T_NAME ".__eq(L, R)", "")},
+        {"__getelem",            ksf_wrap(T_getelem_, T_NAME ".__getelem(self, idx)", "")},
+        {"__setelem",            ksf_wrap(T_setelem_, T_NAME ".__setelem(self, idx, val)", "")},
+    ));
+}
@@ -12,6 +12,7 @@
 
 ks_module ks_module_new(const char* name, const char* source, const char* doc, struct ks_ikv* ikv) {
     ks_module self = KSO_NEW(ks_module, kst_module);
+    self->attr = ks_dict_new(NULL);
 
     ks_dict_merge_ikv(self->attr, KS_IKV(
         {"__name",                 (kso)ks_str_new(-1, name)},
@@ -52,9 +53,9 @@ static KS_TFUNC(T, str) {
     ks_module self;
     KS_ARGS("self:*", &self, kst_module);
 
-    kso name = ks_dict_get_h(self->attr, (kso)_ksva__name, _ksva__name->v_hash);
+    kso name = ks_dict_get_h(self->attr, (kso)_ksva__name, KS_STR_HASH(_ksva__name));
     assert(name != NULL);
-    kso src = ks_dict_get_h(self->attr, (kso)_ksva__src, _ksva__src->v_hash);
+    kso src = ks_dict_get_h(self->attr, (kso)_ksva__src, KS_STR_HASH(_ksva__src));
     assert(src != NULL);
 
     ks_str res = ks_fmt("<%R module from %R>", name, src);
@@ -69,7 +70,7 @@ static KS_TFUNC(T, getattr) {
     ks_str attr;
     KS_ARGS("self:* attr:*", &self, kst_module, &attr, kst_str);
 
-    kso res = ks_dict_get_ih(self->attr, (kso)attr, attr->v_hash);
+    kso res = ks_dict_get_ih(self->attr, (kso)attr, KS_STR_HASH(attr));
     if (res) {
         return res;
     } else {
@@ -80,7 +81,7 @@ static KS_TFUNC(T, getattr) {
             KS_THROW_ATTR(self, attr);
             return NULL;
         } else {
-            ks_dict_set_h(self->attr, (kso)attr, attr->v_hash, (kso)submod);
+            ks_dict_set_h(self->attr, (kso)attr, KS_STR_HASH(attr), (kso)submod);
             return (kso)submod;
         }
     }
@@ -12,6 +12,7 @@
 
 ks_names ks_names_new(ks_dict of, bool copy) {
     ks_names self = KSO_NEW(ks_names, kst_names);
+    self->attr = ks_dict_new(NULL);
 
     ks_dict_merge(self->attr, of);
 
@@ -13,6 +13,7 @@
 #include <ks/ucd.h>
 
 #define T_NAME "regex"
+#define TI_NAME "regex.iter"
 
 
 /* Internals */
@@ -269,7 +270,7 @@ static bool parse_item(struct state* ps) {
 
     } else if (*ps->expr == '\\') {
         ps->expr++;
-        char c = *ps->expr;
+        unsigned char c = *ps->expr;
         ps->expr++;
 
         /* Allow escapes */
@@ -348,7 +349,7 @@ static bool parse_item(struct state* ps) {
 
     } else {
         s = new_state(ps, KS_REGEX_NFA_UCP);
-        NODE(s).ucp = *ps->expr++;
+        NODE(s).ucp = (unsigned char)*ps->expr++;
     }
 
     if (s < 0) return false;
@@ -454,9 +455,81 @@ static bool parse_regex(struct state* ps) {
 }
 
 
-/* C-API */
+/* Whether a (consuming) state accepts a character */
+static bool s_accepts(struct ks_regex_nfa* s, ks_ucp c) {
+    int j;
+    if (s->kind == KS_REGEX_NFA_ANY || s->kind == KS_REGEX_NFA_NOT) {
+        bool good = false;
+        if (c < 256) {
+            good = s->set.has_byte[c];
+        } else {
+            for (j = 0; j < s->set.n_ext; ++j) {
+                if (c == s->set.ext[j]) {
+                    good = true;
+                    break;
+                }
+            }
+        }
+        return s->kind == KS_REGEX_NFA_ANY ? good : !good;
+    } else if (s->kind == KS_REGEX_NFA_UCP) {
+        return s->ucp == c;
+    } else if (s->kind == KS_REGEX_NFA_CAT) {
+        struct ksucd_info info;
+        ks_ucp cp = ksucd_get_info(&info, c);
+        return cp > 0 && s->set.has_cat[info.cat_gen];
+    }
 
-ks_regex ks_regex_newt(ks_type tp, ks_str expr) {
+    return false;
+}
+
+/* Whether a state consumes a character (instead of being an epsilon transition) */
+static bool s_consumes(struct ks_regex_nfa* s) {
+    return s->kind == KS_REGEX_NFA_UCP || s->kind == KS_REGEX_NFA_CAT || s->kind == KS_REGEX_NFA_ANY || s->kind == KS_REGEX_NFA_NOT;
+}
+
+/* Compute the byte classes, by splitting every class by whether each state accepts its bytes */
+static void make_bcls(ks_regex self) {
+    int i, b;
+    for (b = 0; b < 256; ++b) self->bcls[b] = 0;
+    self->n_bcls = 1;
+
+    for (i = 0; i < self->n_states; ++i) {
+        struct ks_regex_nfa* s = &self->states[i];
+        if (!s_consumes(s)) continue;
+
+        /* New class of each (old class, accepted) pair */
+        int map[256][2];
+        for (b = 0; b < self->n_bcls; ++b) map[b][0] = map[b][1] = -1;
+
+        int n = 0;
+        for (b = 0; b < 256; ++b) {
+            int* k = &map[self->bcls[b]][s_accepts(s, b)];
+            if (*k < 0) *k = n++;
+            self->bcls[b] = *k;
+        }
+        self->n_bcls = n;
+    }
+}
+
+static void make_lits(ks_regex self);
+static void dfa_free(struct ks_regex_dfa* dfa);
+static bool s_run(ks_regex self, ks_ssize_t len_b, const unsigned char* data, bool una);
+static int s_search(ks_regex self, ks_ssize_t len_b, const unsigned char* data, ks_ssize_t from, bool at0, bool is_end, ks_ssize_t* start, ks_ssize_t* stop, ks_ssize_t* keep);
+static int it_next(ks_regex_iter self, ks_ssize_t* start, ks_ssize_t* stop);
+static bool it_emit(ks_regex_iter self, ks_ssize_t to);
+
+
+/* Cache of compiled regexes (of type 'regex'), keyed by their expression, in order of least to most recently used */
+static ks_dict cache = NULL;
+
+/* Maximum number of regexes in the cache (each of which may have DFAs of up to 'DFA_MAXB' bytes) */
+#define CACHE_MAX 64
+
+/* Number of hits and misses of the cache */
+static ks_cint cache_hits = 0, cache_misses = 0;
+
+/* Compile an expression into a new regex */
+static ks_regex s_compile(ks_type tp, ks_str expr) {
 
     struct state ps_;
     struct state* ps = &ps_;
@@ -519,9 +592,57 @@ ks_regex ks_regex_newt(ks_type tp, ks_str expr) {
 
     self->n_states = ps->n_states;
     self->states = ps->states;
+    self->tags = NULL;
+
+    make_bcls(self);
+    make_lits(self);
+    self->_dfa[0] = self->_dfa[1] = NULL;
+
     return self;
 }
 
+
+/* C-API */
+
+ks_regex ks_regex_newt(ks_type tp, ks_str expr) {
+    if (tp != kst_regex) return s_compile(tp, expr);
+    if (!cache) cache = ks_dict_new(NULL);
+
+    ks_hash_t h = KS_STR_HASH(expr);
+    ks_regex res = (ks_regex)ks_dict_get_ih(cache, (kso)expr, h);
+    bool existed;
+    if (res) {
+        cache_hits++;
+
+        /* Move to the end, as the most recently used */
+        if (cache->ents[cache->len_ents - 1].val != (kso)res) {
+            ks_dict_del_h(cache, (kso)expr, h, &existed);
+            ks_dict_set_h(cache, (kso)expr, h, (kso)res);
+        }
+        return res;
+    }
+
+    cache_misses++;
+    res = s_compile(tp, expr);
+    if (!res) return NULL;
+
+    if (cache->len_real >= CACHE_MAX) {
+        /* Evict the least recently used, which is the first entry */
+        ks_size_t i = 0;
+        while (!cache->ents[i].key) i++;
+        ks_dict_del_h(cache, cache->ents[i].key, cache->ents[i].hash, &existed);
+    }
+    ks_dict_set_h(cache, (kso)expr, h, (kso)res);
+
+    return res;
+}
+
+void ks_regex_cache_info(ks_cint* hits, ks_cint* misses, ks_cint* size) {
+    *hits = cache_hits;
+    *misses = cache_misses;
+    *size = cache ? cache->len_real : 0;
+}
+
 ks_regex ks_regex_new(ks_str expr) {
     return ks_regex_newt(kst_regex, expr);
 }
@@ -551,65 +672,183 @@ ks_regex ks_regex_newlit(ks_str expr) {
     return res;
 }
 
+ks_regex ks_regex_newset(int n, ks_regex* regs) {
+    ksio_StringIO sio = ksio_StringIO_new();
+    int i, j, ns = (n > 0 ? n : 1) + 1;
+    for (i = 0; i < n; ++i) {
+        ksio_add(sio, "%s(%S)", i > 0 ? "|" : "", regs[i]->expr);
+        ns += regs[i]->n_states;
+    }
+
+    ks_regex self = KSO_NEW(ks_regex, kst_regex);
+    self->expr = ksio_StringIO_getf(sio);
+    self->n_states = ns;
+    self->states = ks_zmalloc(sizeof(*self->states), ns);
+    self->tags = ks_zmalloc(sizeof(*self->tags), ns);
+    for (i = 0; i < ns; ++i) self->tags[i] = -1;
+
+    /* States '0, ..., n-1' choose a regex, then come the states of each regex, then the final state */
+    self->s0 = 0;
+    self->sf = ns - 1;
+    int off = n;
+    for (i = 0; i < n; ++i) {
+        ks_regex r = regs[i];
+        for (j = 0; j < r->n_states; ++j) {
+            struct ks_regex_nfa* s = &self->states[off + j];
+            *s = r->states[j];
+            if (s->to0 >= 0) s->to0 += off;
+            if (s->to1 >= 0) s->to1 += off;
+            if (s->kind == KS_REGEX_NFA_ANY || s->kind == KS_REGEX_NFA_NOT) {
+                s->set.has_byte = ks_malloc(sizeof(bool) * 256);
+                memcpy(s->set.has_byte, r->states[j].set.has_byte, sizeof(bool) * 256);
+                s->set.has_cat = ks_malloc(sizeof(bool) * 64);
+                memcpy(s->set.has_cat, r->states[j].set.has_cat, sizeof(bool) * 64);
+                s->set.ext = NULL;
+                if (s->set.n_ext > 0) {
+                    s->set.ext = ks_malloc(sizeof(*s->set.ext) * s->set.n_ext);
+                    memcpy(s->set.ext, r->states[j].set.ext, sizeof(*s->set.ext) * s->set.n_ext);
+                }
+            }
+        }
+
+        /* The end of each regex leads to the final state, and is tagged */
+        struct ks_regex_nfa* e = &self->states[off + r->sf];
+        e->kind = KS_REGEX_NFA_EPS;
+        e->to0 = self->sf;
+        e->to1 = -1;
+        self->tags[off + r->sf] = i;
+
+        self->states[i].kind = KS_REGEX_NFA_EPS;
+        self->states[i].to0 = off + r->s0;
+        self->states[i].to1 = i < n - 1 ? i + 1 : -1;
+
+        off += r->n_states;
+    }
+    self->states[self->sf].kind = KS_REGEX_NFA_END;
+    self->states[self->sf].to0 = self->states[self->sf].to1 = -1;
+    if (n == 0) {
+        /* Matches nothing */
+        self->states[0].kind = KS_REGEX_NFA_NOT;
+        self->states[0].to0 = self->states[0].to1 = -1;
+        self->states[0].set.has_byte = ks_zmalloc(sizeof(bool), 256);
+        self->states[0].set.has_cat = ks_zmalloc(sizeof(bool), 64);
+        for (i = 0; i < 256; ++i) self->states[0].set.has_byte[i] = true;
+        for (i = 0; i < 64; ++i) self->states[0].set.has_cat[i] = false;
+        self->states[0].set.n_ext = 0;
+        self->states[0].set.ext = NULL;
+    }
+
+    make_bcls(self);
+    make_lits(self);
+    self->_dfa[0] = self->_dfa[1] = NULL;
+
+    return self;
+}
+
 
 
 
 /* High level interface */
 
 bool ks_regex_exact(ks_regex self, ks_str str) {
-    ks_regex_sim0 sim;
-    ks_regex_sim0_init(&sim, self->n_states, self->states);
+    return s_run(self, str->len_b, (const unsigned char*)str->data, false);
+}
 
-    int i;
+bool ks_regex_matches(ks_regex self, ks_str str) {
+    return s_run(self, str->len_b, (const unsigned char*)str->data, true);
+}
 
-    /* Start at the initial state */
-    ks_regex_sim0_addcur(&sim, self->s0);
+bool ks_regex_search(ks_regex self, ks_str str, ks_ssize_t from, ks_ssize_t* start, ks_ssize_t* stop) {
+    ks_ssize_t keep;
+    return s_search(self, str->len_b, (const unsigned char*)str->data, from, from == 0, true, start, stop, &keep) > 0;
+}
+
+ks_regex_iter ks_regex_finditer(ks_regex self, kso src) {
+    bool is_str = kso_issub(src->type, kst_str);
+    if (!is_str && !kso_issub(src->type, ksiot_BaseIO)) {
+        KS_THROW(kst_TypeError, "Expected either 'str' or 'io.BaseIO' to search, but got '%T'", src);
+        return NULL;
+    }
 
-    ks_regex_sim0_step_linestart(&sim);
+    ks_regex_iter res = KSO_NEW(ks_regex_iter, kst_regex_iter);
 
+    KS_INCREF(self);
+    res->pat = self;
+    KS_INCREF(src);
+    res->src = src;
 
-    /* Step through input */
-    const char* p = str->data;
-    while (*p) {
-        ks_regex_sim0_step(&sim, *p);
-        p++;
+    if (is_str) {
+        res->data = (unsigned char*)((ks_str)src)->data;
+        res->len_b = res->max_len_b = ((ks_str)src)->len_b;
+        res->eof = true;
+    } else {
+        res->data = NULL;
+        res->len_b = res->max_len_b = 0;
+        res->eof = false;
     }
 
-    /* Check if a valid end state */
-    ks_regex_sim0_step_lineend(&sim);
+    res->base_b = res->pos = 0;
+    res->cur_b = res->cur_c = 0;
+    res->out = NULL;
+    res->emit = 0;
+    res->done = false;
 
-    bool res = sim.cur[self->sf];
-    ks_regex_sim0_free(&sim);
     return res;
 }
 
-bool ks_regex_matches(ks_regex self, ks_str str) {
-    ks_regex_sim0 sim;
-    ks_regex_sim0_init(&sim, self->n_states, self->states);
+bool ks_regex_sub(ks_regex self, kso src, kso repl, kso out) {
+    bool is_f = !kso_issub(repl->type, kst_str);
+    if (is_f && !kso_is_callable(repl)) {
+        KS_THROW(kst_TypeError, "Expected either 'str' or a function to replace with, but got '%T'", repl);
+        return false;
+    } else if (!kso_issub(out->type, ksiot_BaseIO)) {
+        KS_THROW(kst_TypeError, "Expected 'io.BaseIO' to write to, but got '%T'", out);
+        return false;
+    }
 
-    int i;
-    ks_regex_sim0_addcur(&sim, self->s0);
-    ks_regex_sim0_step_linestart(&sim);
+    ks_regex_iter it = ks_regex_finditer(self, src);
+    if (!it) return false;
+    KS_INCREF(out);
+    it->out = out;
+
+    ks_ssize_t start, stop;
+    int r;
+    while ((r = it_next(it, &start, &stop)) > 0) {
+        if (!it_emit(it, start)) {
+            r = -1;
+            break;
+        }
 
+        ks_str rs = (ks_str)repl;
+        if (is_f) {
+            ks_str m = ks_str_new(stop - start, (char*)it->data + start);
+            rs = (ks_str)kso_call(repl, 1, (kso[]){ (kso)m });
+            KS_DECREF(m);
+            if (!rs) {
+                r = -1;
+                break;
+            } else if (!kso_issub(rs->type, kst_str)) {
+                KS_THROW(kst_TypeError, "Replacement function returned non-'str' object of type '%T'", rs);
+                KS_DECREF(rs);
+                r = -1;
+                break;
+            }
+        }
 
-    /* Step through input */
-    const char* p = str->data;
-    while (*p) {
-        ks_regex_sim0_step(&sim, *p);
-        if (sim.cur[self->sf]) {
-            ks_regex_sim0_free(&sim);
-            return true;
+        bool ok = ksio_writes((ksio_BaseIO)out, rs->len_b, rs->data);
+        if (is_f) KS_DECREF(rs);
+        if (!ok) {
+            r = -1;
+            break;
         }
-        p++;
-        ks_regex_sim0_addcur(&sim, self->s0);
+        it->emit = stop;
     }
-    
-    ks_regex_sim0_addcur(&sim, self->s0);
-    ks_regex_sim0_step_lineend(&sim);
 
-    bool res = sim.cur[self->sf];
-    ks_regex_sim0_free(&sim);
-    return res;
+    /* Write whatever is left after the last match */
+    if (r == 0 && !it_emit(it, it->len_b)) r = -1;
+
+    KS_DECREF(it);
+    return r == 0;
 }
 
 
@@ -635,16 +874,21 @@ void ks_regex_sim0_free(ks_regex_sim0* sim) {
     ks_free(sim->next);
 }
 
-static void add_state(ks_regex_sim0* sim, bool* ptr, int s) {
+/* Add a state, and everything reachable through epsilon transitions */
+static void add_closure(struct ks_regex_nfa* states, bool* ptr, int s) {
     if (s < 0 || ptr[s]) return;
     ptr[s] = true;
-    if (sim->states[s].kind == KS_REGEX_NFA_EPS) {
-        add_state(sim, ptr, sim->states[s].to0);
-        add_state(sim, ptr, sim->states[s].to1);
+    if (states[s].kind == KS_REGEX_NFA_EPS) {
+        add_closure(states, ptr, states[s].to0);
+        add_closure(states, ptr, states[s].to1);
         return;
     }
 }
 
+static void add_state(ks_regex_sim0* sim, bool* ptr, int s) {
+    add_closure(sim->states, ptr, s);
+}
+
 void ks_regex_sim0_addcur(ks_regex_sim0* sim, int s) {
     add_state(sim, sim->cur, s);
 }
@@ -702,60 +946,14 @@ int ks_regex_sim0_step_lineend(ks_regex_sim0* sim) {
 /* Apply a single character to the simulator
  */
 int ks_regex_sim0_step(ks_regex_sim0* sim, ks_ucp c) {
-    int i, j, ct = 0;
+    int i, ct = 0;
     for (i = 0; i < sim->n_states; ++i) sim->next[i] = false;
     for (i = 0; i < sim->n_states; ++i) {
         if (sim->cur[i]) {
             struct ks_regex_nfa* s = &sim->states[i];
-            bool good = false;
-
-            /* Check classes */
-            if (s->kind == KS_REGEX_NFA_ANY) {
-                if (c < 256) {
-                    good = s->set.has_byte[c];
-                } else {
-                    for (j = 0; j < s->set.n_ext; ++j) {
-                        if (c == s->set.ext[j]) {
-                            good = true;
-                            break;
-                        }
-                    }
-                }
-
-                if (good) {
-                    ct++;
-                    ks_regex_sim0_addnext(sim, s->to0);
-                }
-            } else if (s->kind == KS_REGEX_NFA_NOT) {
-                if (c < 256) {
-                    good = s->set.has_byte[c];
-                } else {
-                    for (j = 0; j < s->set.n_ext; ++j) {
-                        if (c == s->set.ext[j]) {
-                            good = true;
-                            break;
-                        }
-                    }
-                }
-
-                if (!good) {
-                    ct++;
-                    ks_regex_sim0_addnext(sim, s->to0);
-                }
-            } else if (s->kind == KS_REGEX_NFA_UCP) {
-                if (s->ucp == c) {
-                    ct++;
-                    ks_regex_sim0_addnext(sim, s->to0);
-                }
-            } else if (s->kind == KS_REGEX_NFA_CAT) {
-                struct ksucd_info info;
-                ks_ucp cp = ksucd_get_info(&info, c);
-                if (cp > 0) {
-                    if (s->set.has_cat[info.cat_gen]) {
-                        ct++;
-                        ks_regex_sim0_addnext(sim, s->to0);
-                    }
-                }
+            if (s_accepts(s, c)) {
+                ct++;
+                ks_regex_sim0_addnext(sim, s->to0);
             }
         }
     }
@@ -768,7 +966,850 @@ int ks_regex_sim0_step(ks_regex_sim0* sim, ks_ucp c) {
     return ct;
 }
 
-/* Type Functions */
+/* Lazy DFA
+ *
+ * Each DFA state is a set of NFA states, and is only created the first time a transition to it is taken. States are
+ *   memoized by their set, and transitions are on byte classes instead of bytes. A regex keeps one DFA for anchored
+ *   matching ('exact'), and one for unanchored matching ('matches'), in which a match may start at every position. For
+ *   the unanchored DFA, the sets only hold matches in progress, and the closure of the initial NFA state is added
+ *   when stepping (so, the empty set means that no match is in progress)
+ *
+ * The memory of each DFA is bounded by 'DFA_MAXB' (past the first 'DFA_MINN' states). Once that is reached, the NFA
+ *   simulator continues from the current set of states, so matching is linear time either way
+ */
+
+/* Maximum bytes used by a single DFA */
+#define DFA_MAXB (1 << 20)
+
+/* Number of DFA states that are always allowed, regardless of 'DFA_MAXB' (large NFAs, such as the union of the rules
+ *   of a lexer, have large sets, and would otherwise be starting over constantly)
+ */
+#define DFA_MINN 4096
+
+/* Transition which has not been computed yet */
+#define DFA_UNK (-1)
+
+struct ks_regex_dfa {
+
+    /* Whether the initial NFA state is re-added after every step */
+    bool una;
+
+    /* Number of words in each set of NFA states */
+    int n_w;
+
+    /* Number of DFA states, and the capacity */
+    int n, max_n;
+
+    /* Sets of NFA states (bitsets of 'n_w' words for each DFA state) */
+    ks_uint64_t* sets;
+
+    /* Transitions ('n_bcls' for each DFA state) */
+    int* trans;
+
+    /* Whether each DFA state contains the final state, now and at the end of input */
+    bool* acc;
+    bool* acc_end;
+
+    /* For tagged regexes, the smallest tag of the ends in each DFA state (or -1) */
+    int* tag;
+
+    /* Hash table of DFA states by their set, with linear probing ('-1' for empty buckets) */
+    int n_buckets;
+    int* buckets;
+
+    /* Initial DFA state, and the DFA state with no NFA states (or '-1' if it hasn't been created) */
+    int s0, dead;
+
+    /* Initial DFA state when not at the start of the input (i.e. without '^'), which for unanchored DFAs is also the
+     *   state where no match is in progress
+     */
+    int s0r;
+
+    /* Scratch sets of NFA states */
+    bool* cur;
+    bool* next;
+    bool* tmp;
+
+    /* For unanchored DFAs, the closure of the initial NFA state, which is implicitly part of every DFA state */
+    bool* c0;
+
+    /* A byte in each class */
+    unsigned char rep[256];
+
+    /* Total bytes allocated */
+    ks_size_t sz_b;
+
+};
+
+/* Apply an anchor ('KS_REGEX_NFA_LINESTART' or 'KS_REGEX_NFA_LINEEND') to 'cur', storing in 'next' */
+static void s_anchor(ks_regex self, bool* cur, bool* next, int kind) {
+    int i;
+    for (i = 0; i < self->n_states; ++i) next[i] = cur[i];
+    for (i = 0; i < self->n_states; ++i) {
+        if (cur[i] && self->states[i].kind == kind) {
+            add_closure(self->states, next, self->states[i].to0);
+        }
+    }
+}
+
+/* Find (or create) the DFA state for a set of NFA states, or return '-1' if the DFA is full */
+static int dfa_add(ks_regex self, struct ks_regex_dfa* dfa, bool* set) {
+    ks_uint64_t w[dfa->n_w];
+    int i;
+    for (i = 0; i < dfa->n_w; ++i) w[i] = 0;
+    bool empty = true;
+    for (i = 0; i < self->n_states; ++i) {
+        if (set[i]) {
+            w[i / 64] |= (ks_uint64_t)1 << (i % 64);
+            empty = false;
+        }
+    }
+
+    ks_hash_t h = ks_hash_bytes(sizeof(w), (const unsigned char*)w);
+    int b = h % dfa->n_buckets;
+    while (dfa->buckets[b] >= 0) {
+        int d = dfa->buckets[b];
+        if (memcmp(&dfa->sets[d * dfa->n_w], w, sizeof(w)) == 0) return d;
+        b = (b + 1) % dfa->n_buckets;
+    }
+
+    /* Need to create a new DFA state, so make sure it fits */
+    ks_size_t sz_b = sizeof(w) + sizeof(*dfa->trans) * self->n_bcls + 2 * sizeof(bool) + sizeof(*dfa->tag) + 2 * sizeof(*dfa->buckets);
+    if (dfa->sz_b + sz_b > DFA_MAXB && dfa->n >= DFA_MINN) return -1;
+    dfa->sz_b += sz_b;
+
+    int d = dfa->n++;
+    if (dfa->n > dfa->max_n) {
+        dfa->max_n = ks_nextsize(dfa->max_n, dfa->n);
+        dfa->sets = ks_zrealloc(dfa->sets, sizeof(*dfa->sets), dfa->max_n * dfa->n_w);
+        dfa->trans = ks_zrealloc(dfa->trans, sizeof(*dfa->trans), dfa->max_n * self->n_bcls);
+        dfa->acc = ks_zrealloc(dfa->acc, sizeof(*dfa->acc), dfa->max_n);
+        dfa->acc_end = ks_zrealloc(dfa->acc_end, sizeof(*dfa->acc_end), dfa->max_n);
+        if (self->tags) dfa->tag = ks_zrealloc(dfa->tag, sizeof(*dfa->tag), dfa->max_n);
+    }
+
+    memcpy(&dfa->sets[d * dfa->n_w], w, sizeof(w));
+    for (i = 0; i < self->n_bcls; ++i) dfa->trans[d * self->n_bcls + i] = DFA_UNK;
+    bool* all = set;
+    if (dfa->una) {
+        all = dfa->tmp;
+        for (i = 0; i < self->n_states; ++i) all[i] = set[i] || dfa->c0[i];
+    }
+    dfa->acc[d] = all[self->sf];
+    bool* tmp = set == dfa->cur ? dfa->next : dfa->cur;
+    s_anchor(self, all, tmp, KS_REGEX_NFA_LINEEND);
+    dfa->acc_end[d] = tmp[self->sf];
+    if (empty) dfa->dead = d;
+    if (self->tags) {
+        dfa->tag[d] = -1;
+        for (i = 0; i < self->n_states; ++i) {
+            if (set[i] && self->tags[i] >= 0 && (dfa->tag[d] < 0 || self->tags[i] < dfa->tag[d])) dfa->tag[d] = self->tags[i];
+        }
+    }
+
+    dfa->buckets[b] = d;
+    if (2 * dfa->n > dfa->n_buckets) {
+        /* Rehash into a larger table */
+        ks_size_t j;
+        dfa->n_buckets *= 2;
+        dfa->buckets = ks_zrealloc(dfa->buckets, sizeof(*dfa->buckets), dfa->n_buckets);
+        for (j = 0; j < dfa->n_buckets; ++j) dfa->buckets[j] = -1;
+        for (i = 0; i < dfa->n; ++i) {
+            h = ks_hash_bytes(sizeof(w), (const unsigned char*)&dfa->sets[i * dfa->n_w]);
+            b = h % dfa->n_buckets;
+            while (dfa->buckets[b] >= 0) b = (b + 1) % dfa->n_buckets;
+            dfa->buckets[b] = i;
+        }
+    }
+
+    return d;
+}
+
+/* Compute the initial set of NFA states into 'res' (using 'tmp' as scratch) */
+static void s_startset(ks_regex self, bool* res, bool* tmp) {
+    int i;
+    for (i = 0; i < self->n_states; ++i) tmp[i] = false;
+    add_closure(self->states, tmp, self->s0);
+    s_anchor(self, tmp, res, KS_REGEX_NFA_LINESTART);
+}
+
+/* Create the initial DFA states */
+static void dfa_initial(ks_regex self, struct ks_regex_dfa* dfa) {
+    int i;
+    for (i = 0; i < self->n_states; ++i) dfa->cur[i] = false;
+    if (!dfa->una) add_closure(self->states, dfa->cur, self->s0);
+    dfa->s0r = dfa_add(self, dfa, dfa->cur);
+
+    s_startset(self, dfa->cur, dfa->next);
+    dfa->s0 = dfa_add(self, dfa, dfa->cur);
+}
+
+static struct ks_regex_dfa* dfa_new(ks_regex self, bool una) {
+    struct ks_regex_dfa* dfa = ks_malloc(sizeof(*dfa));
+
+    dfa->una = una;
+    dfa->n_w = (self->n_states + 63) / 64;
+    dfa->n = dfa->max_n = 0;
+    dfa->sets = NULL;
+    dfa->trans = NULL;
+    dfa->acc = dfa->acc_end = NULL;
+    dfa->tag = NULL;
+    dfa->n_buckets = 16;
+    dfa->buckets = ks_zmalloc(sizeof(*dfa->buckets), dfa->n_buckets);
+    dfa->dead = -1;
+    dfa->cur = ks_zmalloc(sizeof(*dfa->cur), self->n_states);
+    dfa->next = ks_zmalloc(sizeof(*dfa->next), self->n_states);
+    dfa->tmp = ks_zmalloc(sizeof(*dfa->tmp), self->n_states);
+    dfa->c0 = NULL;
+    dfa->sz_b = sizeof(*dfa);
+
+    int i;
+    for (i = 0; i < dfa->n_buckets; ++i) dfa->buckets[i] = -1;
+    for (i = 255; i >= 0; --i) dfa->rep[self->bcls[i]] = i;
+    if (una) {
+        dfa->c0 = ks_zmalloc(sizeof(*dfa->c0), self->n_states);
+        for (i = 0; i < self->n_states; ++i) dfa->c0[i] = false;
+        add_closure(self->states, dfa->c0, self->s0);
+    }
+
+    dfa_initial(self, dfa);
+
+    return dfa;
+}
+
+/* Throw away every DFA state (except the initial ones), which is done when the DFA is full */
+static void dfa_reset(ks_regex self, struct ks_regex_dfa* dfa) {
+    int i;
+    dfa->n = 0;
+    dfa->sz_b = sizeof(*dfa);
+    dfa->dead = -1;
+    for (i = 0; i < dfa->n_buckets; ++i) dfa->buckets[i] = -1;
+
+    dfa_initial(self, dfa);
+}
+
+static void dfa_free(struct ks_regex_dfa* dfa) {
+    if (!dfa) return;
+    ks_free(dfa->sets);
+    ks_free(dfa->trans);
+    ks_free(dfa->acc);
+    ks_free(dfa->acc_end);
+    ks_free(dfa->tag);
+    ks_free(dfa->buckets);
+    ks_free(dfa->cur);
+    ks_free(dfa->next);
+    ks_free(dfa->tmp);
+    ks_free(dfa->c0);
+    ks_free(dfa);
+}
+
+/* Compute (and memoize) the transition from DFA state 'd' on byte class 'cls', or return '-1' if the DFA is full */
+static int dfa_step(ks_regex self, struct ks_regex_dfa* dfa, int d, int cls) {
+    int i;
+    unsigned char c = dfa->rep[cls];
+    ks_uint64_t* w = &dfa->sets[d * dfa->n_w];
+    for (i = 0; i < self->n_states; ++i) dfa->cur[i] = false;
+    for (i = 0; i < self->n_states; ++i) {
+        if (((w[i / 64] >> (i % 64)) & 1) || (dfa->una && dfa->c0[i])) {
+            struct ks_regex_nfa* s = &self->states[i];
+            if (s_consumes(s) && s_accepts(s, c)) {
+                add_closure(self->states, dfa->cur, s->to0);
+            }
+        }
+    }
+
+    int r = dfa_add(self, dfa, dfa->cur);
+    if (r >= 0) dfa->trans[d * self->n_bcls + cls] = r;
+    return r;
+}
+
+/* Transition from DFA state 'd' on byte 'c', starting the DFA over if it is full (which invalidates other DFA states) */
+static int dfa_next(ks_regex self, struct ks_regex_dfa* dfa, int d, unsigned char c) {
+    int cls = self->bcls[c];
+    int nd = dfa->trans[d * self->n_bcls + cls];
+    if (nd == DFA_UNK) {
+        nd = dfa_step(self, dfa, d, cls);
+        if (nd < 0) {
+            /* 'dfa_step()' left the set of NFA states in 'cur' */
+            bool* set = ks_zmalloc(sizeof(*set), self->n_states);
+            memcpy(set, dfa->cur, sizeof(*set) * self->n_states);
+            dfa_reset(self, dfa);
+            nd = dfa_add(self, dfa, set);
+            ks_free(set);
+        }
+    }
+    return nd;
+}
+
+/* Continue with the NFA simulator from a set of states */
+static bool s_run_nfa(ks_regex self, bool* set, ks_ssize_t len_b, const unsigned char* data, bool una) {
+    ks_regex_sim0 sim;
+    ks_regex_sim0_init(&sim, self->n_states, self->states);
+
+    ks_ssize_t i;
+    for (i = 0; i < self->n_states; ++i) sim.cur[i] = set[i];
+
+    for (i = 0; i < len_b; ++i) {
+        ks_regex_sim0_step(&sim, data[i]);
+        if (una) {
+            if (sim.cur[self->sf]) {
+                ks_regex_sim0_free(&sim);
+                return true;
+            }
+            ks_regex_sim0_addcur(&sim, self->s0);
+        }
+    }
+
+    if (una) ks_regex_sim0_addcur(&sim, self->s0);
+    ks_regex_sim0_step_lineend(&sim);
+
+    bool res = sim.cur[self->sf];
+    ks_regex_sim0_free(&sim);
+    return res;
+}
+
+/* Literals
+ *
+ * Compiling a regex finds a literal prefix that every match starts with, and the longest literal that every match
+ *   contains. These are searched for with 'memchr()' (which is vectorized by the C library), so inputs which can't
+ *   match are rejected without running the automaton at all, and unanchored searches skip ahead to the next
+ *   occurrence of the prefix whenever no match is in progress
+ */
+
+/* Maximum length of the literals */
+#define LIT_MAX 64
+
+/* Maximum number of NFA states for which the required literal is computed */
+#define LIT_MAX_STATES 256
+
+/* Return the only byte a state accepts, or -1 */
+static int s_onebyte(struct ks_regex_nfa* s) {
+    if (s->kind == KS_REGEX_NFA_UCP) {
+        return s->ucp < 256 ? s->ucp : -1;
+    } else if (s->kind == KS_REGEX_NFA_ANY && s->set.n_ext == 0) {
+        int i, r = -1;
+        for (i = 0; i < 64; ++i) if (s->set.has_cat[i]) return -1;
+        for (i = 0; i < 256; ++i) {
+            if (s->set.has_byte[i]) {
+                if (r >= 0) return -1;
+                r = i;
+            }
+        }
+        return r;
+    }
+    return -1;
+}
+
+/* If the next byte consumed from a set of states must be consumed by a single state (which accepts a single byte),
+ *   return that state, otherwise -1
+ */
+static int s_onlynext(ks_regex self, bool* set) {
+    int i, r = -1;
+    for (i = 0; i < self->n_states; ++i) {
+        if (!set[i]) continue;
+        struct ks_regex_nfa* s = &self->states[i];
+        if (s_consumes(s)) {
+            if (r >= 0) return -1;
+            r = i;
+        } else if (s->kind != KS_REGEX_NFA_EPS) {
+            /* Anchors and the final state may end the match (or depend on the position) */
+            return -1;
+        }
+    }
+    return r >= 0 && s_onebyte(&self->states[r]) >= 0 ? r : -1;
+}
+
+/* Whether the final state is reachable from the initial state without going through 'v' */
+static bool s_reach_without(ks_regex self, int v, int* stk, bool* seen) {
+    int i, n = 0;
+    for (i = 0; i < self->n_states; ++i) seen[i] = false;
+    if (self->s0 == v) return false;
+    stk[n++] = self->s0;
+    seen[self->s0] = true;
+    while (n > 0) {
+        int u = stk[--n];
+        if (u == self->sf) return true;
+        int to[2] = { self->states[u].to0, self->states[u].to1 };
+        for (i = 0; i < 2; ++i) {
+            if (to[i] >= 0 && to[i] != v && !seen[to[i]]) {
+                seen[to[i]] = true;
+                stk[n++] = to[i];
+            }
+        }
+    }
+    return false;
+}
+
+static void make_lits(ks_regex self) {
+    int n = self->n_states, i, j;
+    bool* cur = ks_zmalloc(sizeof(*cur), n);
+    bool* tmp = ks_zmalloc(sizeof(*tmp), n);
+    unsigned char lit[LIT_MAX];
+
+    self->n_pre = self->n_req = 0;
+    self->pre = self->req = NULL;
+
+    /* Anchored if only '^' can start a match */
+    for (i = 0; i < n; ++i) cur[i] = false;
+    add_closure(self->states, cur, self->s0);
+    self->anchored = true;
+    for (i = 0; i < n; ++i) {
+        if (cur[i] && self->states[i].kind != KS_REGEX_NFA_EPS && self->states[i].kind != KS_REGEX_NFA_LINESTART) {
+            self->anchored = false;
+        }
+    }
+
+    /* Prefix, by following states while there is only one choice */
+    s_startset(self, cur, tmp);
+    int s;
+    while (self->n_pre < LIT_MAX && (s = s_onlynext(self, cur)) >= 0) {
+        lit[self->n_pre++] = s_onebyte(&self->states[s]);
+        for (i = 0; i < n; ++i) cur[i] = false;
+        add_closure(self->states, cur, self->states[s].to0);
+    }
+    if (self->n_pre > 0) {
+        self->pre = ks_malloc(self->n_pre);
+        memcpy(self->pre, lit, self->n_pre);
+    }
+
+    /* Required literal, which is the longest chain of single-byte states that every match goes through */
+    if (n <= LIT_MAX_STATES) {
+        bool* req = ks_zmalloc(sizeof(*req), n);
+        int* stk = ks_zmalloc(sizeof(*stk), n);
+        for (i = 0; i < n; ++i) {
+            req[i] = s_onebyte(&self->states[i]) >= 0 && !s_reach_without(self, i, stk, tmp);
+        }
+
+        int best = 0;
+        for (i = 0; i < n; ++i) {
+            if (!req[i]) continue;
+            int len = 0;
+            s = i;
+            while (s >= 0 && req[s] && len < LIT_MAX) {
+                lit[len++] = s_onebyte(&self->states[s]);
+                for (j = 0; j < n; ++j) cur[j] = false;
+                add_closure(self->states, cur, self->states[s].to0);
+                s = s_onlynext(self, cur);
+            }
+
+            /* The prefix is checked anyway, so only keep a longer literal */
+            if (len > best && len > self->n_pre) {
+                best = len;
+                ks_free(self->req);
+                self->req = ks_malloc(len);
+                memcpy(self->req, lit, len);
+                self->n_req = len;
+            }
+        }
+
+        ks_free(req);
+        ks_free(stk);
+    }
+
+    ks_free(cur);
+    ks_free(tmp);
+}
+
+/* Find the first occurrence of a literal at or after 'from', or return -1 */
+static ks_ssize_t s_lit_find(int n_lit, const unsigned char* lit, ks_ssize_t len_b, const unsigned char* data, ks_ssize_t from) {
+    const unsigned char* p = data + from, *end = data + len_b - n_lit + 1;
+    while (p < end) {
+        p = memchr(p, lit[0], end - p);
+        if (!p) return -1;
+        if (memcmp(p + 1, lit + 1, n_lit - 1) == 0) return p - data;
+        p++;
+    }
+    return -1;
+}
+
+/* Run the regex on some bytes, returning whether it matched all of them (or anywhere within them, if 'una') */
+static bool s_run(ks_regex self, ks_ssize_t len_b, const unsigned char* data, bool una) {
+    /* Reject inputs without the literals */
+    if (!una) {
+        if (len_b < self->n_pre || memcmp(data, self->pre, self->n_pre) != 0) return false;
+    } else if (self->n_pre > 0) {
+        if (self->anchored ? (len_b < self->n_pre || memcmp(data, self->pre, self->n_pre) != 0) : s_lit_find(self->n_pre, self->pre, len_b, data, 0) < 0) return false;
+    }
+    if (self->n_req > 0 && s_lit_find(self->n_req, self->req, len_b, data, 0) < 0) return false;
+
+    struct ks_regex_dfa* dfa = self->_dfa[una];
+    if (!dfa) dfa = self->_dfa[una] = dfa_new(self, una);
+
+    ks_ssize_t i;
+    if (dfa->s0 < 0) {
+        s_startset(self, dfa->cur, dfa->next);
+        return s_run_nfa(self, dfa->cur, len_b, data, una);
+    }
+
+    int d = dfa->s0, nb = self->n_bcls;
+    if (una && dfa->acc[d]) return true;
+    for (i = 0; i < len_b; ++i) {
+        if (una && d == dfa->s0r) {
+            /* No match in progress, so the next one must start at the prefix */
+            if (self->anchored) return false;
+            if (self->n_pre > 0) {
+                i = s_lit_find(self->n_pre, self->pre, len_b, data, i);
+                if (i < 0) return false;
+            }
+        }
+
+        int cls = self->bcls[data[i]];
+        int nd = dfa->trans[d * nb + cls];
+        if (nd == DFA_UNK) {
+            nd = dfa_step(self, dfa, d, cls);
+            if (nd < 0) {
+                /* Out of memory for the DFA */
+                int j;
+                ks_uint64_t* w = &dfa->sets[d * dfa->n_w];
+                for (j = 0; j < self->n_states; ++j) dfa->cur[j] = ((w[j / 64] >> (j % 64)) & 1) || (una && dfa->c0[j]);
+                return s_run_nfa(self, dfa->cur, len_b - i, data + i, una);
+            }
+        }
+        d = nd;
+        if (una) {
+            if (dfa->acc[d]) return true;
+        } else if (d == dfa->dead) {
+            return false;
+        }
+    }
+
+    return dfa->acc_end[d];
+}
+
+
+/* Searching
+ *
+ * The leftmost-longest match is found in two passes. First, the unanchored DFA finds where the earliest match ends,
+ *   while remembering the last position where no match was in progress (no match can start before it). Then, the
+ *   anchored DFA finds the longest match from each possible start after that, and the first one that matches wins
+ *
+ * Matches must start and end on character boundaries. Since '.' and classes match single bytes, a match that ends
+ *   inside a character is not counted (and a shorter one, or one that starts later, is looked for instead)
+ *
+ * Trying every start may take quadratic time for some expressions, so once that takes too long, the NFA simulator is
+ *   used instead, keeping track of where each thread started (which is linear time, but slower for most inputs)
+ *
+ * When more input may follow (i.e. for streams), a search can also report that it needs more input to decide
+ */
+
+/* No match, more input needed, or the budget ran out */
+#define S_NONE (-1)
+#define S_MORE (-2)
+#define S_SLOW (-3)
+
+/* Whether a byte is a UTF-8 continuation byte */
+#define S_ISCONT(_c) (((_c) & 0xC0) == 0x80)
+
+/* Find where the earliest match starting at or after 'from' ends, storing in '*keep' the first position where a match
+ *   could start
+ */
+static ks_ssize_t s_first_stop(ks_regex self, ks_ssize_t len_b, const unsigned char* data, ks_ssize_t from, bool at0, bool is_end, ks_ssize_t* keep) {
+    *keep = from;
+    if (!at0 && self->anchored) return S_NONE;
+    if (is_end && self->n_req > 0 && s_lit_find(self->n_req, self->req, len_b, data, from) < 0) return S_NONE;
+
+    struct ks_regex_dfa* dfa = self->_dfa[1];
+    if (!dfa) dfa = self->_dfa[1] = dfa_new(self, true);
+
+    ks_ssize_t i;
+    int d = at0 ? dfa->s0 : dfa->s0r;
+    if (dfa->acc[d]) return from;
+    for (i = from; i < len_b; ++i) {
+        if (d == dfa->s0r) {
+            /* No match in progress, so the next one must start at the prefix */
+            *keep = i;
+            if (self->anchored) return S_NONE;
+            if (self->n_pre > 0) {
+                ks_ssize_t j = s_lit_find(self->n_pre, self->pre, len_b, data, i);
+                if (j < 0) {
+                    /* The end may be the start of a prefix */
+                    j = len_b - self->n_pre + 1;
+                    if (j > *keep) *keep = j;
+                    return is_end ? S_NONE : S_MORE;
+                }
+                *keep = i = j;
+            }
+        }
+
+        d = dfa_next(self, dfa, d, data[i]);
+        if (dfa->acc[d]) return i + 1;
+    }
+
+    if (is_end) return dfa->acc_end[d] ? len_b : S_NONE;
+    if (d == dfa->s0r) *keep = len_b;
+    return S_MORE;
+}
+
+/* Find where the longest match starting at 'start' ends, using at most '*budget' steps */
+static ks_ssize_t s_longest(ks_regex self, ks_ssize_t len_b, const unsigned char* data, ks_ssize_t start, bool at0, bool is_end, ks_ssize_t* budget) {
+    struct ks_regex_dfa* dfa = self->_dfa[0];
+    if (!dfa) dfa = self->_dfa[0] = dfa_new(self, false);
+
+    ks_ssize_t i, res = S_NONE;
+    int d = at0 ? dfa->s0 : dfa->s0r;
+    if (dfa->acc[d]) res = start;
+    for (i = start; i < len_b; ++i) {
+        if (--*budget < 0) return S_SLOW;
+        d = dfa_next(self, dfa, d, data[i]);
+        if (d == dfa->dead) return res;
+        /* Matches may only end on character boundaries */
+        if (dfa->acc[d] && (i + 1 >= len_b || !S_ISCONT(data[i + 1]))) res = i + 1;
+    }
+
+    if (!is_end) return S_MORE;
+    return dfa->acc_end[d] ? len_b : res;
+}
+
+/* Add a thread that started at 'st' to a state (and everything reachable through epsilon transitions), unless a thread
+ *   is already there
+ */
+static void s_addst(struct ks_regex_nfa* states, ks_ssize_t* set, int s, ks_ssize_t st) {
+    if (s < 0 || set[s] >= 0) return;
+    set[s] = st;
+    if (states[s].kind == KS_REGEX_NFA_EPS) {
+        s_addst(states, set, states[s].to0, st);
+        s_addst(states, set, states[s].to1, st);
+    }
+}
+
+/* Thread in the NFA simulator */
+struct s_thread {
+    ks_ssize_t st;
+    int s;
+};
+
+static int s_thread_cmp(const void* A, const void* B) {
+    const struct s_thread* a = A, *b = B;
+    return a->st < b->st ? -1 : (a->st > b->st ? 1 : a->s - b->s);
+}
+
+/* Search for the leftmost-longest match with the NFA simulator, where each state holds the start of the leftmost
+ *   thread in it (or -1)
+ */
+static int s_search_nfa(ks_regex self, ks_ssize_t len_b, const unsigned char* data, ks_ssize_t from, bool at0, bool is_end, ks_ssize_t* start, ks_ssize_t* stop) {
+    int n = self->n_states, i, nt;
+    ks_ssize_t* cur = ks_zmalloc(sizeof(*cur), n);
+    ks_ssize_t* next = ks_zmalloc(sizeof(*next), n);
+    struct s_thread* ts = ks_zmalloc(sizeof(*ts), n);
+    for (i = 0; i < n; ++i) cur[i] = -1;
+
+    ks_ssize_t p, bs = -1, be = -1;
+    int res = 0;
+    for (p = from; ; ++p) {
+        /* Start a thread here, unless a match has been found (since it would start later) */
+        if (bs < 0 && (p >= len_b || !S_ISCONT(data[p]))) {
+            s_addst(self->states, cur, self->s0, p);
+            if (at0 && p == from) {
+                for (i = 0; i < n; ++i) {
+                    if (cur[i] >= 0 && self->states[i].kind == KS_REGEX_NFA_LINESTART) s_addst(self->states, cur, self->states[i].to0, cur[i]);
+                }
+            }
+        }
+
+        /* Sort the threads by where they started, so the leftmost one wins each state */
+        nt = 0;
+        for (i = 0; i < n; ++i) {
+            if (cur[i] >= 0) {
+                ts[nt].st = cur[i];
+                ts[nt].s = i;
+                nt++;
+            }
+        }
+        qsort(ts, nt, sizeof(*ts), s_thread_cmp);
+
+        if (p >= len_b && is_end) {
+            for (i = 0; i < nt; ++i) {
+                if (self->states[ts[i].s].kind == KS_REGEX_NFA_LINEEND) s_addst(self->states, cur, self->states[ts[i].s].to0, ts[i].st);
+            }
+        }
+        if (cur[self->sf] >= 0 && (p >= len_b || !S_ISCONT(data[p])) && (bs < 0 || cur[self->sf] < bs || (cur[self->sf] == bs && p > be))) {
+            bs = cur[self->sf];
+            be = p;
+        }
+
+        /* Only threads that started before the match may still find a better one */
+        int na = 0;
+        for (i = 0; i < nt; ++i) {
+            if (bs < 0 || ts[i].st <= bs) ts[na++] = ts[i];
+        }
+        nt = na;
+
+        if (p >= len_b) {
+            if (!is_end && (nt > 0 || bs < 0)) res = -1;
+            break;
+        }
+
+        for (i = 0; i < n; ++i) next[i] = -1;
+        bool any = false;
+        for (i = 0; i < nt; ++i) {
+            struct ks_regex_nfa* s = &self->states[ts[i].s];
+            if (s_consumes(s) && s_accepts(s, data[p])) {
+                s_addst(self->states, next, s->to0, ts[i].st);
+                any = true;
+            }
+        }
+        ks_ssize_t* t = cur;
+        cur = next;
+        next = t;
+
+        if (!any && bs >= 0) break;
+    }
+
+    if (res == 0 && bs >= 0) {
+        *start = bs;
+        *stop = be;
+        res = 1;
+    }
+
+    ks_free(cur);
+    ks_free(next);
+    ks_free(ts);
+    return res;
+}
+
+/* Search for the leftmost-longest match, returning 1 if one was found, 0 if there is none, or -1 if more input is
+ *   needed ('*keep' is set to the first position where a match could start)
+ */
+static int s_search(ks_regex self, ks_ssize_t len_b, const unsigned char* data, ks_ssize_t from, bool at0, bool is_end, ks_ssize_t* start, ks_ssize_t* stop, ks_ssize_t* keep) {
+    while (true) {
+        ks_ssize_t e = s_first_stop(self, len_b, data, from, at0, is_end, keep);
+        if (e == S_NONE) return 0;
+        if (e == S_MORE) return -1;
+
+        ks_ssize_t i, budget = 8 * (e - *keep) + 4096;
+        for (i = *keep; i <= e; ++i) {
+            if (self->n_pre > 0) {
+                i = s_lit_find(self->n_pre, self->pre, len_b, data, i);
+                if (i < 0 || i > e) break;
+            }
+            /* Matches start on character boundaries */
+            if (i < len_b && S_ISCONT(data[i])) continue;
+
+            ks_ssize_t r = s_longest(self, len_b, data, i, at0 && i == from, is_end, &budget);
+            if (r == S_SLOW) {
+                int res = s_search_nfa(self, len_b, data, *keep, at0 && *keep == from, is_end, start, &r);
+                if (res <= 0) return res;
+            } else if (r == S_MORE) {
+                return -1;
+            } else if (r >= 0) {
+                *start = i;
+            } else {
+                continue;
+            }
+
+            /* ...and end on them as well (which 's_longest()' and 's_search_nfa()' only accept) */
+            if (r == len_b && !is_end) return -1;
+            *stop = r;
+            return 1;
+        }
+
+        /* The earliest match started or ended inside a character, so keep looking after it */
+        from = e > from ? e : from + 1;
+        at0 = false;
+        if (from > len_b) return is_end ? 0 : -1;
+    }
+}
+
+
+/* Iterating */
+
+/* Minimum number of bytes read from streams at a time */
+#define IT_CHUNK 65536
+
+/* Write the bytes that haven't been written yet (up to 'to') to the output */
+static bool it_emit(ks_regex_iter self, ks_ssize_t to) {
+    if (self->emit >= to) return true;
+    if (!ksio_writes((ksio_BaseIO)self->out, to - self->emit, self->data + self->emit)) return false;
+    self->emit = to;
+    return true;
+}
+
+/* Discard the buffered bytes before 'keep', and read another chunk from the stream */
+static bool it_fill(ks_regex_iter self, ks_ssize_t keep) {
+    if (keep > self->len_b) keep = self->len_b;
+    if (self->out && !it_emit(self, keep)) return false;
+
+    if (self->pos < keep) self->pos = keep;
+
+    memmove(self->data, self->data + keep, self->len_b - keep);
+    self->len_b -= keep;
+    self->base_b += keep;
+    self->pos -= keep;
+    self->emit -= keep;
+    if (self->emit < 0) self->emit = 0;
+
+    /* Read at least as much as is buffered, so that re-scanning a long partial match is amortized */
+    ks_ssize_t sz = self->len_b > IT_CHUNK ? self->len_b : IT_CHUNK;
+    ksio_BaseIO src = (ksio_BaseIO)self->src;
+    bool is_b = kso_issub(src->type, ksiot_FileIO) || kso_issub(src->type, ksiot_RawIO) || kso_issub(src->type, ksiot_BytesIO);
+    ks_ssize_t req = self->len_b + (is_b ? sz : 4 * sz);
+    if (req > self->max_len_b) {
+        self->max_len_b = ks_nextsize(self->max_len_b, req);
+        self->data = ks_realloc(self->data, self->max_len_b);
+    }
+
+    ks_ssize_t num_c, rsz = is_b ? ksio_readb(src, sz, self->data + self->len_b) : ksio_reads(src, sz, self->data + self->len_b, &num_c);
+    if (rsz < 0) return false;
+
+    self->len_b += rsz;
+    if (rsz == 0) self->eof = true;
+    return true;
+}
+
+/* Find the next match, returning 1 (and storing where it is in 'data'), 0 if there are no more, or -1 on an error */
+static int it_next(ks_regex_iter self, ks_ssize_t* start, ks_ssize_t* stop) {
+    while (!self->done) {
+        ks_ssize_t keep = self->len_b;
+        int r = self->pos > self->len_b ? (self->eof ? 0 : -1) : s_search(self->pat, self->len_b, self->data, self->pos, self->base_b + self->pos == 0, self->eof, start, stop, &keep);
+        if (r > 0) {
+            /* Don't find the same empty match again */
+            self->pos = *stop > *start ? *stop : *stop + 1;
+            return 1;
+        } else if (r == 0) {
+            self->done = true;
+        } else if (!it_fill(self, keep)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+
+/* Longest match */
+
+void ks_regex_lm_init(ks_regex self, ks_regex_lm* lm) {
+    struct ks_regex_dfa* dfa = self->_dfa[0];
+    if (!dfa) dfa = self->_dfa[0] = dfa_new(self, false);
+
+    lm->d = dfa->s0r;
+    lm->len_b = lm->stop = 0;
+    lm->tag = -1;
+}
+
+bool ks_regex_lm_feed(ks_regex self, ks_regex_lm* lm, ks_ssize_t len_b, const char* data) {
+    struct ks_regex_dfa* dfa = self->_dfa[0];
+    int d = lm->d;
+    if (d < 0) return false;
+
+    ks_ssize_t i;
+    for (i = 0; i < len_b; ++i) {
+        d = dfa_next(self, dfa, d, data[i]);
+        lm->len_b++;
+        if (d == dfa->dead) {
+            lm->d = -1;
+            return false;
+        } else if (dfa->acc[d]) {
+            lm->stop = lm->len_b;
+            lm->tag = self->tags ? dfa->tag[d] : 0;
+        }
+    }
+
+    lm->d = d;
+    return true;
+}
+
 
 static KS_TFUNC(T, free) {
     ks_regex self;
@@ -778,6 +1819,11 @@ static KS_TFUNC(T, free) {
 
     free_nfa(self->n_states, self->states);
     ks_free(self->states);
+    dfa_free(self->_dfa[0]);
+    dfa_free(self->_dfa[1]);
+    ks_free(self->pre);
+    ks_free(self->req);
+    ks_free(self->tags);
 
     KSO_DEL(self);
 
@@ -840,7 +1886,7 @@ static KS_TFUNC(T, graph) {
             for (j = 0; j < 256; ++j) {
                 if (self->states[i].set.has_byte[j]) {
                     ks_str c = ks_str_chr(j);
-                    ks_set_add_h(r, (kso)c, c->v_hash);
+                    ks_set_add_h(r, (kso)c, KS_STR_HASH(c));
                     KS_DECREF(c);
                 }
             }
@@ -886,16 +1932,176 @@ static KS_TFUNC(T, matches) {
     return KSO_BOOL(res);
 }
 
+static KS_TFUNC(T, cache_info) {
+    KS_ARGS("");
+
+    ks_cint hits, misses, size;
+    ks_regex_cache_info(&hits, &misses, &size);
+
+    return (kso)ks_dict_newn(KS_IKV(
+        {"hits",                 (kso)ks_int_new(hits)},
+        {"misses",               (kso)ks_int_new(misses)},
+        {"size",                 (kso)ks_int_new(size)},
+        {"max",                  (kso)ks_int_new(CACHE_MAX)},
+    ));
+}
+
+static KS_TFUNC(T, search) {
+    ks_regex self;
+    ks_str src;
+    ks_cint pos = 0;
+    KS_ARGS("self:* src:* ?pos:cint", &self, kst_regex, &src, kst_str, &pos);
+
+    if (pos < 0) pos = 0;
+    if (pos > KS_STR_LENC(src)) pos = KS_STR_LENC(src);
+    ks_ssize_t from = ks_str_off(src, pos), start, stop;
+    if (!ks_regex_search(self, src, from, &start, &stop)) return KSO_NONE;
+
+    /* Convert to character positions */
+    ks_cint start_c = pos + ks_str_lenc(start - from, src->data + from);
+    ks_cint stop_c = start_c + ks_str_lenc(stop - start, src->data + start);
+
+    return (kso)ks_tuple_newn(2, (kso[]){
+        (kso)ks_int_new(start_c),
+        (kso)ks_int_new(stop_c),
+    });
+}
+
+static KS_TFUNC(T, finditer) {
+    ks_regex self;
+    kso src;
+    KS_ARGS("self:* src", &self, kst_regex, &src);
+
+    return (kso)ks_regex_finditer(self, src);
+}
+
+static KS_TFUNC(T, findall) {
+    ks_regex self;
+    kso src;
+    KS_ARGS("self:* src", &self, kst_regex, &src);
+
+    ks_regex_iter it = ks_regex_finditer(self, src);
+    if (!it) return NULL;
+
+    ks_list res = ks_list_new(0, NULL);
+    ks_ssize_t start, stop;
+    int r;
+    while ((r = it_next(it, &start, &stop)) > 0) {
+        ks_str m = ks_str_new(stop - start, (char*)it->data + start);
+        ks_list_pushu(res, (kso)m);
+    }
+    KS_DECREF(it);
+
+    if (r < 0) {
+        KS_DECREF(res);
+        return NULL;
+    }
+
+    return (kso)res;
+}
+
+static KS_TFUNC(T, sub) {
+    ks_regex self;
+    kso src, repl, out = KSO_NONE;
+    KS_ARGS("self:* src repl ?out", &self, kst_regex, &src, &repl, &out);
+
+    if (out != KSO_NONE) {
+        if (!ks_regex_sub(self, src, repl, out)) return NULL;
+        return KS_NEWREF(out);
+    }
+
+    ksio_StringIO sio = ksio_StringIO_new();
+    if (!ks_regex_sub(self, src, repl, (kso)sio)) {
+        KS_DECREF(sio);
+        return NULL;
+    }
+
+    return (kso)ksio_StringIO_getf(sio);
+}
+
+
+/** Iterator **/
+
+static KS_TFUNC(TI, free) {
+    ks_regex_iter self;
+    KS_ARGS("self:*", &self, kst_regex_iter);
+
+    if (!kso_issub(self->src->type, kst_str)) ks_free(self->data);
+    KS_DECREF(self->pat);
+    KS_DECREF(self->src);
+    if (self->out) KS_DECREF(self->out);
+
+    KSO_DEL(self);
+
+    return KSO_NONE;
+}
+
+static KS_TFUNC(TI, new) {
+    ks_type tp;
+    ks_regex pat;
+    kso src;
+    KS_ARGS("tp:* pat:* src", &tp, kst_type, &pat, kst_regex, &src);
+
+    return (kso)ks_regex_finditer(pat, src);
+}
+
+static KS_TFUNC(TI, next) {
+    ks_regex_iter self;
+    KS_ARGS("self:*", &self, kst_regex_iter);
+
+    ks_ssize_t start, stop;
+    int r = it_next(self, &start, &stop);
+    if (r < 0) return NULL;
+    if (r == 0) {
+        KS_OUTOFITER();
+        return NULL;
+    }
+
+    if (!kso_issub(self->src->type, kst_str)) {
+        /* Streams don't keep their contents, so yield the matched text */
+        return (kso)ks_str_new(stop - start, (char*)self->data + start);
+    }
+
+    /* Convert to character positions, moving forward from the last match */
+    ks_str src = (ks_str)self->src;
+    if (KS_STR_IS_ASCII(src)) {
+        self->cur_b = self->cur_c = stop;
+        return (kso)ks_tuple_newn(2, (kso[]){
+            (kso)ks_int_new(start),
+            (kso)ks_int_new(stop),
+        });
+    }
+
+    ks_cint start_c = self->cur_c + ks_str_lenc(start - self->cur_b, src->data + self->cur_b);
+    ks_cint stop_c = start_c + ks_str_lenc(stop - start, src->data + start);
+    self->cur_b = stop;
+    self->cur_c = stop_c;
+
+    return (kso)ks_tuple_newn(2, (kso[]){
+        (kso)ks_int_new(start_c),
+        (kso)ks_int_new(stop_c),
+    });
+}
+
 
 /* Export */
 
 static struct ks_type_s tp;
 ks_type kst_regex = &tp;
 
+static struct ks_type_s tp_iter;
+ks_type kst_regex_iter = &tp_iter;
+
 
 void _ksi_regex() {
 
-    _ksinit(kst_regex, kst_object, T_NAME, sizeof(struct ks_str_s), -1, "String (i.e. a collection of Unicode characters)\n\n    Indicies, operations, and so forth take character positions, not byte positions", KS_IKV(
+    _ksinit(kst_regex_iter, kst_object, TI_NAME, sizeof(struct ks_regex_iter_s), -1, "Iterator over the matches of a regular expression\n\n    For 'str' sources, this yields '(start, stop)' character positions of each match. For 'io.BaseIO' sources, which are read in chunks (and not kept), this yields the text of each match", KS_IKV(
+        {"__free",               ksf_wrap(TI_free_, TI_NAME ".__free(self)", "")},
+        {"__new",                ksf_wrap(TI_new_, TI_NAME ".__new(tp, pat, src)", "")},
+        {"__next",               ksf_wrap(TI_next_, TI_NAME ".__next(self)", "")},
+    ));
+
+    _ksinit(kst_regex, kst_object, T_NAME, sizeof(struct ks_regex_s), -1, "Regular expression, which is matched in linear time\n\n    Positions (for 'search()' and 'finditer()') are in characters, and searches find the leftmost match, and then the longest one starting there", KS_IKV(
         {"__free",               ksf_wrap(T_free_, T_NAME ".__free(self)", "")},
         {"__new",                ksf_wrap(T_new_, T_NAME ".__new(tp, expr)", "")},
         {"__repr",               ksf_wrap(T_str_, T_NAME ".__repr(self)", "")},
@@ -903,6 +2109,14 @@ void _ksi_regex() {
         {"__graph",              ksf_wrap(T_graph_, T_NAME ".__graph(self)", "")},
         {"exact",                ksf_wrap(T_exact_, T_NAME ".exact(self, src)", "Calculate whether the regular expression matches the string exactly")},
         {"matches",              ksf_wrap(T_matches_, T_NAME ".matches(self, src)", "Calculate whether the regular expression matches the string anywhere (this returns a bool)")},
+        {"search",               ksf_wrap(T_search_, T_NAME ".search(self, src, pos=0)", "Find the first match at or after 'pos', returning '(start, stop)', or 'none' if there was no match")},
+        {"finditer",             ksf_wrap(T_finditer_, T_NAME ".finditer(self, src)", "Return an iterator over the matches (which don't overlap) within 'src', which may be a 'str' or an 'io.BaseIO'\n\n    See 'regex.iter' for what is yielded")},
+        {"findall",              ksf_wrap(T_findall_, T_NAME ".findall(self, src)", "Return a list of the text of every match (which don't overlap) within 'src', which may be a 'str' or an 'io.BaseIO'")},
+        {"sub",                  ksf_wrap(T_sub_, T_NAME ".sub(self, src, repl, out=none)", "Replace every match within 'src' (a 'str' or an 'io.BaseIO') with 'repl', which is either a 'str' or a function called with the matched text\n\n    The result is written to 'out' (an 'io.BaseIO') and it is returned, or if 'out' is none, the result is returned as a 'str'")},
+
+        {"cache_info",           ksf_wrap(T_cache_info_, T_NAME ".cache_info()", "Return a dict of statistics of the cache of compiled regexes, with keys 'hits', 'misses', 'size', and 'max'\n\n    Creating a 'regex' (including regex literals) from an expression in the cache returns the same object")},
+
+        {"iter",                 KS_NEWREF(kst_regex_iter)},
 
     ));
 }
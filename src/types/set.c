@@ -23,6 +23,14 @@
 /* Maximum proportion of holes in the entries array. Once the ratio exceeds this, holes are filled */
 #define S_HOLES_MAX      (0.5)
 
+/* Number of bits of the hash shifted into the probe sequence each step */
+#define S_PERTURB_SHIFT  5
+
+/* Extra probes allowed beyond the number of buckets (one per 'S_PERTURB_SHIFT' bits in the hash,
+ *   after which the probe sequence is guaranteed to be a full cycle)
+ */
+#define S_PERTURB_TRIES  (1 + 8 * sizeof(ks_hash_t) / S_PERTURB_SHIFT)
+
 
 /* Template to conditionally execute different code based on size 
  * 
@@ -67,16 +75,17 @@ static double s_load(ks_set self) {
  */
 static bool s_search(ks_set self, kso key, ks_hash_t hash, ks_ssize_t* rb, ks_ssize_t* re) {
     if (self->len_buckets <= 0) {
-        /* no elements, but avoid modulo by 0 */
+        /* no elements, and no buckets to search */
         *rb = *re = -1;
         return true;
     }
 
-    /* Calculate bucket index based on hash */
-    ks_size_t bi = hash % self->len_buckets;
+    /* Calculate bucket index based on hash ('len_buckets' is always a power of two) */
+    ks_size_t mask = self->len_buckets - 1;
+    ks_size_t bi = hash & mask;
 
-    /* First bucket index, and number of tries thus far */
-    ks_size_t bi0 = bi, tries = 0;
+    /* Higher bits of the hash, which are shifted in while probing, and number of tries thus far */
+    ks_size_t perturb = hash, tries = 0;
 
     do {
         /* Element index (>=0 means valid, < 0 means special case) */
@@ -112,15 +121,18 @@ static bool s_search(ks_set self, kso key, ks_hash_t hash, ks_ssize_t* rb, ks_ss
 
         /* Probe for the next bucket in the hash table
          *
-         * For now, we use linear probing
+         * We use the perturbed probe sequence (from CPython), which mixes in the upper bits of the hash
+         *   so that keys which agree on their lower bits don't cluster. Once 'perturb' is zero, it
+         *   is the recurrence 'bi = 5 * bi + 1 (mod 2**k)', which visits every bucket
          */
-        bi = (bi + 1) % self->len_buckets;
+        perturb >>= S_PERTURB_SHIFT;
+        bi = (5 * bi + 1 + perturb) & mask;
 
-    } while (bi != bi0);
+    } while (++tries <= self->len_buckets + S_PERTURB_TRIES);
 
     /* Not found, and no room to insert, so signal that */
     *rb = *re = -1;
-    return -1;
+    return true;
 }
 
 /* Fill holes in the entries array of 'self'
@@ -162,7 +174,7 @@ static bool s_fill_holes(ks_set self) {
  * Returns true if the operation completed, false if an error was thrown
  */
 static bool s_resize(ks_set self, ks_size_t new_len_buckets) {
-    new_len_buckets = ks_nextprime(new_len_buckets);
+    new_len_buckets = ks_nextpow2(new_len_buckets);
     if (self->len_buckets >= new_len_buckets) return true;
 
     ks_size_t i;
@@ -474,6 +486,17 @@ static KS_TFUNC(T, len) {
     return (kso)ks_int_newu(self->len_real);
 }
 
+static KS_TFUNC(T, contains) {
+    ks_set self;
+    kso key;
+    KS_ARGS("self:* key", &self, kst_set, &key);
+
+    bool g;
+    if (!ks_set_has(self, key, &g)) return NULL;
+
+    return KSO_BOOL(g);
+}
+
 
 /** Iterator **/
 
@@ -525,6 +548,7 @@ void _ksi_set() {
         {"__init",                 ksf_wrap(T_init_, T_NAME ".__init(self, objs=none)", "")},
         {"__bool",                 ksf_wrap(T_bool_, T_NAME ".__bool(self)", "")},
         {"__len",                  ksf_wrap(T_len_, T_NAME ".__len(self)", "")},
+        {"__contains",             ksf_wrap(T_contains_, T_NAME ".__contains(self, key)", "")},
         {"__iter",                 KS_NEWREF(kst_set_iter)},
     ));
 
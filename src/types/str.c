@@ -9,17 +9,333 @@
 #define TI_NAME "str.__iter"
 
 
+/* Internals */
+
+/* Intern table, which is an open-addressed hash table of strings (holding a reference to each)
+ *
+ * 'len_intern' is always a power of two
+ */
+static ks_str* intern_tab = NULL;
+static ks_size_t len_intern = 0, num_intern = 0;
+
+/* Find the slot in the intern table which holds the given contents, or the empty slot it would be added to */
+static ks_str* s_intern_find(ks_hash_t hash, ks_ssize_t len_b, const char* data) {
+    ks_size_t mask = len_intern - 1, i = hash & mask;
+    while (intern_tab[i]) {
+        ks_str s = intern_tab[i];
+        if (s->v_hash == hash && s->len_b == len_b && memcmp(s->data, data, len_b) == 0) break;
+        i = (i + 1) & mask;
+    }
+    return &intern_tab[i];
+}
+
+/* Ensure there is room for another string in the intern table (keeping the load at most 1/2) */
+static void s_intern_reserve() {
+    if (2 * (num_intern + 1) <= len_intern) return;
+
+    ks_str* old_tab = intern_tab;
+    ks_size_t i, old_len = len_intern;
+
+    len_intern = old_len == 0 ? 256 : 2 * old_len;
+    intern_tab = ks_zmalloc(sizeof(*intern_tab), len_intern);
+    for (i = 0; i < len_intern; ++i) intern_tab[i] = NULL;
+
+    for (i = 0; i < old_len; ++i) if (old_tab[i]) {
+        *s_intern_find(KS_STR_HASH(old_tab[i]), old_tab[i]->len_b, old_tab[i]->data) = old_tab[i];
+    }
+
+    ks_free(old_tab);
+}
+
+
+/* UTF-8 scanning kernels
+ *
+ * The character count of UTF-8 text is the number of bytes which are not continuation bytes (0b10xxxxxx),
+ *   so it can be computed a word (or vector) at a time. The widest kernel the CPU supports is selected in
+ *   '_ksi_str()'
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+  #define S_X86
+  #include <immintrin.h>
+#endif
+
+static int s_popcount64(uint64_t x) {
+#ifdef __GNUC__
+    return __builtin_popcountll(x);
+#else
+    int r = 0;
+    while (x) {
+        x &= x - 1;
+        r++;
+    }
+    return r;
+#endif
+}
+
+/* Portable kernel, 8 bytes at a time */
+static ks_ssize_t s_lenc_swar(ks_ssize_t len_b, const unsigned char* data) {
+    ks_ssize_t p = 0, r = 0;
+    for (; p + 8 <= len_b; p += 8) {
+        uint64_t w;
+        memcpy(&w, data + p, 8);
+        /* Top bit set and next bit clear means a continuation byte */
+        r += 8 - s_popcount64(w & ~(w << 1) & 0x8080808080808080ULL);
+    }
+    for (; p < len_b; ++p) {
+        r += (data[p] & 0xC0) != 0x80;
+    }
+    return r;
+}
+
+#ifdef S_X86
+
+/* Continuation bytes are 0x80-0xBF, which are exactly the signed bytes <= -65 */
+static ks_ssize_t s_lenc_sse2(ks_ssize_t len_b, const unsigned char* data) {
+    ks_ssize_t p = 0, r = 0;
+    __m128i lim = _mm_set1_epi8(-65);
+    for (; p + 16 <= len_b; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(data + p));
+        r += s_popcount64((unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(v, lim)));
+    }
+    return r + s_lenc_swar(len_b - p, data + p);
+}
+
+__attribute__((target("avx2")))
+static ks_ssize_t s_lenc_avx2(ks_ssize_t len_b, const unsigned char* data) {
+    ks_ssize_t p = 0, r = 0;
+    __m256i lim = _mm256_set1_epi8(-65);
+    for (; p + 32 <= len_b; p += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + p));
+        r += s_popcount64((unsigned)_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, lim)));
+    }
+    return r + s_lenc_sse2(len_b - p, data + p);
+}
+
+static ks_ssize_t (*s_lenc)(ks_ssize_t len_b, const unsigned char* data) = s_lenc_sse2;
+
+#else
+
+static ks_ssize_t (*s_lenc)(ks_ssize_t len_b, const unsigned char* data) = s_lenc_swar;
+
+#endif
+
+/* Return the number of leading bytes of 'data' which are ASCII */
+static ks_ssize_t s_ascii_prefix(ks_ssize_t len_b, const unsigned char* data) {
+    ks_ssize_t p = 0;
+#ifdef S_X86
+    for (; p + 16 <= len_b; p += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(data + p)))) break;
+    }
+#else
+    for (; p + 8 <= len_b; p += 8) {
+        uint64_t w;
+        memcpy(&w, data + p, 8);
+        if (w & 0x8080808080808080ULL) break;
+    }
+#endif
+    while (p < len_b && data[p] < 0x80) p++;
+    return p;
+}
+
+/* Return the length of the valid UTF-8 sequence starting at 'data' (which has 'n' bytes left), or -1 if it
+ *   is malformed (truncated, overlong, a surrogate, or above U+10FFFF)
+ */
+static int s_utf8_seq(ks_ssize_t n, const unsigned char* data) {
+    unsigned char c = data[0], lo = 0x80, hi = 0xBF;
+    int sz, i;
+    if (c < 0x80) return 1;
+    else if (c >= 0xC2 && c <= 0xDF) sz = 2;
+    else if (c >= 0xE0 && c <= 0xEF) {
+        sz = 3;
+        if (c == 0xE0) lo = 0xA0;
+        else if (c == 0xED) hi = 0x9F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        sz = 4;
+        if (c == 0xF0) lo = 0x90;
+        else if (c == 0xF4) hi = 0x8F;
+    } else return -1;
+
+    if (n < sz || data[1] < lo || data[1] > hi) return -1;
+    for (i = 2; i < sz; ++i) {
+        if ((data[i] & 0xC0) != 0x80) return -1;
+    }
+    return sz;
+}
+
+/* Character classes of ASCII characters, which agree with the Unicode database */
+enum {
+    S_CL_SPACE = 0x01,
+    S_CL_DIGIT = 0x02,
+    S_CL_ALPHA = 0x04,
+    S_CL_UNDER = 0x08,
+};
+
+static unsigned char s_ascii_class[128];
+
+static void s_init_ascii_class() {
+    int c;
+    for (c = 0; c < 128; ++c) {
+        unsigned char r = 0;
+        if (c == ' ') r |= S_CL_SPACE;
+        if (c >= '0' && c <= '9') r |= S_CL_DIGIT;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) r |= S_CL_ALPHA;
+        if (c == '_') r |= S_CL_UNDER;
+        s_ascii_class[c] = r;
+    }
+}
+
+/* Return whether every byte of an ASCII string has one of the classes in 'cl' */
+static bool s_ascii_all(ks_str self, int cl) {
+    ks_ssize_t i;
+    for (i = 0; i < self->len_b; ++i) {
+        if (!(s_ascii_class[(unsigned char)self->data[i]] & cl)) return false;
+    }
+    return true;
+}
+
+
 /* C-API */
 
+ks_str ks_str_intern_c(ks_ssize_t len_b, const char* data) {
+    if (len_b < 0) len_b = strlen(data);
+    s_intern_reserve();
+
+    ks_hash_t hash = ks_hash_bytes(len_b, (const unsigned char*)data);
+    ks_str* p = s_intern_find(hash, len_b, data);
+    if (!*p) {
+        *p = ks_str_new(len_b, data);
+        (*p)->v_hash = hash;
+        (*p)->flags |= KS_STR_F_HASH | KS_STR_F_INTERN;
+        num_intern++;
+    }
+
+    return (ks_str)KS_NEWREF(*p);
+}
+
+ks_str ks_str_intern(ks_str self) {
+    if (self->flags & KS_STR_F_INTERN) return (ks_str)KS_NEWREF(self);
+    s_intern_reserve();
+
+    ks_hash_t hash = KS_STR_HASH(self);
+    ks_str* p = s_intern_find(hash, self->len_b, self->data);
+    if (!*p) {
+        /* Add 'self' itself, unless it is a subtype (which should remain distinct) */
+        *p = self->type == kst_str ? (ks_str)KS_NEWREF(self) : ks_str_new(self->len_b, self->data);
+        (*p)->v_hash = hash;
+        (*p)->flags |= KS_STR_F_HASH | KS_STR_F_INTERN;
+        num_intern++;
+    }
+
+    return (ks_str)KS_NEWREF(*p);
+}
+
+ks_hash_t _ks_str_hash(ks_str self) {
+    self->v_hash = ks_hash_bytes(self->len_b, (const unsigned char*)self->data);
+    self->flags |= KS_STR_F_HASH;
+    return self->v_hash;
+}
+
+ks_size_t _ks_str_lenc(ks_str self) {
+    self->len_c = ks_str_lenc(self->len_b, self->data);
+    self->flags |= KS_STR_F_LENC;
+    if (self->len_c == self->len_b) self->flags |= KS_STR_F_ASCII;
+    return self->len_c;
+}
+
+/* Create a string of 'len_b' bytes (which the caller should fill in), storing the data directly after the object
+ *   so there is only one allocation
+ */
+static ks_str s_new_inline(ks_type tp, ks_ssize_t len_b) {
+    ks_str self = KSO_NEWX(ks_str, tp, len_b + 1);
+    self->len_b = len_b;
+    self->data = (char*)self + tp->ob_sz;
+    self->data[len_b] = '\0';
+    self->flags = KS_STR_F_INLINE;
+
+    return self;
+}
 
 ks_str ks_str_newt(ks_type tp, ks_ssize_t len_b, const char* data) {
     if (len_b < 0) len_b = strlen(data);
 
-    char* new_data = ks_zmalloc(1, len_b + 1);
-    memcpy(new_data, data, len_b);
-    new_data[len_b] = '\0';
+    ks_str self = s_new_inline(tp, len_b);
+    memcpy(self->data, data, len_b);
+
+    return self;
+}
+
+ks_str ks_str_cat(ks_str L, ks_str R) {
+    ks_str self = s_new_inline(kst_str, L->len_b + R->len_b);
+    memcpy(self->data, L->data, L->len_b);
+    memcpy(self->data + L->len_b, R->data, R->len_b);
 
-    return ks_str_newn(len_b, new_data);
+    if ((L->flags & KS_STR_F_LENC) && (R->flags & KS_STR_F_LENC)) {
+        self->len_c = L->len_c + R->len_c;
+        self->flags |= KS_STR_F_LENC | (L->flags & R->flags & KS_STR_F_ASCII);
+    }
+    return self;
+}
+
+void _ks_str_append(ks_str self, ks_str other) {
+    ks_size_t len_b = self->len_b + other->len_b;
+
+    if (self->flags & KS_STR_F_GROW) {
+        /* Capacity is the next power of two, so this reallocates O(log(N)) times */
+        if (ks_nextpow2(len_b + 1) > ks_nextpow2(self->len_b + 1)) {
+            self->data = ks_realloc(self->data, ks_nextpow2(len_b + 1));
+        }
+    } else {
+        /* Move to a buffer that can grow */
+        char* data = ks_malloc(ks_nextpow2(len_b + 1));
+        memcpy(data, self->data, self->len_b);
+        if (self->_base) {
+            KS_DECREF(self->_base);
+            self->_base = NULL;
+        } else if (!(self->flags & KS_STR_F_INLINE)) {
+            ks_free(self->data);
+        }
+        self->data = data;
+        self->flags = (self->flags & ~KS_STR_F_INLINE) | KS_STR_F_GROW;
+    }
+
+    memcpy(self->data + self->len_b, other->data, other->len_b);
+    self->data[len_b] = '\0';
+    self->len_b = len_b;
+
+    /* Update cached values */
+    if ((self->flags & KS_STR_F_LENC) && (other->flags & KS_STR_F_LENC)) {
+        self->len_c += other->len_c;
+        if (!(other->flags & KS_STR_F_ASCII)) self->flags &= ~KS_STR_F_ASCII;
+    } else {
+        self->flags &= ~(KS_STR_F_LENC | KS_STR_F_ASCII);
+    }
+    self->flags &= ~KS_STR_F_HASH;
+
+    #if KS_STR_OFF_EVERY
+    ks_free(self->_offs);
+    self->_offs = NULL;
+    #endif
+}
+
+ks_str ks_str_sub(ks_str self, ks_ssize_t off_b, ks_ssize_t len_b) {
+    ks_str base = self->_base ? self->_base : self, res;
+    if (off_b + len_b == self->len_b && len_b >= KS_STR_VIEW_MIN && 2 * len_b >= base->len_b) {
+        res = KSO_NEW(ks_str, kst_str);
+        res->len_b = len_b;
+        res->data = self->data + off_b;
+        res->flags = 0;
+        KS_INCREF(base);
+        res->_base = base;
+    } else {
+        res = ks_str_new(len_b, self->data + off_b);
+    }
+
+    if (KS_STR_IS_ASCII(self)) {
+        res->len_c = len_b;
+        res->flags |= KS_STR_F_LENC | KS_STR_F_ASCII;
+    }
+    return res;
 }
 
 ks_str ks_str_newnt(ks_type tp, ks_ssize_t len_b, char* data) {
@@ -29,12 +345,16 @@ ks_str ks_str_newnt(ks_type tp, ks_ssize_t len_b, char* data) {
 
     
     self->len_b = len_b;
-    self->len_c = ks_str_lenc(len_b, data);;
 
     self->data = data;
     self->data[len_b] = '\0';
 
-    self->v_hash = ks_hash_bytes(len_b, (const unsigned char*)data);
+    /* The hash and length in characters are calculated when they are first needed */
+    self->flags = 0;
+
+    #if KS_STR_OFF_EVERY
+    self->_offs = NULL;
+    #endif
 
     return self;
 }
@@ -56,7 +376,13 @@ int ks_str_cmp(ks_str L, ks_str R) {
     return c0 < 0 ? -1 : (c0 > 0 ? 1 : 0);
 }
 bool ks_str_eq(ks_str L, ks_str R) {
-    return ks_str_eq_c(L, R->data, R->len_b);
+    if (L == R) return true;
+    /* Interned strings are unique */
+    if ((L->flags & KS_STR_F_INTERN) && (R->flags & KS_STR_F_INTERN)) return false;
+    if (L->len_b != R->len_b) return false;
+    /* Only compare hashes if both are known, since they are expensive to compute for long strings */
+    if ((L->flags & KS_STR_F_HASH) && (R->flags & KS_STR_F_HASH) && L->v_hash != R->v_hash) return false;
+    return memcmp(L->data, R->data, L->len_b) == 0;
 }
 bool ks_str_eq_c(ks_str L, const char* data, ks_ssize_t len_b) {
     if (len_b < 0) len_b = strlen(data);
@@ -69,7 +395,7 @@ ks_str ks_str_chr(ks_ucp ord) {
     return ks_str_new(n, utf8);
 }
 ks_ucp ks_str_ord(ks_str chr) {
-    if (chr->len_c != 1) {
+    if (KS_STR_LENC(chr) != 1) {
         KS_THROW(kst_Error, "Only strings of length 1 are allowed in 'ord()'");
         return -1;
     }
@@ -80,84 +406,116 @@ ks_ucp ks_str_ord(ks_str chr) {
     return res;
 }
 
-ks_str ks_str_upper(ks_str self) {
-    struct ks_str_citer cit = ks_str_citer_make(self);
+/* Convert the case of 'self', either to upper or lower case
+ * ASCII characters are mapped directly; others are looked up in the Unicode database
+ */
+static ks_str s_case(ks_str self, bool upper) {
+    const unsigned char* data = (const unsigned char*)self->data;
+    ks_ssize_t n = self->len_b, p = 0;
+
+    if (KS_STR_IS_ASCII(self)) {
+        ks_str res = s_new_inline(kst_str, n);
+        for (p = 0; p < n; ++p) {
+            unsigned char c = data[p];
+            if (upper && c >= 'a' && c <= 'z') c -= 'a' - 'A';
+            else if (!upper && c >= 'A' && c <= 'Z') c += 'a' - 'A';
+            res->data[p] = c;
+        }
+        res->len_c = n;
+        res->flags |= KS_STR_F_LENC | KS_STR_F_ASCII;
+        return res;
+    }
+
     ksio_StringIO sio = ksio_StringIO_new();
-    ks_ucp c;
     char utf8[5];
     struct ksucd_info info;
-    while (!cit.done) {
-        c = ks_str_citer_next(&cit);
-        if (c < 0) break;
+    while (p < n) {
+        /* Copy runs of characters that do not change case in one go */
+        ks_ssize_t q = p;
+        while (q < n && data[q] < 0x80 && !(upper ? (data[q] >= 'a' && data[q] <= 'z') : (data[q] >= 'A' && data[q] <= 'Z'))) q++;
+        if (q > p) ksio_addbuf(sio, q - p, (const char*)data + p);
+        p = q;
+        if (p >= n) break;
+
+        if (data[p] < 0x80) {
+            utf8[0] = upper ? data[p] - ('a' - 'A') : data[p] + ('a' - 'A');
+            ksio_addbuf(sio, 1, utf8);
+            p++;
+            continue;
+        }
 
-        if (ksucd_get_info(&info, c) < 0 || info.case_upper == c || info.case_upper <= 0) {
-            /* Assume same case */
-            ksio_addbuf(sio, cit.cbyi - cit.lcbyi, self->data + cit.lcbyi);
+        ks_ucp c;
+        int sz;
+        KS_UCP_FROM_UTF8(c, data + p, sz);
+        if (sz < 0 || p + sz > n) {
+            /* Malformed, so keep the rest as is */
+            ksio_addbuf(sio, n - p, (const char*)data + p);
+            break;
+        }
+
+        ks_ucp to = ksucd_get_info(&info, c) < 0 ? -1 : (upper ? info.case_upper : info.case_lower);
+        int nu = 0;
+        if (to > 0 && to != c) {
+            KS_UCP_TO_UTF8(utf8, nu, to);
+        }
+        if (nu > 0) {
+            /* Add encoded value */
+            ksio_addbuf(sio, nu, utf8);
         } else {
-            /* Encode upper case */
-            int n;
-            KS_UCP_TO_UTF8(utf8, n, info.case_upper);
-            if (n <= 0) {
-                /* Error, just default back */
-                ksio_addbuf(sio, cit.cbyi - cit.lcbyi, self->data + cit.lcbyi);
-            } else {
-                /* Add encoded value */
-                ksio_addbuf(sio, n, utf8);
-            }
+            /* Assume same case */
+            ksio_addbuf(sio, sz, (const char*)data + p);
         }
+        p += sz;
     }
 
     return ksio_StringIO_getf(sio);
 }
 
+ks_str ks_str_upper(ks_str self) {
+    return s_case(self, true);
+}
+
 ks_str ks_str_lower(ks_str self) {
-    struct ks_str_citer cit = ks_str_citer_make(self);
-    ksio_StringIO sio = ksio_StringIO_new();
-    ks_ucp c;
-    char utf8[5];
-    struct ksucd_info info;
-    while (!cit.done) {
-        c = ks_str_citer_next(&cit);
-        if (c < 0) break;
+    return s_case(self, false);
+}
 
-        if (ksucd_get_info(&info, c) < 0 || info.case_lower == c || info.case_lower <= 0) {
-            /* Assume same case */
-            ksio_addbuf(sio, cit.cbyi - cit.lcbyi, self->data + cit.lcbyi);
-        } else {
-            /* Encode lower case */
-            int n;
-            KS_UCP_TO_UTF8(utf8, n, info.case_lower);
-            if (n <= 0) {
-                /* Error, just default back */
-                ksio_addbuf(sio, cit.cbyi - cit.lcbyi, self->data + cit.lcbyi);
-            } else {
-                /* Add encoded value */
-                ksio_addbuf(sio, n, utf8);
-            }
-        }
-    }
+/* Unicode general categories for the classification functions */
+#define S_IS_ALPHA(_cat) ((_cat) >= ksucd_cat_Lu && (_cat) <= ksucd_cat_L)
+#define S_IS_NUM(_cat) ((_cat) == ksucd_cat_No || (_cat) == ksucd_cat_Nd || (_cat) == ksucd_cat_Nl)
 
-    return ksio_StringIO_getf(sio);
+/* Return whether codepoint 'c' (which is non-ASCII) has a general category in 'cl' */
+static bool s_ucp_is(ks_ucp c, int cl) {
+    struct ksucd_info info;
+    if (ksucd_get_info(&info, c) < 0) return false;
+    return ((cl & S_CL_SPACE) && info.cat_gen == ksucd_cat_Zs)
+        || ((cl & S_CL_DIGIT) && S_IS_NUM(info.cat_gen))
+        || ((cl & S_CL_ALPHA) && S_IS_ALPHA(info.cat_gen));
 }
 
-bool ks_str_isspace(ks_str self) {
+/* Return whether all characters of 'self' have one of the classes in 'cl' */
+static bool s_all(ks_str self, int cl) {
+    if (KS_STR_IS_ASCII(self)) return s_ascii_all(self, cl);
+
     struct ks_str_citer cit = ks_str_citer_make(self);
     ks_ucp c;
-    struct ksucd_info info;
-
     while (!cit.done) {
         c = ks_str_citer_next(&cit);
         if (c < 0) break;
 
-        /* TODO: check bidirectional class of 'WS', 'B', or 'S' */
-        if (ksucd_get_info(&info, c) < 0 || (info.cat_gen != ksucd_cat_Zs)) {
-            return false;
-        }
+        if (c < 0x80 ? !(s_ascii_class[c] & cl) : !s_ucp_is(c, cl)) return false;
     }
     return true;
 }
 
+bool ks_str_isspace(ks_str self) {
+    /* TODO: check bidirectional class of 'WS', 'B', or 'S' */
+    return s_all(self, S_CL_SPACE);
+}
+
 bool ks_str_isprint(ks_str self) {
+    /* All ASCII characters are considered printable */
+    if (KS_STR_IS_ASCII(self)) return true;
+
     struct ks_str_citer cit = ks_str_citer_make(self);
     ks_ucp c;
     struct ksucd_info info;
@@ -166,7 +524,7 @@ bool ks_str_isprint(ks_str self) {
         c = ks_str_citer_next(&cit);
         if (c < 0) break;
 
-        if (c == ' ') {
+        if (c < 0x80) {
             continue;
         } else if (ksucd_get_info(&info, c) < 0 || (info.cat_gen == ksucd_cat_Z || info.cat_gen == ksucd_cat_Zs || info.cat_gen == ksucd_cat_Zl || info.cat_gen == ksucd_cat_Zp)) {
             return false;
@@ -176,175 +534,241 @@ bool ks_str_isprint(ks_str self) {
 }
 
 bool ks_str_isnum(ks_str self) {
-    struct ks_str_citer cit = ks_str_citer_make(self);
-    ks_ucp c;
-    struct ksucd_info info;
+    return s_all(self, S_CL_DIGIT);
+}
 
-    while (!cit.done) {
-        c = ks_str_citer_next(&cit);
-        if (c < 0) break;
+bool ks_str_isalpha(ks_str self) {
+    return s_all(self, S_CL_ALPHA);
+}
 
-        if (ksucd_get_info(&info, c) < 0 || !(info.cat_gen == ksucd_cat_No || info.cat_gen == ksucd_cat_Nd || info.cat_gen == ksucd_cat_Nl)) {
-            return false;
+bool ks_str_isalnum(ks_str self) {
+    return s_all(self, S_CL_ALPHA | S_CL_DIGIT);
+}
+
+bool ks_str_isident(ks_str self) {
+    if (self->len_b < 1) return false;
+
+    if (KS_STR_IS_ASCII(self)) {
+        if (!(s_ascii_class[(unsigned char)self->data[0]] & (S_CL_ALPHA | S_CL_UNDER))) return false;
+        ks_ssize_t i;
+        for (i = 1; i < self->len_b; ++i) {
+            if (!(s_ascii_class[(unsigned char)self->data[i]] & (S_CL_ALPHA | S_CL_DIGIT | S_CL_UNDER))) return false;
         }
+        return true;
     }
-    return true;
-}
 
-bool ks_str_isalpha(ks_str self) {
     struct ks_str_citer cit = ks_str_citer_make(self);
     ks_ucp c;
-    struct ksucd_info info;
+    bool first = true;
 
     while (!cit.done) {
         c = ks_str_citer_next(&cit);
         if (c < 0) break;
 
-        if (ksucd_get_info(&info, c) < 0 || (!(info.cat_gen >= ksucd_cat_Lu && info.cat_gen <= ksucd_cat_L))) {
-            return false;
-        }
+        int cl = first ? S_CL_ALPHA | S_CL_UNDER : S_CL_ALPHA | S_CL_DIGIT | S_CL_UNDER;
+        if (c < 0x80 ? !(s_ascii_class[c] & cl) : !s_ucp_is(c, cl)) return false;
+        first = false;
     }
+
     return true;
 }
 
-bool ks_str_isalnum(ks_str self) {
-    struct ks_str_citer cit = ks_str_citer_make(self);
-    ks_ucp c;
-    struct ksucd_info info;
+ks_ssize_t ks_str_lenc(ks_ssize_t len_b, const char* data) {
+    if (len_b < 0) len_b = strlen(data);
+    return s_lenc(len_b, (const unsigned char*)data);
+}
 
-    while (!cit.done) {
-        c = ks_str_citer_next(&cit);
-        if (c < 0) break;
+bool ks_str_isutf8(ks_ssize_t len_b, const char* data) {
+    if (len_b < 0) len_b = strlen(data);
+    const unsigned char* s = (const unsigned char*)data;
+    ks_ssize_t p = 0;
+    while (p < len_b) {
+        /* Skip over runs of ASCII, which are always valid */
+        p += s_ascii_prefix(len_b - p, s + p);
+        if (p >= len_b) break;
 
-        if (ksucd_get_info(&info, c) < 0 || (
-            !(info.cat_gen >= ksucd_cat_Lu && info.cat_gen <= ksucd_cat_L) 
-            && !(info.cat_gen == ksucd_cat_No || info.cat_gen == ksucd_cat_Nd || info.cat_gen == ksucd_cat_Nl))
-        ) {
-            return false;
-        }
+        int sz = s_utf8_seq(len_b - p, s + p);
+        if (sz < 0) return false;
+        p += sz;
     }
     return true;
 }
 
-bool ks_str_isident(ks_str self) {
-    if (self->len_b < 1) return false;
+/* Substring search
+ *
+ * Short needles (and short haystacks) are found by scanning for the first byte with 'memchr()', which is
+ *   vectorized by the C library, and then checking the rest. Longer needles use Boyer-Moore-Horspool, which
+ *   skips ahead by up to the length of the needle on each mismatch
+ */
 
-    struct ks_str_citer cit = ks_str_citer_make(self);
-    ks_ucp c;
-    struct ksucd_info info;
+/* Needle length (in bytes) at which the Horspool table is used */
+#define S_BMH_MIN 6
 
-    while (!cit.done) {
-        c = ks_str_citer_next(&cit);
-        if (c < 0) break;
+struct s_search {
+    const unsigned char* nd;
+    ks_ssize_t len_n;
 
-        if (c == '_') {
-            
-        } if (ksucd_get_info(&info, c) < 0 || !(info.cat_gen >= ksucd_cat_Lu && info.cat_gen <= ksucd_cat_L)) {
-            return false;
-        }
-        break;
-    }
+    /* Whether to use 'shift' */
+    bool use_bmh;
 
-    while (!cit.done) {
-        c = ks_str_citer_next(&cit);
-        if (c < 0) break;
+    /* How far to shift the window, indexed by the haystack byte aligned with the last byte of the needle */
+    ks_ssize_t shift[256];
+};
 
-        if (c == '_') {
-            
-        } else if (ksucd_get_info(&info, c) < 0 || (
-            !(info.cat_gen >= ksucd_cat_Lu && info.cat_gen <= ksucd_cat_L) 
-            && !(info.cat_gen == ksucd_cat_No || info.cat_gen == ksucd_cat_Nd || info.cat_gen == ksucd_cat_Nl))
-        ) {
-            return false;
-        }
+/* Prepare to search for 'nd' (which should be non-empty) in haystacks of roughly 'len_h' bytes */
+static void s_search_init(struct s_search* self, ks_ssize_t len_n, const char* nd, ks_ssize_t len_h) {
+    self->nd = (const unsigned char*)nd;
+    self->len_n = len_n;
+    self->use_bmh = len_n >= S_BMH_MIN && len_h >= 4 * 256;
+    if (self->use_bmh) {
+        ks_ssize_t i;
+        for (i = 0; i < 256; ++i) self->shift[i] = len_n;
+        for (i = 0; i < len_n - 1; ++i) self->shift[self->nd[i]] = len_n - 1 - i;
     }
+}
 
-    return true;
+/* Return the byte offset of the first occurrence of the needle in 'hay' at or after 'from', or -1 */
+static ks_ssize_t s_search_next(struct s_search* self, ks_ssize_t len_h, const char* hay, ks_ssize_t from) {
+    const unsigned char* h = (const unsigned char*)hay;
+    const unsigned char* nd = self->nd;
+    ks_ssize_t len_n = self->len_n;
+    if (from < 0 || len_h - from < len_n) return -1;
+
+    if (self->use_bmh) {
+        ks_ssize_t i = from, last = len_n - 1;
+        unsigned char cl = nd[last];
+        while (i <= len_h - len_n) {
+            unsigned char c = h[i + last];
+            if (c == cl && memcmp(h + i, nd, last) == 0) return i;
+            i += self->shift[c];
+        }
+        return -1;
+    } else {
+        const unsigned char* p = h + from, *end = h + len_h - len_n + 1;
+        while (p < end) {
+            p = memchr(p, nd[0], end - p);
+            if (!p) return -1;
+            if (memcmp(p + 1, nd + 1, len_n - 1) == 0) return p - h;
+            p++;
+        }
+        return -1;
+    }
 }
 
+/* Add 'self[i:j]' (in bytes) to 'res' */
+static bool s_push_part(ks_list res, ks_str self, ks_ssize_t i, ks_ssize_t j) {
+    return ks_list_pushu(res, (kso)ks_str_sub(self, i, j - i));
+}
 
+#if KS_STR_OFF_EVERY
 
+/* Return the offset index of a non-ASCII string, building it if it has not been yet */
+static ks_size_t* s_offs(ks_str self) {
+    if (self->_offs) return self->_offs;
 
-ks_ssize_t ks_str_lenc(ks_ssize_t len_b, const char* data) {
-    if (len_b < 0) len_b = strlen(data);
-    ks_ssize_t p = 0, r = 0;
-    while (p < len_b) {
-        /* Found another character */
-        r += (data[p++] & 0xC0) != 0x80;
+    const unsigned char* data = (const unsigned char*)self->data;
+    ks_size_t* offs = ks_zmalloc(sizeof(*offs), KS_STR_LENC(self) / KS_STR_OFF_EVERY + 1);
+    ks_size_t p, c = 0;
+    for (p = 0; p < self->len_b; ++p) {
+        if ((data[p] & 0xC0) != 0x80) {
+            if (c % KS_STR_OFF_EVERY == 0) offs[c / KS_STR_OFF_EVERY] = p;
+            c++;
+        }
     }
+    if (c % KS_STR_OFF_EVERY == 0) offs[c / KS_STR_OFF_EVERY] = p;
 
-    return r;
+    return self->_offs = offs;
 }
 
-ks_list ks_str_split(ks_str self, ks_str by) {
-    ks_list res = ks_list_new(0, NULL);
-    if (self->len_b == 0) {
-        ks_list_push(res, (kso)self);
-        return res;
+#endif /* KS_STR_OFF_EVERY */
+
+/* Return the byte offset 'n' characters after byte offset 'p' */
+static ks_ssize_t s_skip(ks_str self, ks_ssize_t p, ks_ssize_t n) {
+    const unsigned char* data = (const unsigned char*)self->data;
+    while (n > 0 && p < self->len_b) {
+        p++;
+        while (p < self->len_b && (data[p] & 0xC0) == 0x80) p++;
+        n--;
     }
+    return p;
+}
 
-    ks_size_t i, j = 0;
-    for (i = 0; i <= self->len_b - by->len_b; ++i) {
-        if (memcmp(self->data + i, by->data, by->len_b) == 0) {
-            /* Add characters pased until this */
-            ks_str ss = ks_str_new(i - j, self->data + j);
-            ks_list_push(res, (kso)ss);
-            KS_DECREF(ss);
+ks_ssize_t ks_str_off(ks_str self, ks_ssize_t idx_c) {
+    if (idx_c <= 0) return 0;
+    if (idx_c >= KS_STR_LENC(self)) return self->len_b;
+    if (KS_STR_IS_ASCII(self)) return idx_c;
 
-            i += by->len_b - 1;
-            j = i + 1;
-        } else {
-        }
+    #if KS_STR_OFF_EVERY
+    return s_skip(self, s_offs(self)[idx_c / KS_STR_OFF_EVERY], idx_c % KS_STR_OFF_EVERY);
+    #else
+    return s_skip(self, 0, idx_c);
+    #endif
+}
+
+ks_list ks_str_split(ks_str self, ks_str by) {
+    if (by->len_b == 0) {
+        KS_THROW(kst_ValError, "Empty separator");
+        return NULL;
     }
 
-    i = self->len_b;
+    ks_list res = ks_list_new(0, NULL);
+    struct s_search s;
+    s_search_init(&s, by->len_b, by->data, self->len_b);
 
-    if (i >= j) {
-        ks_str ss = ks_str_new(i - j, self->data + j);
-        ks_list_push(res, (kso)ss);
-        KS_DECREF(ss);
+    ks_ssize_t i, j = 0;
+    while ((i = s_search_next(&s, self->len_b, self->data, j)) >= 0) {
+        s_push_part(res, self, j, i);
+        j = i + by->len_b;
     }
+    s_push_part(res, self, j, self->len_b);
 
     return res;
 }
 
-
 ks_list ks_str_split_any(ks_str self, int nby, ks_str* by) {
-    ks_list res = ks_list_new(0, NULL);
-    if (self->len_b == 0 || nby == 0) {
-        ks_list_push(res, (kso)self);
-        return res;
+    if (nby == 0) {
+        return ks_list_new(1, (kso[]){ (kso)self });
     }
 
-    ks_size_t mlb = 0;
-    ks_size_t i, j = 0, k;
-    for (i = 0; i < nby; ++i) {
-        if (by[i]->len_b > mlb) mlb = by[i]->len_b;
+    /* Table of which bytes may start a separator, so most positions are rejected with a single lookup */
+    bool first[256] = {0};
+    bool all1 = true;
+    int k;
+    for (k = 0; k < nby; ++k) {
+        if (by[k]->len_b == 0) {
+            KS_THROW(kst_ValError, "Empty separator");
+            return NULL;
+        }
+        first[(unsigned char)by[k]->data[0]] = true;
+        if (by[k]->len_b != 1) all1 = false;
     }
 
-    for (i = 0; i <= self->len_b - mlb; ++i) {
-        for (k = 0; k < nby; ++k) {
-            if (i <= self->len_b - by[k]->len_b) {
-                if (memcmp(self->data + i, by[k]->data, by[k]->len_b) == 0) {
-                    /* Add characters pased until this */
-                    ks_str ss = ks_str_new(i - j, self->data + j);
-                    ks_list_push(res, (kso)ss);
-                    KS_DECREF(ss);
+    ks_list res = ks_list_new(0, NULL);
+    const unsigned char* data = (const unsigned char*)self->data;
+    ks_ssize_t i = 0, j = 0, n = self->len_b;
+    while (i < n) {
+        if (!first[data[i]]) {
+            i++;
+            continue;
+        }
 
-                    i += by[k]->len_b - 1;
-                    j = i + 1;
-                }
+        /* The earliest separator given takes priority */
+        ks_ssize_t len_m = all1 ? 1 : -1;
+        if (!all1) for (k = 0; k < nby; ++k) {
+            if (by[k]->len_b <= n - i && memcmp(data + i, by[k]->data, by[k]->len_b) == 0) {
+                len_m = by[k]->len_b;
+                break;
             }
         }
-    }
 
-    i = self->len_b;
-
-    if (i >= j) {
-        ks_str ss = ks_str_new(i - j, self->data + j);
-        ks_list_push(res, (kso)ss);
-        KS_DECREF(ss);
+        if (len_m < 0) {
+            i++;
+        } else {
+            s_push_part(res, self, j, i);
+            j = i += len_m;
+        }
     }
+    s_push_part(res, self, j, n);
 
     return res;
 }
@@ -360,43 +784,51 @@ ks_ssize_t ks_str_find(ks_str self, ks_str substr, ks_ssize_t min_c, ks_ssize_t
     if (substr->len_b == 0) return -1;
     else if (self->len_b < substr->len_b) return -1;
 
-    if (KS_STR_IS_ASCII(self)) {
-        // otherwise, search for it
-        /* ASCII search */
-        ks_ssize_t i;
-        for (i = min_c; i <= max_c - substr->len_b; ++i) {
-            if (self->data[i] == *substr->data) {
-                // possible match, now check full substring
-                if (memcmp(self->data + i, substr->data, substr->len_b) == 0) {
-                    if (idx_b != NULL) *idx_b = i;
-                    return i;
-                }
-            }
-        }
+    ks_ssize_t min_b = ks_str_off(self, min_c), max_b = ks_str_off(self, max_c);
+    if (max_b - min_b < substr->len_b) return -1;
 
-        // not found
-        return -1;
-    } else {
-        /* Generial unicode search */
-        struct ks_str_citer cit = ks_str_citer_make(self);
-
-        ks_size_t i = 0;
-        ks_str_citer_seek(&cit, min_c);
-
-        while (!cit.done && cit.cchi <= max_c) {
-            if (self->data[cit.cbyi] == *substr->data) {
-                // possible match, now check full substring
-                if (memcmp(self->data + cit.cbyi, substr->data, substr->len_b) == 0) {
-                    if (idx_b != NULL) *idx_b = cit.cbyi;
-                    return cit.cchi;
-                }
-            }
+    struct s_search s;
+    s_search_init(&s, substr->len_b, substr->data, max_b - min_b);
+    ks_ssize_t r = s_search_next(&s, max_b, self->data, min_b);
+    if (r < 0) return -1;
 
-            ks_str_citer_next(&cit);
-        }
+    if (idx_b != NULL) *idx_b = r;
+    return KS_STR_IS_ASCII(self) ? r : min_c + ks_str_lenc(r - min_b, self->data + min_b);
+}
 
-        return -1;
+ks_str ks_str_replace(ks_str self, ks_str sub, ks_str by) {
+    if (sub->len_b == 0) return (ks_str)KS_NEWREF(self);
+
+    /* Find all matches first, so the result can be allocated exactly */
+    ks_ssize_t n_m = 0, max_m = 0, * ms = NULL;
+    struct s_search s;
+    s_search_init(&s, sub->len_b, sub->data, self->len_b);
+
+    ks_ssize_t i, j = 0;
+    while ((i = s_search_next(&s, self->len_b, self->data, j)) >= 0) {
+        if (n_m >= max_m) {
+            max_m = max_m == 0 ? 16 : 2 * max_m;
+            ms = ks_zrealloc(ms, sizeof(*ms), max_m);
+        }
+        ms[n_m++] = i;
+        j = i + sub->len_b;
+    }
+    if (n_m == 0) return (ks_str)KS_NEWREF(self);
+
+    ks_ssize_t len_b = self->len_b + n_m * (by->len_b - sub->len_b);
+    char* data = ks_malloc(len_b + 1), * p = data;
+    j = 0;
+    for (i = 0; i < n_m; ++i) {
+        memcpy(p, self->data + j, ms[i] - j);
+        p += ms[i] - j;
+        memcpy(p, by->data, by->len_b);
+        p += by->len_b;
+        j = ms[i] + sub->len_b;
     }
+    memcpy(p, self->data + j, self->len_b - j);
+    ks_free(ms);
+
+    return ks_str_newn(len_b, data);
 }
 
 ks_str ks_str_join(ks_str sep, kso objs) {
@@ -434,7 +866,7 @@ struct ks_str_citer ks_str_citer_make(ks_str self) {
     struct ks_str_citer cit;
     cit.self = self;
     
-    cit.done = self->len_c == 0;
+    cit.done = KS_STR_LENC(self) == 0;
     cit.err = 0;
     cit.lcbyi = cit.cbyi = cit.cchi = 0;
 
@@ -444,7 +876,7 @@ struct ks_str_citer ks_str_citer_make(ks_str self) {
 ks_ucp ks_str_citer_next(struct ks_str_citer* cit) {
 
     // ensure we are still in range
-    if (cit->cchi >= cit->self->len_c) {
+    if (cit->cchi >= KS_STR_LENC(cit->self)) {
         cit->err = 1;
         return -1;
     }
@@ -452,6 +884,14 @@ ks_ucp ks_str_citer_next(struct ks_str_citer* cit) {
     cit->lcbyi = cit->cbyi;
     cit->cchi++;
     cit->done = cit->cchi >= cit->self->len_c;
+
+    /* ASCII fast path */
+    unsigned char c = cit->self->data[cit->cbyi];
+    if (c < 0x80) {
+        cit->cbyi++;
+        return c;
+    }
+
     ks_ucp r;
     int sz;
     KS_UCP_FROM_UTF8(r, cit->self->data + cit->cbyi, sz);
@@ -492,7 +932,7 @@ ks_ucp ks_str_citer_peek_n(struct ks_str_citer* cit, int n) {
 
 bool ks_str_citer_seek(struct ks_str_citer* cit, ks_ssize_t idx) {
     // check bounds
-    if (idx < 0 || idx >= cit->self->len_c) {
+    if (idx < 0 || idx >= KS_STR_LENC(cit->self)) {
         cit->err = 1;
         return false;
     }
@@ -503,7 +943,7 @@ bool ks_str_citer_seek(struct ks_str_citer* cit, ks_ssize_t idx) {
     // check for restarting the iterator
     if (idx == 0) {
         cit->lcbyi = cit->cbyi = cit->cchi = 0;
-        cit->done = cit->self->len_c == 0;
+        cit->done = KS_STR_LENC(cit->self) == 0;
         cit->err = 0;
         return true;
     }
@@ -513,28 +953,20 @@ bool ks_str_citer_seek(struct ks_str_citer* cit, ks_ssize_t idx) {
         cit->lcbyi = cit->cbyi = cit->cchi = idx;
 
         // calculate whether it was 'done'
-        cit->done = cit->cchi >= cit->self->len_c;
+        cit->done = cit->cchi >= KS_STR_LENC(cit->self);
 
         return true;
     } else {
 
         ks_ssize_t naive_dist = idx - cit->cchi;
 
-        #if KS_STR_OFF_EVERY
-
-        ks_ssize_t offi = idx / KS_STR_OFF_EVERY;
-        ks_ssize_t offe = idx % KS_STR_OFF_EVERY;
-
-        if (!cit->self->_offs || (naive_dist > 0 && naive_dist < offe)) {
-            // it's more efficient to just probe from the current position, so do nothing
-
-        } else {
-            // we should use offsets to do it, so fast forward the iterator to the given offset
-            cit->cchi = KS_STR_OFF_EVERY * offi;
-            cit->lcbyi = cit->cbyi = cit->self->_offs[offi];
-
+        if (naive_dist < 0 || (KS_STR_OFF_EVERY && naive_dist >= KS_STR_OFF_EVERY)) {
+            // jump straight to the character, rather than stepping through everything in between
+            cit->cchi = idx;
+            cit->lcbyi = cit->cbyi = ks_str_off(cit->self, idx);
+            cit->done = cit->cchi >= KS_STR_LENC(cit->self);
+            return true;
         }
-        #endif /* KS_STR_OFF_EVERY */
 
         // we need to seek forward
         while (cit->cchi < idx) {
@@ -554,7 +986,14 @@ static KS_TFUNC(T, free) {
     ks_str self;
     KS_ARGS("self:*", &self, kst_str);
 
-    ks_free(self->data);
+    if (self->_base) {
+        KS_DECREF(self->_base);
+    } else if (!(self->flags & KS_STR_F_INLINE)) {
+        ks_free(self->data);
+    }
+    #if KS_STR_OFF_EVERY
+    ks_free(self->_offs);
+    #endif
 
     KSO_DEL(self);
 
@@ -604,13 +1043,17 @@ static KS_TFUNC(T, len) {
     ks_str self;
     KS_ARGS("self:*", &self, kst_str);
 
-    return (kso)ks_int_newu(self->len_c);
+    return (kso)ks_int_newu(KS_STR_LENC(self));
 }
 
 static KS_TFUNC(T, add) {
     kso L, R;
     KS_ARGS("L R", &L, &R);
 
+    if (KS_TYPE_HAS(L->type, KS_TF_STR) && KS_TYPE_HAS(R->type, KS_TF_STR)) {
+        return (kso)ks_str_cat((ks_str)L, (ks_str)R);
+    }
+
     return (kso)ks_fmt("%S%S", L, R);
 }
 
@@ -678,7 +1121,7 @@ static KS_TFUNC(T, contains) {
     ks_str sub;
     KS_ARGS("self:* sub:*", &self, kst_str, &sub, kst_str);
 
-    ks_ssize_t idx = ks_str_find(self, sub, 0, self->len_c, NULL);
+    ks_ssize_t idx = ks_str_find(self, sub, 0, KS_STR_LENC(self), NULL);
     
     return KSO_BOOL(idx >= 0);
 }
@@ -811,9 +1254,9 @@ static KS_TFUNC(T, index) {
     KS_ARGS("self:* sub:* ?start:cint ?end:cint", &self, kst_str, &sub, kst_str, &start, &end);
 
     if (start < 0) start = 0;
-    if (start >= self->len_c) start = self->len_c;
+    if (start >= KS_STR_LENC(self)) start = KS_STR_LENC(self);
     if (end < 0) end = 0;
-    if (end >= self->len_c) end = self->len_c;
+    if (end >= KS_STR_LENC(self)) end = KS_STR_LENC(self);
 
     ks_ssize_t res = ks_str_find(self, sub, start, end, NULL);
     if (res < 0) {
@@ -831,9 +1274,9 @@ static KS_TFUNC(T, find) {
     KS_ARGS("self:* sub:* ?start:cint ?end:cint", &self, kst_str, &sub, kst_str, &start, &end);
 
     if (start < 0) start = 0;
-    if (start >= self->len_c) start = self->len_c;
+    if (start >= KS_STR_LENC(self)) start = KS_STR_LENC(self);
     if (end < 0) end = 0;
-    if (end >= self->len_c) end = self->len_c;
+    if (end >= KS_STR_LENC(self)) end = KS_STR_LENC(self);
 
     return (kso)ks_int_new(ks_str_find(self, sub, start, end, NULL));
 }
@@ -843,26 +1286,7 @@ static KS_TFUNC(T, replace) {
     ks_str sub, by;
     KS_ARGS("self:* sub:* by:*", &self, kst_str, &sub, kst_str, &by, kst_str);
 
-    /* General search/replace */
-    ksio_StringIO sio = ksio_StringIO_new();
-
-    ks_size_t i = 0, j = 0;
-    for (i = 0; i <= self->len_b - sub->len_b; ) {
-        if (memcmp(self->data + i, sub->data, sub->len_b) == 0) {
-            /* Add literal */
-            ksio_addbuf(sio, i - j, self->data + j);
-            /* Found substring, so emit the replaced by */
-            ksio_addbuf(sio, by->len_b, by->data);
-
-            /* Skip over it */
-            j = i += sub->len_b;
-        } else {
-            i++;
-        }
-    }
-    i = self->len_b;
-    ksio_addbuf(sio, i - j, self->data + j);
-    return (kso)ksio_StringIO_getf(sio);
+    return (kso)ks_str_replace(self, sub, by);
 }
 
 
@@ -957,6 +1381,11 @@ ks_type kst_str_iter = &tp_iter;
 
 
 void _ksi_str() {
+    s_init_ascii_class();
+#ifdef S_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) s_lenc = s_lenc_avx2;
+#endif
 
     _ksinit(kst_str_iter, kst_object, TI_NAME, sizeof(struct ks_str_iter_s), -1, "", KS_IKV(
         {"__free",               ksf_wrap(TI_free_, T_NAME ".__free(self)", "")},
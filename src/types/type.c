@@ -7,6 +7,66 @@
 #define T_NAME "type"
 
 
+/* Internals */
+
+/* Return the 'KS_TF_*' flag for a builtin type, or 0 if it is not one */
+static ks_uint s_builtin_flag(ks_type self) {
+    /****/ if (self == kst_number) return KS_TF_NUMBER;
+    else if (self == kst_int) return KS_TF_INT;
+    else if (self == kst_bool) return KS_TF_BOOL;
+    else if (self == kst_float) return KS_TF_FLOAT;
+    else if (self == kst_complex) return KS_TF_COMPLEX;
+    else if (self == kst_str) return KS_TF_STR;
+    else if (self == kst_bytes) return KS_TF_BYTES;
+    else if (self == kst_list) return KS_TF_LIST;
+    else if (self == kst_tuple) return KS_TF_TUPLE;
+    else if (self == kst_dict) return KS_TF_DICT;
+    else if (self == kst_set) return KS_TF_SET;
+    else if (self == kst_func) return KS_TF_FUNC;
+    else if (self == kst_partial) return KS_TF_PARTIAL;
+    else if (self == kst_type) return KS_TF_TYPE;
+    else if (self == kst_none) return KS_TF_NONE;
+    else if (self == kst_undefined) return KS_TF_UNDEFINED;
+    else if (self == kst_slice) return KS_TF_SLICE;
+    else if (self == kst_range) return KS_TF_RANGE;
+    else if (self == kst_Exception) return KS_TF_EXCEPTION;
+    return 0;
+}
+
+/* Calculate the flattened bases and the flags of a type, from its (already initialized) base */
+static void s_calc_bases(ks_type self, ks_type base) {
+    ks_cint i, n = self == base ? 1 : base->n_bases + 1;
+
+    self->bases = ks_zrealloc(self->bases, sizeof(*self->bases), n);
+    for (i = 0; i < n - 1; ++i) self->bases[i] = base->bases[i];
+    self->bases[n - 1] = self;
+    self->n_bases = n;
+
+    self->tflags = (self == base ? 0 : base->tflags) | s_builtin_flag(self);
+}
+
+/* Recalculate the flattened bases of every subtype of 'self', after its own have changed */
+static void s_calc_subs(ks_type self) {
+    ks_cint i;
+    for (i = 0; i < self->n_subs; ++i) {
+        s_calc_bases(self->subs[i], self);
+        s_calc_subs(self->subs[i]);
+    }
+}
+
+/* Remove 'sub' from the 'subs' of 'self', returning whether it was there */
+static bool s_del_sub(ks_type self, ks_type sub) {
+    ks_cint i;
+    for (i = 0; i < self->n_subs; ++i) {
+        if (self->subs[i] == sub) {
+            self->subs[i] = self->subs[--self->n_subs];
+            return true;
+        }
+    }
+    return false;
+}
+
+
 /* C-API */
 
 
@@ -31,9 +91,24 @@ void type_init(ks_type self, ks_type base, const char* name, int sz, int attr, c
 
     /* Now, actually set up type  */
 
+    /* Calculate these first, since they are needed to query the type (i.e. to hash strings) */
+    s_calc_bases(self, base);
+
     self->num_obs_del = self->num_obs_new = 0;
     self->ob_sz = sz == 0 ? base->ob_sz : sz;
     self->ob_attr = attr == 0 ? base->ob_attr : attr;
+
+    /* Inherit fixed attributes, which remain at the same offsets */
+    self->n_slots = self == base ? 0 : base->n_slots;
+    self->slots = NULL;
+    if (self->n_slots > 0) {
+        self->slots = ks_zmalloc(sizeof(*self->slots), self->n_slots);
+        ks_cint i;
+        for (i = 0; i < self->n_slots; ++i) {
+            KS_INCREF(base->slots[i].name);
+            self->slots[i] = base->slots[i];
+        }
+    }
     ks_type_set(self, _ksva__base, (kso)base);
 
     kso tmp = (kso)ks_str_new(-1, name);
@@ -56,7 +131,7 @@ void type_init(ks_type self, ks_type base, const char* name, int sz, int attr, c
     /* Add attributes */
     if (ikv) {
         while (ikv->key) {
-            ks_str k = ks_str_new(-1, ikv->key);
+            ks_str k = ks_str_intern_c(-1, ikv->key);
             ks_type_set(self, k, ikv->val);
             KS_DECREF(k);
             ikv++;
@@ -72,6 +147,7 @@ void _ksinit(ks_type self, ks_type base, const char* name, int sz, int attr, con
 
 ks_type ks_type_new(const char* name, ks_type base, int sz, int attr_pos, const char* doc, struct ks_ikv* ikv) {
     ks_type self = KSO_NEW(ks_type, kst_type);
+    self->attr = ks_dict_new(NULL);
 
     type_init(self, base, name, sz, attr_pos, doc, ikv, true);
 
@@ -154,7 +230,7 @@ ks_type ks_type_template(ks_type base, int nargs, kso* args) {
 
 
 kso ks_type_get(ks_type self, ks_str attr) {
-    kso res = ks_dict_get_ih(self->attr, (kso)attr, attr->v_hash);
+    kso res = ks_dict_get_ih(self->attr, (kso)attr, KS_STR_HASH(attr));
     if (res) return res;
 
     if (self->i__base != self) return ks_type_get(self->i__base, attr);
@@ -165,33 +241,119 @@ kso ks_type_get(ks_type self, ks_str attr) {
 }
 
 bool ks_type_set(ks_type self, ks_str attr, kso val) {
+    /* Intern the key, so lookups by identifiers match by identity (and special names can be compared directly) */
+    attr = ks_str_intern(attr);
+
     if (attr->len_b > 2 && attr->data[0] == '_' && attr->data[1] == '_') {
+        ks_type old_base = self->i__base;
+        if (attr == _ksva__base && kso_issub(val->type, kst_type) && (ks_type)val != self && kso_issub((ks_type)val, self)) {
+            KS_THROW(kst_TypeError, "Cannot set '__base' of %R to %R, which is a subtype of it", self, val);
+            KS_DECREF(attr);
+            return false;
+        }
+
         /* Handle special names */
-        #define ACT(_attr) else if (ks_str_eq_c(attr, #_attr, sizeof(#_attr) - 1)) { \
+        #define ACT(_attr) else if (attr == _ksva##_attr) { \
             *(kso*)&self->i##_attr = val; \
         }
         if (false) {}
         _KS_DO_SPEC(ACT)
-        #undef ACTss
+        #undef ACT
+
+        if (attr == _ksva__base && kso_issub(val->type, kst_type)) {
+            /* Changed base type, so move it in the graph (a type being initialized isn't in it yet), and
+             *   update everything below it
+             */
+            if (old_base && old_base != self && s_del_sub(old_base, self) && (ks_type)val != self) {
+                ks_type base = (ks_type)val;
+                int idx = base->n_subs++;
+                base->subs = ks_zrealloc(base->subs, sizeof(*base->subs), base->n_subs);
+                base->subs[idx] = self;
+            }
+            s_calc_bases(self, (ks_type)val);
+            s_calc_subs(self);
+        }
     }
 
-    ks_dict_set_h(self->attr, (kso)attr, attr->v_hash, val);
+    ks_dict_set_h(self->attr, (kso)attr, KS_STR_HASH(attr), val);
+    KS_DECREF(attr);
     return true;
 }
 
 bool ks_type_set_c(ks_type self, const char* attr, kso val) {
-    ks_str k = ks_str_new(-1, attr);
+    ks_str k = ks_str_intern_c(-1, attr);
     bool res = ks_type_set(self, k, val);
     KS_DECREF(k);
     return res;
 }
 
+bool ks_type_setslots(ks_type self, kso names) {
+    ks_list l = ks_list_newi(names);
+    if (!l) return false;
+
+    /* Plain objects don't need an attribute dictionary if all of their attributes are fixed */
+    if (self->i__base == kst_object && self->ob_attr == kst_object->ob_attr) {
+        self->ob_sz = sizeof(struct kso_s);
+        self->ob_attr = -1;
+    }
+
+    ks_cint i, j;
+    for (i = 0; i < l->len; ++i) {
+        ks_str name = (ks_str)l->elems[i];
+        if (!kso_issub(name->type, kst_str)) {
+            KS_THROW(kst_TypeError, "'__slots' should contain 'str' objects, but got '%T' object", name);
+            KS_DECREF(l);
+            return false;
+        }
+        for (j = 0; j < self->n_slots; ++j) {
+            if (ks_str_eq(self->slots[j].name, name)) {
+                KS_THROW(kst_ValError, "Duplicate slot %R", name);
+                KS_DECREF(l);
+                return false;
+            }
+        }
+
+        /* A class attribute of the same name would hide the slot */
+        bool exists;
+        if (!ks_dict_has_h(self->attr, (kso)name, KS_STR_HASH(name), &exists)) {
+            KS_DECREF(l);
+            return false;
+        }
+        if (exists) {
+            KS_THROW(kst_ValError, "Slot %R conflicts with class attribute", name);
+            KS_DECREF(l);
+            return false;
+        }
+
+        /* Add to the end of the instance layout */
+        j = self->n_slots++;
+        self->slots = ks_zrealloc(self->slots, sizeof(*self->slots), self->n_slots);
+
+        KS_INCREF(name);
+        self->slots[j].name = name;
+        self->slots[j].off = self->ob_sz;
+        self->ob_sz += sizeof(kso);
+    }
+
+    KS_DECREF(l);
+    return true;
+}
+
 /* Type Functions */
 
 static KS_TFUNC(T, free) {
     ks_type self;
     KS_ARGS("self:*", &self, kst_type);
 
+    ks_cint i;
+    for (i = 0; i < self->n_slots; ++i) {
+        KS_DECREF(self->slots[i].name);
+    }
+    ks_free(self->slots);
+    ks_free(self->bases);
+    ks_free(self->subs);
+    if (self->i__base && self->i__base != self) s_del_sub(self->i__base, self);
+
     KSO_DEL(self);
 
     return KSO_NONE;
@@ -5,6 +5,10 @@
  */
 #include <ks/impl.h>
 
+#ifdef KS_HAVE_TIME_H
+#include <time.h>
+#endif
+
 /* Calculate primality. TODO: Consider miller rabin? */
 static bool is_prime(ks_ssize_t x) {
     /**/ if (x < 2) return false;
@@ -20,6 +24,12 @@ static bool is_prime(ks_ssize_t x) {
     return true;
 }
 
+ks_size_t ks_nextpow2(ks_size_t x) {
+    ks_size_t r = 1;
+    while (r < x) r <<= 1;
+    return r;
+}
+
 ks_ssize_t ks_nextprime(ks_ssize_t x) {
     if (x < 2) return 2;
     ks_ssize_t i = x % 2 == 0 ? x + 1 : x + 2;
@@ -62,16 +72,120 @@ bool ks_printf(const char* fmt, ...) {
 }
 
 
-ks_hash_t ks_hash_bytes(ks_ssize_t len_b, const unsigned char* data) {
-    /* djb2-based algorithm */
-    ks_hash_t res = 5381;
+/* Per-process seed for 'ks_hash_bytes()', which is randomized so that hashes of attacker-controlled
+ *   strings (for example, HTTP header names) can't be precomputed to collide
+ */
+static ks_uint64_t hash_seed = 0;
+
+/* Constants for the hash function (from wyhash) */
+static const ks_uint64_t hash_secret[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+/* Compute the full 128 bit product of 'A * B', and store the low and high words back in them */
+static inline void hash_mum(ks_uint64_t* A, ks_uint64_t* B) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*A * *B;
+    *A = (ks_uint64_t)r;
+    *B = (ks_uint64_t)(r >> 64);
+#else
+    ks_uint64_t ha = *A >> 32, hb = *B >> 32, la = (ks_uint32_t)*A, lb = (ks_uint32_t)*B;
+    ks_uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32), c = t < rl;
+    ks_uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *A = lo;
+    *B = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+/* Multiply and fold */
+static inline ks_uint64_t hash_mix(ks_uint64_t A, ks_uint64_t B) {
+    hash_mum(&A, &B);
+    return A ^ B;
+}
 
-    ks_ssize_t i;
-    for (i = 0; i < len_b; ++i) {
-        res = (33 * res) + data[i];
+/* Unaligned reads (byte order only affects the hash values, which are never persisted) */
+static inline ks_uint64_t hash_r8(const unsigned char* p) {
+    ks_uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+static inline ks_uint64_t hash_r4(const unsigned char* p) {
+    ks_uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+static inline ks_uint64_t hash_r3(const unsigned char* p, ks_size_t k) {
+    return (((ks_uint64_t)p[0]) << 16) | (((ks_uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+void _ksi_hash() {
+    ks_uint64_t seed = 0;
+
+    /* Allow a fixed seed, for reproducible runs */
+    char* env = getenv("KS_HASHSEED");
+    if (env && *env) {
+        seed = strtoull(env, NULL, 0);
+    } else {
+        FILE* fp = fopen("/dev/urandom", "rb");
+        if (!fp || fread(&seed, sizeof(seed), 1, fp) != 1) {
+            /* Fallback to some entropy from the environment */
+            seed = (ks_uint64_t)time(NULL) ^ ((ks_uint64_t)clock() << 32) ^ (ks_uint64_t)(ks_uint)&seed;
+            #ifdef KS_HAVE_UNISTD_H
+            seed ^= (ks_uint64_t)getpid() << 16;
+            #endif
+        }
+        if (fp) fclose(fp);
     }
 
-    return res;
+    hash_seed = seed ^ hash_mix(seed ^ hash_secret[0], hash_secret[1]);
+}
+
+ks_hash_t ks_hash_bytes(ks_ssize_t len_b, const unsigned char* data) {
+    /* wyhash-based algorithm (SEE: https://github.com/wangyi-fudan/wyhash), which processes
+     *   8 bytes at a time, and mixes them with 64x64->128 bit multiplications
+     */
+    const unsigned char* p = data;
+    ks_size_t len = len_b;
+    ks_uint64_t seed = hash_seed, a, b;
+
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (hash_r4(p) << 32) | hash_r4(p + ((len >> 3) << 2));
+            b = (hash_r4(p + len - 4) << 32) | hash_r4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = hash_r3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        ks_size_t i = len;
+        if (i > 48) {
+            ks_uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = hash_mix(hash_r8(p) ^ hash_secret[1], hash_r8(p + 8) ^ seed);
+                see1 = hash_mix(hash_r8(p + 16) ^ hash_secret[2], hash_r8(p + 24) ^ see1);
+                see2 = hash_mix(hash_r8(p + 32) ^ hash_secret[3], hash_r8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = hash_mix(hash_r8(p) ^ hash_secret[1], hash_r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = hash_r8(p + i - 16);
+        b = hash_r8(p + i - 8);
+    }
+
+    a ^= hash_secret[1];
+    b ^= seed;
+    hash_mum(&a, &b);
+
+    return (ks_hash_t)hash_mix(a ^ hash_secret[0] ^ len, b ^ hash_secret[1]);
 }
 
 
@@ -86,10 +86,10 @@
 /* Check whether a type fits typeinfo */
 static bool is_typeinfo(ks_type tp, kso info, bool* out) {
 
-    if (kso_issub(info->type, kst_type)) {
+    if (KS_TYPE_HAS(info->type, KS_TF_TYPE)) {
         *out = kso_issub(tp, (ks_type)info);
         return true;
-    } else if (kso_issub(info->type, kst_tuple)) {
+    } else if (KS_TYPE_HAS(info->type, KS_TF_TUPLE)) {
         int i;
         ks_tuple tps = (ks_tuple)info;
         for (i = 0; i < tps->len; ++i) {
@@ -107,17 +107,31 @@ static bool is_typeinfo(ks_type tp, kso info, bool* out) {
 }
 
 
+/* Check whether 'L' (which the caller holds a reference to, having popped it off of the stack) is only
+ *   otherwise referenced by the local variable that the instruction at 'pc' is about to overwrite (i.e.
+ *   'x = x + ...'), in which case it cannot be observed and may be modified in place
+ */
+static bool s_is_dead(ksos_frame frame, ks_code bc, ks_type _in, kso L, const ksb* pc) {
+    if (L->refs != 2 || _in != NULL || !frame->locals || *pc != KSB_STORE) return false;
+
+    ks_str name = (ks_str)bc->vc->elems[((ksba*)pc)->arg];
+    kso V = ks_dict_get_ih(frame->locals, (kso)name, KS_STR_HASH(name));
+    if (!V) return false;
+    KS_DECREF(V);
+    return V == L;
+}
+
+
 /* Execute on the current thread and return the result returned, or NULL if
  *   an exception was thrown.
  * 
  * This method does not add anything to the thread's stack frames (that should be
  *   done in the caller, for example in 'kso_call_ext()')
  */
-kso _ks_exec(ks_code bc, ks_type _in) {
-    /* Thread we are executing on */
-    ksos_thread th = ksos_thread_get();
+kso _ks_exec(ksos_thread th, ks_code bc, ks_type _in) {
+    /* Thread we are executing on (passed explicitly, to avoid a thread-local lookup per call) */
     assert(th && th->frames->len > 0);
-    //assert(ksos_thread_get() == ksg_main_thread);
+    assert(th == ksos_thread_get());
 
     /* Frame being executed on */
     ksos_frame frame = (ksos_frame)th->frames->elems[th->frames->len - 1];
@@ -192,7 +206,7 @@ kso _ks_exec(ks_code bc, ks_type _in) {
                 goto thrown; \
             } \
         } else { \
-            if (!ks_dict_set_h(frame->locals, (kso)_name, _name->v_hash, (kso)_obj)) { \
+            if (!ks_dict_set_h(frame->locals, (kso)_name, KS_STR_HASH(_name), (kso)_obj)) { \
                 goto thrown; \
             } \
         } \
@@ -242,7 +256,7 @@ kso _ks_exec(ks_code bc, ks_type _in) {
             fit = frame;
             do {
                 if (fit->locals) {
-                    V = ks_dict_get_ih(fit->locals, (kso)name, name->v_hash);
+                    V = ks_dict_get_ih(fit->locals, (kso)name, KS_STR_HASH(name));
                     if (V) {
                         /* Found in this scope, so push it and execute the next */
                         ks_list_pushu(stk, V);
@@ -254,7 +268,7 @@ kso _ks_exec(ks_code bc, ks_type _in) {
             } while (fit != NULL);
 
             /* Now, check globals */
-            V = ks_dict_get_ih(ksg_globals, (kso)name, name->v_hash);
+            V = ks_dict_get_ih(ksg_globals, (kso)name, KS_STR_HASH(name));
 
             if (!V) {
                 KS_THROW(kst_NameError, "Unknown name: %R", name);
@@ -369,7 +383,7 @@ kso _ks_exec(ks_code bc, ks_type _in) {
         VMD_OPA(KSB_CALL)
             assert(arg >= 1);
             ARGS_FROM_STK(arg);
-            V = kso_call(args[0], n_args - 1, args + 1);
+            V = _kso_call_ext(th, args[0], n_args - 1, args + 1, NULL, NULL);
             DECREF_ARGS(arg);
             if (!V) goto thrown;
             ks_list_pushu(stk, V);
@@ -378,7 +392,8 @@ kso _ks_exec(ks_code bc, ks_type _in) {
         VMD_OP(KSB_CALLV)
             lis = (ks_list)ks_list_pop(stk);
             assert(lis->type == kst_list);
-            V = kso_call(lis->elems[0], lis->len-1, lis->elems+1);
+            ks_list_box(lis);
+            V = _kso_call_ext(th, lis->elems[0], lis->len-1, lis->elems+1, NULL, NULL);
             KS_DECREF(lis);
             if (!V) goto thrown;
 
@@ -399,7 +414,9 @@ kso _ks_exec(ks_code bc, ks_type _in) {
 
         VMD_OPA(KSB_LIST)
             stk->len -= arg;
-            ks_list_pushu(stk, (kso)ks_list_newn(arg, stk->elems + stk->len));
+            L = (kso)ks_list_newn(arg, stk->elems + stk->len);
+            ks_list_unbox((ks_list)L);
+            ks_list_pushu(stk, L);
         VMD_OP_END
 
         VMD_OPA(KSB_LIST_PUSHN)
@@ -422,10 +439,13 @@ kso _ks_exec(ks_code bc, ks_type _in) {
             ks_list_pushu(stk, (kso)ks_tuple_newn(arg, stk->elems + stk->len));
         VMD_OP_END
 
+        /* The tuple being built is uniquely referenced (it was just created by 'KSB_TUPLE'), so it can be grown
+         *   in place. Its size is rounded up to a power of two, so this is amortized linear
+         */
         VMD_OPA(KSB_TUPLE_PUSHN)
             stk->len -= arg;
             tup = (ks_tuple)stk->elems[stk->len - 1];
-            tup->elems = ks_zrealloc(tup->elems, sizeof(*tup->elems), tup->len + arg);
+            tup->elems = ks_zrealloc(tup->elems, sizeof(*tup->elems), ks_nextpow2(tup->len + arg));
             memcpy(tup->elems + tup->len, stk->elems + stk->len, arg * sizeof(*tup->elems));
             tup->len += arg;
         VMD_OP_END
@@ -438,9 +458,11 @@ kso _ks_exec(ks_code bc, ks_type _in) {
             if (!ttt) {
                 goto thrown;
             }
-            tup->elems = ks_zrealloc(tup->elems, sizeof(*tup->elems), tup->len + ttt->len);
-            memcpy(tup->elems + tup->len, ttt->elems, ttt->len * sizeof(*tup->elems));
-            tup->len += ttt->len;
+            tup->elems = ks_zrealloc(tup->elems, sizeof(*tup->elems), ks_nextpow2(tup->len + ttt->len));
+            for (i = 0; i < ttt->len; ++i) {
+                tup->elems[tup->len++] = KS_NEWREF(ttt->elems[i]);
+            }
+            KS_DECREF(ttt);
         VMD_OP_END
 
 
@@ -515,7 +537,7 @@ kso _ks_exec(ks_code bc, ks_type _in) {
             assert(tinfo->type == kst_tuple && tinfo->len == 2);
 
             ks_type tbase = (ks_type)ks_list_pop(stk);
-            assert(tbase && kso_issub(tbase->type, kst_type));
+            assert(tbase && KS_TYPE_HAS(tbase->type, KS_TF_TYPE));
             kso tbc = ks_list_pop(stk);
             assert(tbc && tbc->type == kst_code);
 
@@ -529,13 +551,24 @@ kso _ks_exec(ks_code bc, ks_type _in) {
             KS_DECREF(tbase);
 
             /* Execute the body */
-            V = kso_call_ext(tbc, 1, (kso[]){ (kso)tnew }, tnew->attr, frame);
+            V = _kso_call_ext(th, tbc, 1, (kso[]){ (kso)tnew }, tnew->attr, frame);
             KS_DECREF(tbc);
             if (!V) {
                 KS_DECREF(tnew);
-                KS_DECREF(tbc);
                 goto thrown;
             }
+            KS_DECREF(V);
+
+            /* Lay out fixed attributes, if the body declared them */
+            V = ks_dict_get_ih(tnew->attr, (kso)_ksva__slots, KS_STR_HASH(_ksva__slots));
+            if (V) {
+                bool ok = ks_type_setslots(tnew, V);
+                KS_DECREF(V);
+                if (!ok) {
+                    KS_DECREF(tnew);
+                    goto thrown;
+                }
+            }
 
             ks_list_pushu(stk, (kso)tnew);
 
@@ -755,7 +788,30 @@ kso _ks_exec(ks_code bc, ks_type _in) {
         VMD_OP_END
         
         /* Binary operators */
-        T_BOP(KSB_BOP_ADD, add)
+        VMD_OP(KSB_BOP_ADD)
+            R = ks_list_pop(stk);
+            L = ks_list_pop(stk);
+
+            /* Append in place to a string (or bytes) which is about to be overwritten, so that building one
+             *   up in a loop is amortized linear rather than quadratic
+             */
+            if (L->type == kst_str && R->type == kst_str && L != R && s_is_dead(frame, bc, _in, L, pc)) {
+                _ks_str_append((ks_str)L, (ks_str)R);
+                KS_DECREF(R);
+                ks_list_pushu(stk, L);
+                VMD_NEXT();
+            } else if (L->type == kst_bytes && R->type == kst_bytes && L != R && s_is_dead(frame, bc, _in, L, pc)) {
+                _ks_bytes_append((ks_bytes)L, (ks_bytes)R);
+                KS_DECREF(R);
+                ks_list_pushu(stk, L);
+                VMD_NEXT();
+            }
+
+            V = ks_bop_add(L, R);
+            KS_DECREF(L); KS_DECREF(R);
+            if (!V) goto thrown;
+            ks_list_pushu(stk, V);
+        VMD_OP_END
         T_BOP(KSB_BOP_SUB, sub)
         T_BOP(KSB_BOP_MUL, mul)
         T_BOP(KSB_BOP_MATMUL, matmul)
@@ -821,6 +877,9 @@ kso _ks_exec(ks_code bc, ks_type _in) {
     thrown:;
     /* Exception was thrown */
     if (th->n_handlers > snh) {
+        /* Record where it was thrown from before 'pc' moves */
+        _ks_unwind(th);
+
         /* Execute handler */
         while (stk->len > th->handlers[th->n_handlers - 1].stklen) {
             ks_list_popu(stk);